@@ -0,0 +1,587 @@
+#include <functional>
+#include <string>
+#include <vector>
+#include <benchmark/benchmark.h>
+#include "Models/localcapso.h"
+#include "Models/globalcapso.h"
+#include "Models/neighborhood.h"
+#include "Models/perfcounters.h"
+
+namespace
+{
+    // Arguments of the model benchmarks: the side of the lattice, the fitness
+    // (competition) radius, the reproduction radius of preys and predators,
+    // the initial density of preys in percent and the initial swarm size,
+    // then for some benchmarks a variant: the interval in seasons between
+    // sorts of the swarm, the size of the tiles of the lattice, whether it
+    // wraps with bit masks, the set of kernels or the threads searching the
+    // global best
+    enum Argument { SIZE, FITNESS, REPRODUCTION, DENSITY, SWARM, VARIANT };
+
+    void modelArguments(benchmark::internal::Benchmark* b)
+    {
+        b->ArgNames({ "size", "fitness", "reproduction", "density", "swarm" });
+
+        // Vary one parameter at a time around the defaults of CaPsoSettings
+        for(int size = 128; size <= 4096; size *= 2)
+        {
+            b->Args({ size, 3, 2, 30, 3 });
+        }
+
+        for(int fitness : { 1, 5, 8 })
+        {
+            b->Args({ 512, fitness, 2, 30, 3 });
+        }
+
+        for(int reproduction : { 1, 4, 8 })
+        {
+            b->Args({ 512, 3, reproduction, 30, 3 });
+        }
+
+        for(int density : { 10, 60, 90 })
+        {
+            b->Args({ 512, 3, 2, density, 3 });
+        }
+
+        for(int swarm : { 30, 300, 3000 })
+        {
+            b->Args({ 512, 3, 2, 30, swarm });
+        }
+
+        b->Unit(benchmark::kMillisecond);
+    }
+
+    // Large swarms kept in order of birth or sorted by position every season
+    void sortArguments(benchmark::internal::Benchmark* b)
+    {
+        b->ArgNames({ "size", "fitness", "reproduction", "density", "swarm", "sort" });
+
+        for(int swarm : { 3000, 30000 })
+        {
+            for(int sort : { 0, 1 })
+            {
+                b->Args({ 1024, 3, 2, 30, swarm, sort });
+            }
+        }
+
+        b->Unit(benchmark::kMillisecond);
+    }
+
+    // Swarms from small to far larger than the defaults, which is where the
+    // search for the global best of GlobalCaPso costs the most, searched by
+    // one or several threads
+    void swarmArguments(benchmark::internal::Benchmark* b)
+    {
+        b->ArgNames({ "size", "fitness", "reproduction", "density", "swarm", "threads" });
+
+        for(int swarm : { 300, 3000, 30000 })
+        {
+            for(int threads : { 1, 4 })
+            {
+                b->Args({ 1024, 3, 2, 30, swarm, threads });
+            }
+        }
+
+        b->Unit(benchmark::kMillisecond);
+    }
+
+    // Large lattices and neighborhoods stored row major or in tiles
+    void tileArguments(benchmark::internal::Benchmark* b)
+    {
+        b->ArgNames({ "size", "fitness", "reproduction", "density", "swarm", "tile" });
+
+        for(int size : { 1024, 4096 })
+        {
+            for(int fitness : { 3, 8 })
+            {
+                for(int tile : { 0, 8 })
+                {
+                    b->Args({ size, fitness, 2, 30, 3, tile });
+                }
+            }
+        }
+
+        b->Unit(benchmark::kMillisecond);
+    }
+
+    // Lattices whose sides are powers of two wrapping with bit masks or with
+    // the generic modulo
+    void wrapArguments(benchmark::internal::Benchmark* b)
+    {
+        b->ArgNames({ "size", "fitness", "reproduction", "density", "swarm", "mask" });
+
+        for(int size : { 512, 2048 })
+        {
+            for(int fitness : { 3, 8 })
+            {
+                for(int mask : { 0, 1 })
+                {
+                    b->Args({ size, fitness, 2, 30, 3, mask });
+                }
+            }
+        }
+
+        b->Unit(benchmark::kMillisecond);
+    }
+
+    // Every set of kernels the CPU supports, from the scalar one to the
+    // fastest
+    void kernelArguments(benchmark::internal::Benchmark* b)
+    {
+        b->ArgNames({ "size", "fitness", "reproduction", "density", "swarm", "kernels" });
+
+        int sets = static_cast<int>(supportedKernels().size());
+
+        for(int size : { 512, 2048 })
+        {
+            for(int kernels = 0; kernels < sets; kernels++)
+            {
+                b->Args({ size, 3, 2, 30, 3, kernels });
+            }
+        }
+
+        b->Unit(benchmark::kMillisecond);
+    }
+
+    // Report the throughput both as lattice cells and as generations (or
+    // stages) per second of measured time
+    void setRates(benchmark::State& state, int cellsPerGeneration, int generationsPerIteration)
+    {
+        double generations = static_cast<double>(state.iterations()) * generationsPerIteration;
+
+        state.counters["cells/s"] = benchmark::Counter(generations * cellsPerGeneration,
+                                                       benchmark::Counter::kIsRate);
+        state.counters["gens/s"] = benchmark::Counter(generations,
+                                                      benchmark::Counter::kIsRate);
+    }
+
+    // Hardware events per generation, reported only for the events that
+    // perf_event_open is able to count on this machine
+    void setEvents(benchmark::State& state, const PerfCounters& counters,
+                   const PerfCounters::Values& events, int generationsPerIteration)
+    {
+        double generations = static_cast<double>(state.iterations()) * generationsPerIteration;
+
+        for(int event = 0; event < PerfCounters::NUMBER_OF_EVENTS; event++)
+        {
+            if(counters.available(static_cast<PerfCounters::Event>(event)))
+            {
+                std::string name = PerfCounters::eventName(static_cast<PerfCounters::Event>(event));
+
+                state.counters[name + "/gen"] = events[event] / generations;
+            }
+        }
+
+        if(counters.available(PerfCounters::CYCLES) &&
+           counters.available(PerfCounters::INSTRUCTIONS) && events[PerfCounters::CYCLES] > 0)
+        {
+            state.counters["IPC"] = static_cast<double>(events[PerfCounters::INSTRUCTIONS]) /
+                                    events[PerfCounters::CYCLES];
+        }
+    }
+
+    void accumulate(PerfCounters::Values& total, const PerfCounters::Values& values)
+    {
+        for(int event = 0; event < PerfCounters::NUMBER_OF_EVENTS; event++)
+        {
+            total[event] += values[event];
+        }
+    }
+
+    CaPsoSettings settingsFromState(const benchmark::State& state)
+    {
+        CaPsoSettings settings;
+        settings.fitnessRadius              = state.range(FITNESS);
+        settings.preyReproductionRadius     = state.range(REPRODUCTION);
+        settings.predatorReproductionRadius = state.range(REPRODUCTION);
+        settings.initialPreyDensity         = state.range(DENSITY) / 100.0F;
+        settings.predatorInitialSwarmSize   = state.range(SWARM);
+
+        return settings;
+    }
+
+    void setUp(LocalCaPso& ca, const benchmark::State& state)
+    {
+        ca.setSettings(settingsFromState(state));
+        ca.initialize();
+    }
+
+    void setUp(GlobalCaPso& ca, const benchmark::State& state)
+    {
+        ca.setCompetitionRadius(state.range(FITNESS));
+        ca.setPreyReproductionRadius(state.range(REPRODUCTION));
+        ca.setPredatorReproductionRadius(state.range(REPRODUCTION));
+        ca.setInitialPreyPercentage(state.range(DENSITY) / 100.0F);
+        ca.setInitialSwarmSize(state.range(SWARM));
+        ca.initialize();
+    }
+
+    // Run the model until the given stage is next, restarting it when one of
+    // the species dies out so that every stage has some work to do
+    template<class Model>
+    void advanceTo(Model& ca, int stage)
+    {
+        while(ca.currentStage() != stage)
+        {
+            ca.nextGen();
+        }
+
+        if(ca.numberOfPreys() == 0 || ca.numberOfPredators() == 0)
+        {
+            ca.initialize();
+
+            while(ca.currentStage() != stage)
+            {
+                ca.nextGen();
+            }
+        }
+    }
+}
+
+// A single stage of the model, the remaining stages are run untimed
+template<class Model>
+static void stageBenchmark(benchmark::State& state, int stage,
+                           std::function<void(Model&)> configure = nullptr)
+{
+    int size = state.range(SIZE);
+
+    Model ca(size, size);
+
+    if(configure)
+    {
+        configure(ca);
+    }
+
+    setUp(ca, state);
+
+    // Reading the counters costs a few system calls, so they are only read
+    // when at least one event is available
+    PerfCounters counters;
+    PerfCounters::Values events = {};
+    bool countEvents = counters.available();
+
+    for(auto _ : state)
+    {
+        state.PauseTiming();
+        advanceTo(ca, stage);
+        state.ResumeTiming();
+
+        if(countEvents)
+        {
+            counters.start();
+        }
+
+        ca.nextGen();
+
+        if(countEvents)
+        {
+            accumulate(events, counters.stop());
+        }
+
+        benchmark::ClobberMemory();
+    }
+
+    setRates(state, size * size, 1);
+    setEvents(state, counters, events, 1);
+}
+
+// A whole season, i.e., ten generations, through the fused kernel
+template<class Model>
+static void seasonBenchmark(benchmark::State& state, int sortInterval = 0, int tileSize = 0,
+                            bool genericWrap = false,
+                            const Kernels& kernels = fastestKernels(),
+                            std::function<void(Model&)> configure = nullptr)
+{
+    int size = state.range(SIZE);
+
+    Model ca(size, size);
+    ca.setLayout(tileSize);
+    ca.setGenericWrap(genericWrap);
+    ca.setKernels(kernels);
+    state.SetLabel(kernels.name);
+
+    if(configure)
+    {
+        configure(ca);
+    }
+
+    setUp(ca, state);
+    ca.setParticleSortInterval(sortInterval);
+
+    PerfCounters counters;
+    PerfCounters::Values events = {};
+    bool countEvents = counters.available();
+
+    for(auto _ : state)
+    {
+        if(countEvents)
+        {
+            counters.start();
+        }
+
+        ca.advanceSeasons(1);
+
+        if(countEvents)
+        {
+            accumulate(events, counters.stop());
+        }
+
+        if(ca.numberOfPreys() == 0 || ca.numberOfPredators() == 0)
+        {
+            state.PauseTiming();
+            ca.initialize();
+            state.ResumeTiming();
+        }
+
+        benchmark::ClobberMemory();
+    }
+
+    setRates(state, size * size, 10);
+    setEvents(state, counters, events, 10);
+}
+
+static void BM_LocalCaPso(benchmark::State& state, int stage)
+{
+    stageBenchmark<LocalCaPso>(state, stage);
+}
+
+static void BM_GlobalCaPso(benchmark::State& state, int stage)
+{
+    stageBenchmark<GlobalCaPso>(state, stage);
+}
+
+static void BM_LocalCaPsoSeason(benchmark::State& state)
+{
+    seasonBenchmark<LocalCaPso>(state);
+}
+BENCHMARK(BM_LocalCaPsoSeason)->Apply(modelArguments);
+
+static void BM_GlobalCaPsoSeason(benchmark::State& state)
+{
+    seasonBenchmark<GlobalCaPso>(state);
+}
+BENCHMARK(BM_GlobalCaPsoSeason)->Apply(modelArguments);
+
+static void BM_GlobalCaPsoSwarmSeason(benchmark::State& state)
+{
+    int threads = state.range(VARIANT);
+
+    seasonBenchmark<GlobalCaPso>(state, 0, 0, false, fastestKernels(), [threads](GlobalCaPso& ca)
+    {
+        ca.setSearchThreads(threads);
+    });
+}
+BENCHMARK(BM_GlobalCaPsoSwarmSeason)->Apply(swarmArguments);
+
+// Feeding and the search for the global best that follows it
+static void BM_GlobalCaPsoSwarmPredation(benchmark::State& state)
+{
+    int threads = state.range(VARIANT);
+
+    stageBenchmark<GlobalCaPso>(state, GlobalCaPso::DEATH_OF_PREYS, [threads](GlobalCaPso& ca)
+    {
+        ca.setSearchThreads(threads);
+    });
+}
+BENCHMARK(BM_GlobalCaPsoSwarmPredation)->Apply(swarmArguments);
+
+static void BM_LocalCaPsoSortedSeason(benchmark::State& state)
+{
+    seasonBenchmark<LocalCaPso>(state, state.range(VARIANT));
+}
+BENCHMARK(BM_LocalCaPsoSortedSeason)->Apply(sortArguments);
+
+static void BM_LocalCaPsoTiledSeason(benchmark::State& state)
+{
+    seasonBenchmark<LocalCaPso>(state, 0, state.range(VARIANT));
+}
+BENCHMARK(BM_LocalCaPsoTiledSeason)->Apply(tileArguments);
+
+static void BM_LocalCaPsoWrapSeason(benchmark::State& state)
+{
+    seasonBenchmark<LocalCaPso>(state, 0, 0, !state.range(VARIANT));
+}
+BENCHMARK(BM_LocalCaPsoWrapSeason)->Apply(wrapArguments);
+
+static void BM_LocalCaPsoKernelSeason(benchmark::State& state)
+{
+    seasonBenchmark<LocalCaPso>(state, 0, 0, false, *supportedKernels()[state.range(VARIANT)]);
+}
+BENCHMARK(BM_LocalCaPsoKernelSeason)->Apply(kernelArguments);
+
+#define STAGE_BENCHMARKS(function, Model)                                                       \
+    BENCHMARK_CAPTURE(function, competition, Model::COMPETITION)                                \
+        ->Apply(modelArguments);                                                                \
+    BENCHMARK_CAPTURE(function, migration, Model::MIGRATION)                                    \
+        ->Apply(modelArguments);                                                                \
+    BENCHMARK_CAPTURE(function, reproductionOfPredators, Model::REPRODUCTION_OF_PREDATORS)      \
+        ->Apply(modelArguments);                                                                \
+    BENCHMARK_CAPTURE(function, deathOfPredators, Model::DEATH_OF_PREDATORS)                    \
+        ->Apply(modelArguments);                                                                \
+    BENCHMARK_CAPTURE(function, deathOfPreys, Model::DEATH_OF_PREYS)                            \
+        ->Apply(modelArguments);                                                                \
+    BENCHMARK_CAPTURE(function, reproductionOfPreys, Model::REPRODUCTION_OF_PREYS)              \
+        ->Apply(modelArguments)
+
+STAGE_BENCHMARKS(BM_LocalCaPso, LocalCaPso);
+STAGE_BENCHMARKS(BM_GlobalCaPso, GlobalCaPso);
+
+// The migration of a swarm over a lattice of randomly placed preys
+static void swarmBenchmark(benchmark::State& state, int size, int radius, int density,
+                           int swarmSize, int socialRadius, Swarm::NeighborSearch search)
+{
+    LatticeLayout layout(size, size);
+    RandomNumber random;
+    std::vector<unsigned char> lattice(size * size);
+    std::vector<unsigned char> densities(size * size);
+    std::vector<unsigned char> temp(size * size);
+
+    for(int row = 0; row < size; row++)
+    {
+        for(int col = 0; col < size; col++)
+        {
+            if(random.GetRandomFloat() < density / 100.0F)
+            {
+                lattice[size * row + col] = LocalCaPso::PREY;
+
+                notifyNeighborhood(densities, layout, ModuloWrap(size, size),
+                                   row, col, radius, false);
+            }
+        }
+    }
+
+    Swarm swarm(1.0F, 2.0F, 0.9F, 10, socialRadius, lattice, densities, temp,
+                layout, LocalCaPso::PREDATOR, random);
+    swarm.setNeighborSearch(search);
+    swarm.initialize(swarmSize);
+
+    for(auto p : swarm)
+    {
+        lattice[size * p->position.row + p->position.col] |= LocalCaPso::PREDATOR;
+    }
+
+    PerfCounters counters;
+    PerfCounters::Values events = {};
+    bool countEvents = counters.available();
+
+    for(auto _ : state)
+    {
+        if(countEvents)
+        {
+            counters.start();
+        }
+
+        swarm.nextGen();
+
+        if(countEvents)
+        {
+            accumulate(events, counters.stop());
+        }
+
+        benchmark::ClobberMemory();
+    }
+
+    setRates(state, size * size, 1);
+    setEvents(state, counters, events, 1);
+}
+
+static void BM_SwarmNextGen(benchmark::State& state)
+{
+    swarmBenchmark(state, state.range(SIZE), state.range(FITNESS), state.range(DENSITY),
+                   state.range(SWARM), 3, Swarm::GRID);
+}
+BENCHMARK(BM_SwarmNextGen)->Apply(modelArguments);
+
+// Social neighborhoods of growing radius searched by scanning them or
+// through the neighbor grid
+static void BM_SwarmNeighborSearch(benchmark::State& state)
+{
+    swarmBenchmark(state, 512, 3, 30, state.range(1), state.range(2),
+                   static_cast<Swarm::NeighborSearch>(state.range(0)));
+}
+BENCHMARK(BM_SwarmNeighborSearch)
+    ->ArgNames({ "grid", "swarm", "social" })
+    ->ArgsProduct({ { Swarm::SCAN, Swarm::GRID }, { 300, 3000 }, { 3, 10, 25 } });
+
+// Births and deaths of preys at random cells, the kernel behind the update of
+// the prey densities of both models
+static void BM_NotifyNeighbors(benchmark::State& state)
+{
+    int size = state.range(0);
+    int radius = state.range(1);
+
+    LatticeLayout layout(size, size, state.range(2));
+    bool mask = state.range(3);
+    RandomNumber random;
+    std::vector<unsigned char> densities(layout.size());
+    std::vector<int> cells(1024);
+
+    for(auto& cell : cells)
+    {
+        cell = random.GetRandomInt(0, size * size - 1);
+    }
+
+    auto notifyAll = [&](const auto& wrap)
+    {
+        // Every cell is born and then dies so the densities never overflow
+        for(bool death : { false, true })
+        {
+            for(int cell : cells)
+            {
+                notifyNeighborhood(densities, layout, wrap, cell / size, cell % size, radius, death);
+            }
+        }
+    };
+
+    for(auto _ : state)
+    {
+        if(mask)
+        {
+            notifyAll(MaskWrap(size, size));
+        }
+        else
+        {
+            notifyAll(ModuloWrap(size, size));
+        }
+
+        benchmark::DoNotOptimize(densities.data());
+        benchmark::ClobberMemory();
+    }
+
+    int neighbors = (2 * radius + 1) * (2 * radius + 1) - 1;
+
+    state.SetItemsProcessed(state.iterations() * 2 * cells.size());
+    state.counters["cells/s"] = benchmark::Counter(
+                static_cast<double>(state.iterations()) * 2 * cells.size() * neighbors,
+                benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_NotifyNeighbors)
+    ->ArgNames({ "size", "radius", "tile", "mask" })
+    ->ArgsProduct({ { 128, 512, 4096 }, { 1, 3, 5, 8 }, { 0, 8 }, { 0, 1 } });
+
+static void BM_RandomFloat(benchmark::State& state)
+{
+    RandomNumber random;
+
+    for(auto _ : state)
+    {
+        benchmark::DoNotOptimize(random.GetRandomFloat());
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_RandomFloat);
+
+static void BM_RandomInt(benchmark::State& state)
+{
+    RandomNumber random;
+    int max = state.range(0);
+
+    for(auto _ : state)
+    {
+        benchmark::DoNotOptimize(random.GetRandomInt(0, max));
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_RandomInt)->Arg(10)->Arg(4095);
@@ -0,0 +1,407 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTextStream>
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+#include "localcapso.h"
+#include "perfcounters.h"
+#include "util.h"
+
+// End to end throughput of LocalCaPso: runs full seasons of independent
+// replicates for every combination of lattice size, number of replicates and
+// number of threads, and reports the rates as JSON, e.g.,
+//   QtCaPso_throughput --sizes 256,512 --replicates 8 --threads 1,2,4
+//                      --output current.json --baseline baseline.json
+// With --counters the hardware events of every stage are reported as well.
+
+struct Case
+{
+    int size;
+    int replicates;
+    int threads;
+
+    double seconds            = { 0.0 };
+    double seasonsPerSecond   = { 0.0 };
+    double cellsPerSecond     = { 0.0 };
+    qint64 peakRssKiB         = { 0 };
+    double parallelEfficiency = { 1.0 };
+
+    // Hardware events of every stage added over all the threads
+    std::array<PerfCounters::Values, 6> stageEvents = {};
+};
+
+// Linux allows resetting the peak resident set size of the process, so every
+// case can report its own. Elsewhere the peak of the whole run is reported.
+static void resetPeakRss()
+{
+#ifdef __linux__
+    std::ofstream clearRefs("/proc/self/clear_refs");
+    clearRefs << "5";
+#endif
+}
+
+static qint64 peakRss()
+{
+#ifdef __linux__
+    std::ifstream status("/proc/self/status");
+    std::string line;
+
+    while(std::getline(status, line))
+    {
+        if(line.compare(0, 6, "VmHWM:") == 0)
+        {
+            return std::stoll(line.substr(6));
+        }
+    }
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1024;
+#else
+    return usage.ru_maxrss;
+#endif
+#else
+    return 0;
+#endif
+}
+
+static QList<int> parseList(const QString& text)
+{
+    QList<int> values;
+
+    for(const QString& value : text.split(',', Qt::SkipEmptyParts))
+    {
+        if(value.toInt() > 0)
+        {
+            values << value.toInt();
+        }
+    }
+
+    return values;
+}
+
+static void runCase(Case& c, const CaPsoSettings& settings, int seasons, bool countEvents)
+{
+    std::atomic<int> nextReplicate(0);
+    std::mutex eventsMutex;
+
+    // Every thread takes the next replicate until none is left, replicates
+    // are created and initialized inside the threads as in a batch
+    auto worker = [&]()
+    {
+        // The counters only count the events of the thread that opens them
+        PerfCounters counters;
+        std::array<PerfCounters::Values, 6> stageEvents = {};
+
+        for(int r = nextReplicate++; r < c.replicates; r = nextReplicate++)
+        {
+            LocalCaPso ca(c.size, c.size);
+            ca.setSettings(settings);
+            ca.initialize();
+
+            // Events are counted per stage, otherwise whole seasons are run
+            // as a batch does
+            if(!countEvents)
+            {
+                ca.advanceSeasons(seasons);
+                continue;
+            }
+
+            for(int genCount = 0; genCount < seasons * 10; genCount++)
+            {
+                int stage = ca.currentStage();
+
+                counters.start();
+
+                ca.nextGen();
+
+                PerfCounters::Values events = counters.stop();
+
+                for(int event = 0; event < PerfCounters::NUMBER_OF_EVENTS; event++)
+                {
+                    stageEvents[stage][event] += events[event];
+                }
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(eventsMutex);
+
+        for(int stage = 0; stage < 6; stage++)
+        {
+            for(int event = 0; event < PerfCounters::NUMBER_OF_EVENTS; event++)
+            {
+                c.stageEvents[stage][event] += stageEvents[stage][event];
+            }
+        }
+    };
+
+    resetPeakRss();
+
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> threads;
+
+    for(int t = 1; t < c.threads; t++)
+    {
+        threads.emplace_back(worker);
+    }
+
+    worker();
+
+    for(auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    c.seconds = elapsed.count();
+    c.seasonsPerSecond = c.replicates * seasons / c.seconds;
+    c.cellsPerSecond = c.seasonsPerSecond * 10.0 * c.size * c.size;
+    c.peakRssKiB = peakRss();
+}
+
+static QJsonObject toJson(const Case& c, const PerfCounters* counters)
+{
+    QJsonObject json;
+    json["size"] = c.size;
+    json["replicates"] = c.replicates;
+    json["threads"] = c.threads;
+    json["seconds"] = c.seconds;
+    json["seasonsPerSecond"] = c.seasonsPerSecond;
+    json["cellsPerSecond"] = c.cellsPerSecond;
+    json["peakRssKiB"] = c.peakRssKiB;
+    json["parallelEfficiency"] = c.parallelEfficiency;
+
+    if(counters)
+    {
+        QJsonObject stages;
+
+        for(int stage = 0; stage < 6; stage++)
+        {
+            QJsonObject events;
+
+            for(int event = 0; event < PerfCounters::NUMBER_OF_EVENTS; event++)
+            {
+                auto e = static_cast<PerfCounters::Event>(event);
+
+                if(counters->available(e))
+                {
+                    events[PerfCounters::eventName(e)] =
+                            static_cast<qint64>(c.stageEvents[stage][event]);
+                }
+            }
+
+            stages[LocalCaPso::stageName(stage)] = events;
+        }
+
+        json["stages"] = stages;
+    }
+
+    return json;
+}
+
+// Compare every case with the case of the baseline that has the same size,
+// replicates and threads, returns the number of regressions
+static int compare(const QVector<Case>& cases, const QJsonArray& baseline,
+                   double tolerance, QTextStream& report)
+{
+    int regressions = 0;
+
+    for(const Case& c : cases)
+    {
+        for(const QJsonValue& value : baseline)
+        {
+            QJsonObject base = value.toObject();
+
+            if(base["size"].toInt() != c.size || base["replicates"].toInt() != c.replicates ||
+               base["threads"].toInt() != c.threads)
+            {
+                continue;
+            }
+
+            double baseRate = base["seasonsPerSecond"].toDouble();
+            double baseRss = base["peakRssKiB"].toDouble();
+
+            bool slower = c.seasonsPerSecond < baseRate * (1.0 - tolerance);
+            bool larger = baseRss > 0 && c.peakRssKiB > baseRss * (1.0 + tolerance);
+
+            report << QString("size %1 replicates %2 threads %3: %4 seasons/s (baseline %5, %6%)")
+                      .arg(c.size).arg(c.replicates).arg(c.threads)
+                      .arg(c.seasonsPerSecond, 0, 'f', 2).arg(baseRate, 0, 'f', 2)
+                      .arg(baseRate > 0 ? 100.0 * (c.seasonsPerSecond / baseRate - 1.0) : 0.0, 0, 'f', 1);
+
+            if(slower)
+            {
+                report << " REGRESSION";
+            }
+
+            if(larger)
+            {
+                report << QString(" MEMORY REGRESSION (%1 KiB, baseline %2 KiB)")
+                          .arg(c.peakRssKiB).arg(baseRss);
+            }
+
+            report << Qt::endl;
+
+            regressions += (slower || larger) ? 1 : 0;
+        }
+    }
+
+    return regressions;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("End to end throughput and scaling of LocalCaPso.");
+    parser.addHelpOption();
+    parser.addOption({ "sizes", "Comma separated sides of the lattice.", "list", "256,512,1024" });
+    parser.addOption({ "replicates", "Comma separated numbers of replicates.", "list", "1,4" });
+    parser.addOption({ "threads", "Comma separated numbers of threads.", "list", "1,2,4" });
+    parser.addOption({ "seasons", "Seasons simulated by every replicate.", "n", "10" });
+    parser.addOption({ "settings", "Model settings file (json).", "file" });
+    parser.addOption({ "output", "Write the results to a file instead of stdout.", "file" });
+    parser.addOption({ "baseline", "Compare the results with a previous output.", "file" });
+    parser.addOption({ "counters", "Count the hardware events of every stage." });
+    parser.addOption({ "tolerance", "Relative slow down allowed by the comparison.", "fraction", "0.1" });
+    parser.process(a);
+
+    QTextStream err(stderr);
+
+    CaPsoSettings settings;
+
+    if(parser.isSet("settings") && !util::loadSettings(settings, parser.value("settings")))
+    {
+        err << "Cannot read settings file: " << parser.value("settings") << Qt::endl;
+        return 1;
+    }
+
+    int seasons = std::max(1, parser.value("seasons").toInt());
+
+    // Probe which events this machine can count, every thread then opens its
+    // own counters
+    PerfCounters probe;
+    bool countEvents = parser.isSet("counters") && probe.available();
+
+    if(parser.isSet("counters") && !countEvents)
+    {
+        err << "Hardware counters are not available, check perf_event_paranoid" << Qt::endl;
+    }
+
+    QVector<Case> cases;
+
+    for(int size : parseList(parser.value("sizes")))
+    {
+        for(int replicates : parseList(parser.value("replicates")))
+        {
+            for(int threads : parseList(parser.value("threads")))
+            {
+                Case c;
+                c.size = size;
+                c.replicates = replicates;
+                c.threads = threads;
+
+                err << QString("Running size %1, %2 replicates, %3 threads... ")
+                       .arg(size).arg(replicates).arg(threads) << Qt::flush;
+
+                runCase(c, settings, seasons, countEvents);
+
+                err << QString("%1 seasons/s").arg(c.seasonsPerSecond, 0, 'f', 2) << Qt::endl;
+
+                cases << c;
+            }
+        }
+    }
+
+    // The parallel efficiency is relative to the case with the fewest
+    // threads for the same size and replicates
+    for(Case& c : cases)
+    {
+        auto reference = std::min_element(cases.begin(), cases.end(),
+                                          [&c](const Case& lhs, const Case& rhs)
+        {
+            bool lhsMatches = lhs.size == c.size && lhs.replicates == c.replicates;
+            bool rhsMatches = rhs.size == c.size && rhs.replicates == c.replicates;
+
+            return lhsMatches != rhsMatches ? lhsMatches : lhs.threads < rhs.threads;
+        });
+
+        c.parallelEfficiency = (c.seasonsPerSecond / reference->seasonsPerSecond) *
+                               reference->threads / c.threads;
+    }
+
+    QJsonArray results;
+
+    for(const Case& c : cases)
+    {
+        results.append(toJson(c, countEvents ? &probe : nullptr));
+    }
+
+    QJsonObject json;
+    json["seasons"] = seasons;
+    json["settings"] = parser.isSet("settings") ? parser.value("settings") : "default";
+    json["hardwareThreads"] = static_cast<int>(std::thread::hardware_concurrency());
+    json["results"] = results;
+
+    QByteArray document = QJsonDocument(json).toJson();
+
+    if(parser.isSet("output"))
+    {
+        QFile output(parser.value("output"));
+
+        if(!output.open(QIODevice::WriteOnly | QIODevice::Truncate) ||
+           output.write(document) != document.size())
+        {
+            err << "Cannot write file: " << parser.value("output") << Qt::endl;
+            return 1;
+        }
+    }
+    else
+    {
+        QTextStream(stdout) << document;
+    }
+
+    if(parser.isSet("baseline"))
+    {
+        QFile baselineFile(parser.value("baseline"));
+
+        if(!baselineFile.open(QIODevice::ReadOnly))
+        {
+            err << "Cannot read baseline file: " << parser.value("baseline") << Qt::endl;
+            return 1;
+        }
+
+        QJsonArray baseline = QJsonDocument::fromJson(baselineFile.readAll())
+                .object()["results"].toArray();
+
+        int regressions = compare(cases, baseline, parser.value("tolerance").toDouble(), err);
+
+        if(regressions > 0)
+        {
+            err << regressions << " regression(s) against " << parser.value("baseline") << Qt::endl;
+            return 2;
+        }
+    }
+
+    return 0;
+}
@@ -1,11 +1,15 @@
+#include <deque>
 #include <QProgressDialog>
 #include <QtConcurrentMap>
 #include <QFutureWatcher>
 #include <QFile>
 #include <QTextStream>
 #include <QDir>
+#include <QMessageBox>
+#include <QMutexLocker>
 #include "batchdialog.h"
 #include "localcapso.h"
+#include "tracer.h"
 #include "util.h"
 
 BatchDialog::BatchDialog(QWidget *parent, CaType type) :
@@ -17,6 +21,9 @@ BatchDialog::BatchDialog(QWidget *parent, CaType type) :
 
     buttonStart->setAutoDefault(false);
     buttonStart->setEnabled(false);
+
+    // Profiling data only exists when it was compiled in
+    checkBoxProfiling->setEnabled(profilingEnabled());
 }
 
 void BatchDialog::on_buttonBrowseSettings_clicked()
@@ -45,11 +52,35 @@ void BatchDialog::on_buttonAdd_clicked()
         // Create a new batch item an add it to the list
         BatchItem item(lineEditSettingsFile->text(), width, height,
                        spinBoxSimulations->value(), spinBoxSeasons->value(),
-                       lineEditFilenamePrefix->text(), lineEditPath->text());
+                       spinBoxBurnIn->value(),
+                       lineEditFilenamePrefix->text(), lineEditPath->text(),
+                       checkBoxProfiling->isChecked(), checkBoxSummary->isChecked(),
+                       StopRule(checkBoxStopPredators->isChecked(),
+                                checkBoxStopPreys->isChecked(),
+                                spinBoxSteadyWindow->value(),
+                                doubleSpinBoxSteadyThreshold->value() / 100.0),
+                       checkBoxFillStopped->isChecked(),
+                       ConvergenceTarget(static_cast<ConvergenceTarget::Statistic>(
+                                             comboConvergence->currentIndex()),
+                                         doubleSpinBoxHalfWidth->value(),
+                                         spinBoxMaxSimulations->value()));
 
         batchItems << item;
 
-        listWidgetJobs->addItem(lineEditSettingsFile->text());
+        // Sweeps show how many simulations they expand into
+        Sweep sweep;
+        int replicates = spinBoxSimulations->value();
+
+        if(util::loadSweep(sweep, replicates, lineEditSettingsFile->text()))
+        {
+            listWidgetJobs->addItem(QString("%1 (sweep of %2 points x %3)")
+                                    .arg(lineEditSettingsFile->text())
+                                    .arg(sweep.numberOfPoints()).arg(replicates));
+        }
+        else
+        {
+            listWidgetJobs->addItem(lineEditSettingsFile->text());
+        }
 
         buttonStart->setEnabled(true);
     }
@@ -106,16 +137,240 @@ void BatchDialog::on_lineEditPath_textChanged(QString text)
     }
 }
 
+static void writeProfile(QTextStream& stream, const LocalCaPso& ca)
+{
+    // A second table after a blank line, one row per stage
+    stream << "\nStage," <<
+              "Calls," <<
+              "Seconds," <<
+              "CellsVisited," <<
+              "RandomDraws," <<
+              "NotifyCalls," <<
+              "Births," <<
+              "Deaths," <<
+              "ParticleMoves\n";
+
+    for(int stage = 0; stage < 6; stage++)
+    {
+        const StageProfile& profile = ca.stageProfile(stage);
+
+        stream << LocalCaPso::stageName(stage) << "," <<
+                  profile.calls << "," <<
+                  profile.seconds << "," <<
+                  profile.cellsVisited << "," <<
+                  profile.randomDraws << "," <<
+                  profile.notifyCalls << "," <<
+                  profile.births << "," <<
+                  profile.deaths << "," <<
+                  profile.particleMoves << "\n";
+    }
+}
+
+// Records a span for every stage of a traced simulation
+struct StageTracer : NullObserver
+{
+    void stageBegin(const StageCounts& counts)
+    {
+        Tracer::instance().begin(LocalCaPso::stageName(counts.stage), "stage");
+    }
+
+    void stageEnd(const StageCounts& counts)
+    {
+        Tracer::instance().end(LocalCaPso::stageName(counts.stage), "stage");
+    }
+};
+
+// Simulates the given number of seasons, or until the stop rule holds, and
+// returns the populations and rates at the start of every season
+static std::vector<SeasonRecord> runSimulation(LocalCaPso& ca, int numberOfSeasons,
+                                               StopRule& stopRule, bool fillStoppedSeasons)
+{
+    bool tracing = Tracer::instance().enabled();
+
+    ca.resetProfile();
+
+    std::vector<SeasonRecord> records;
+    records.reserve(numberOfSeasons);
+
+    auto season = [&](const SeasonRecord& record)
+    {
+        if(tracing)
+        {
+            if(record.season > 0)
+            {
+                Tracer::instance().end("Season", "season");
+            }
+
+            Tracer::instance().begin("Season", "season", record.season);
+        }
+
+        records.push_back(record);
+
+        return stopRule.update(record.season, record.preys,
+                               record.predators) == StopRule::NONE;
+    };
+
+    if(tracing)
+    {
+        ca.advanceSeasons(numberOfSeasons, season, StageTracer());
+    }
+    else
+    {
+        ca.advanceSeasons(numberOfSeasons, season);
+    }
+
+    if(tracing && numberOfSeasons > 0)
+    {
+        Tracer::instance().end("Season", "season");
+    }
+
+    // Repeating the last season is exact once both species are extinct, and
+    // an approximation of the dynamics that remain otherwise
+    if(fillStoppedSeasons && !records.empty())
+    {
+        SeasonRecord last = records.back();
+
+        while(static_cast<int>(records.size()) < numberOfSeasons)
+        {
+            last.season++;
+            records.push_back(last);
+        }
+    }
+
+    return records;
+}
+
+static void writeRecords(QTextStream& resultsStream, const std::vector<SeasonRecord>& records)
+{
+    // Write header containing columns names
+    resultsStream << "Season," <<
+                     "Preys," <<
+                     "Predators," <<
+                     "PreyCountBeforeReproduction," <<
+                     "PreyBirthRate," <<
+                     "PredatorCountBeforeReproduction," <<
+                     "PredatorBirthRate," <<
+                     "PreyCountBeforePredatorDeath," <<
+                     "PredatorDeathProbability," <<
+                     "PredatorCountBeforePreyDeath," <<
+                     "PreyDeathProbability\n";
+
+    for(const SeasonRecord& record : records)
+    {
+        resultsStream << record.season << "," <<
+                         record.preys << "," <<
+                         record.predators << "," <<
+                         record.preyCountBeforeReproduction << "," <<
+                         record.preyBirthRate << "," <<
+                         record.predatorCountBeforeReproduction << "," <<
+                         record.predatorBirthRate << "," <<
+                         record.preyCountBeforePredatorDeath << "," <<
+                         record.predatorDeathProbability << "," <<
+                         record.predatorCountBeforePreyDeath << "," <<
+                         record.preyDeathProbability << "\n";
+    }
+}
+
+// One row per season with the statistics of every metric over the replicates
+static bool writeSummary(const QString& filename, const SeasonAggregator& aggregator)
+{
+    QFile summaryFile(filename);
+
+    if(!summaryFile.open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Truncate))
+    {
+        return false;
+    }
+
+    QTextStream summaryStream(&summaryFile);
+
+    summaryStream << "Season,Replicates";
+
+    for(int metric = 0; metric < SeasonAggregator::NUMBER_OF_METRICS; metric++)
+    {
+        QString name = SeasonAggregator::metricName(metric);
+
+        summaryStream << "," << name << "Mean," << name << "Variance," <<
+                         name << "Q05," << name << "Median," << name << "Q95";
+    }
+
+    summaryStream << ",PreyExtinction,PredatorExtinction\n";
+
+    for(int season = 0; season < aggregator.numberOfSeasons(); season++)
+    {
+        summaryStream << season << "," <<
+                         aggregator.statistics(season, SeasonAggregator::PREYS).count();
+
+        for(int metric = 0; metric < SeasonAggregator::NUMBER_OF_METRICS; metric++)
+        {
+            auto m = static_cast<SeasonAggregator::Metric>(metric);
+            const RunningStatistics& statistics = aggregator.statistics(season, m);
+
+            summaryStream << "," << statistics.mean() << "," << statistics.variance() << "," <<
+                             aggregator.quantile(season, m, SeasonAggregator::Q05) << "," <<
+                             aggregator.quantile(season, m, SeasonAggregator::MEDIAN) << "," <<
+                             aggregator.quantile(season, m, SeasonAggregator::Q95);
+        }
+
+        summaryStream << "," << aggregator.preyExtinction(season) <<
+                         "," << aggregator.predatorExtinction(season) << "\n";
+    }
+
+    return true;
+}
+
 void BatchDialog::processItem(BatchItem& batchItem)
 {
+    Tracer::Scope itemScope("Item", "item", -1,
+                            QFile::encodeName(batchItem.settingsFile()).toStdString());
+
     CaPsoSettings settings;
     util::loadSettings(settings, batchItem.settingsFile());
 
-    LocalCaPso* localCaPso = new LocalCaPso(batchItem.width(), batchItem.height());
-    localCaPso->setSettings(settings);
+    LocalCaPso* warmedUpCaPso = new LocalCaPso(batchItem.width(), batchItem.height());
+    warmedUpCaPso->setSettings(settings);
+
+    // Simulate the transient only once, every simulation of this item is then
+    // forked from the resulting state
+    if(batchItem.numberOfBurnInSeasons() > 0)
+    {
+        Tracer::Scope burnInScope("BurnIn", "simulation");
+
+        warmedUpCaPso->initialize();
+
+        warmedUpCaPso->advanceSeasons(batchItem.numberOfBurnInSeasons());
+    }
+
+    SeasonAggregator aggregator(batchItem.numberOfSeasons());
 
     for (int simIndex = 0, fileIndex = 0; simIndex < batchItem.numberOfSimulations(); ++simIndex, ++fileIndex)
     {
+        Tracer::Scope simulationScope("Simulation", "simulation", simIndex);
+
+        std::unique_ptr<LocalCaPso> replicate;
+        LocalCaPso* localCaPso = warmedUpCaPso;
+
+        if(batchItem.numberOfBurnInSeasons() > 0)
+        {
+            replicate = warmedUpCaPso->clone(simIndex + 1);
+            localCaPso = replicate.get();
+        }
+        else
+        {
+            localCaPso->initialize();
+        }
+
+        StopRule stopRule = batchItem.stopRule();
+        std::vector<SeasonRecord> records = runSimulation(*localCaPso, batchItem.numberOfSeasons(),
+                                                          stopRule, batchItem.fillStoppedSeasons());
+
+        addTermination(batchItem, -1, simIndex, stopRule);
+
+        if(batchItem.summaryOnly())
+        {
+            aggregator.add(records);
+            continue;
+        }
+
         // Initialize filename for results file
         QString filename = batchItem.resultsPath() + batchItem.filenamePrefix() +
                 "_" + QString::number(fileIndex) + ".csv";
@@ -134,72 +389,237 @@ void BatchDialog::processItem(BatchItem& batchItem)
         resultsFile.open(QIODevice::WriteOnly | QIODevice::Text |
                          QIODevice::Truncate);
 
-        localCaPso->initialize();
-
-        int preyCountBeforeReproduction = 0;
-        int predatorCountBeforeReproduction = 0;
-        int preyCountBeforePredatorDeath = 0;
-        int predatorCountBeforePreyDeath = 0;
-
-        // Write header containing columns names
-        resultsStream << "Season," <<
-                         "Preys," <<
-                         "Predators," <<
-                         "PreyCountBeforeReproduction," <<
-                         "PreyBirthRate," <<
-                         "PredatorCountBeforeReproduction," <<
-                         "PredatorBirthRate," <<
-                         "PreyCountBeforePredatorDeath," <<
-                         "PredatorDeathProbability," <<
-                         "PredatorCountBeforePreyDeath," <<
-                         "PreyDeathProbability\n";
-
-        for(int genCount = 0; genCount < batchItem.numberOfSeasons() * 10; genCount++)
-        {
-            switch(localCaPso->currentStage())
+        writeRecords(resultsStream, records);
+
+        if(batchItem.appendProfiling())
+        {
+            writeProfile(resultsStream, *localCaPso);
+        }
+
+        resultsFile.close();
+    }
+
+    if(batchItem.summaryOnly())
+    {
+        // Same naming as the results files, an existing summary is kept
+        QString filename = batchItem.resultsPath() + batchItem.filenamePrefix() + "_summary.csv";
+
+        for(int fileIndex = 1; QFile::exists(filename); fileIndex++)
+        {
+            filename = batchItem.resultsPath() + batchItem.filenamePrefix() +
+                    "_summary_" + QString::number(fileIndex) + ".csv";
+        }
+
+        writeSummary(filename, aggregator);
+    }
+
+    delete warmedUpCaPso;
+}
+
+void BatchDialog::processPoint(const BatchItem& batchItem, const Task& task)
+{
+    Tracer::Scope simulationScope("Simulation", "simulation", task.replicate,
+                                  "point " + std::to_string(task.point));
+
+    LocalCaPso localCaPso(batchItem.width(), batchItem.height());
+    localCaPso.setSettings(task.settings);
+    localCaPso.initialize();
+
+    // Every replicate runs its own transient, forking them from a single
+    // one would serialize the replicates of a point
+    localCaPso.advanceSeasons(batchItem.numberOfBurnInSeasons());
+
+    StopRule stopRule = batchItem.stopRule();
+    std::vector<SeasonRecord> records = runSimulation(localCaPso, batchItem.numberOfSeasons(),
+                                                      stopRule, batchItem.fillStoppedSeasons());
+
+    addTermination(batchItem, task.point, task.replicate, stopRule);
+
+    // Results are indexed by point and replicate, a sweep run again
+    // overwrites its previous results
+    QString filename = batchItem.resultsPath() + batchItem.filenamePrefix() +
+            "_" + QString::number(task.point);
+
+    if(task.target)
+    {
+        double value = ConvergenceTarget::replicateValue(task.target->statistic(), records,
+                                                         batchItem.width() * batchItem.height(),
+                                                         batchItem.numberOfSeasons());
+
+        QMutexLocker locker(&mTargetsMutex);
+        task.target->add(value);
+    }
+
+    if(task.aggregator)
+    {
+        // The replicate that completes the point writes its summary
+        if(task.aggregator->add(records) == task.replicates)
+        {
+            writeSummary(filename + "_summary.csv", *task.aggregator);
+        }
+
+        return;
+    }
+
+    QFile resultsFile(filename + "_" + QString::number(task.replicate) + ".csv");
+
+    QTextStream resultsStream(&resultsFile);
+    resultsFile.open(QIODevice::WriteOnly | QIODevice::Text |
+                     QIODevice::Truncate);
+
+    writeRecords(resultsStream, records);
+
+    if(batchItem.appendProfiling())
+    {
+        writeProfile(resultsStream, localCaPso);
+    }
+
+    resultsFile.close();
+}
+
+// Writes the parameter values of every point of a sweep to <prefix>_points.csv
+bool BatchDialog::writePoints(const BatchItem& batchItem, const Sweep& sweep)
+{
+    QFile pointsFile(batchItem.resultsPath() + batchItem.filenamePrefix() + "_points.csv");
+
+    if(!pointsFile.open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Truncate))
+    {
+        return false;
+    }
+
+    QTextStream pointsStream(&pointsFile);
+
+    pointsStream << "Point";
+
+    for(int parameter = 0; parameter < sweep.numberOfParameters(); parameter++)
+    {
+        pointsStream << "," << QString::fromStdString(sweep.parameterName(parameter));
+    }
+
+    pointsStream << "\n";
+
+    for(int point = 0; point < sweep.numberOfPoints(); point++)
+    {
+        pointsStream << point;
+
+        for(double value : sweep.pointValues(point))
+        {
+            pointsStream << "," << value;
+        }
+
+        pointsStream << "\n";
+    }
+
+    return true;
+}
+
+void BatchDialog::addTermination(const BatchItem& batchItem, int point, int replicate,
+                                 const StopRule& stopRule)
+{
+    if(stopRule.reason() == StopRule::NONE)
+    {
+        return;
+    }
+
+    QMutexLocker locker(&mTerminationsMutex);
+
+    mTerminations << Termination{ &batchItem, point, replicate,
+                                  stopRule.stopSeason(), stopRule.reason() };
+}
+
+// Writes the simulations of every item that stopped early, with the season
+// and the reason, to <prefix>_termination.csv
+bool BatchDialog::writeTerminations()
+{
+    for(const BatchItem& batchItem : batchItems)
+    {
+        if(!batchItem.stopRule().enabled())
+        {
+            continue;
+        }
+
+        QFile terminationFile(batchItem.resultsPath() + batchItem.filenamePrefix() +
+                              "_termination.csv");
+
+        if(!terminationFile.open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Truncate))
+        {
+            return false;
+        }
+
+        QTextStream terminationStream(&terminationFile);
+
+        terminationStream << "Point,Replicate,Season,Reason\n";
+
+        for(const Termination& termination : mTerminations)
+        {
+            if(termination.batchItem != &batchItem)
             {
-            case 2:
-                predatorCountBeforeReproduction = localCaPso->numberOfPredators();
-                break;
-            case 3:
-                preyCountBeforePredatorDeath = localCaPso->numberOfPreys();
-                break;
-            case 4:
-                predatorCountBeforePreyDeath = localCaPso->numberOfPredators();
-                break;
-            case 5:
-                preyCountBeforeReproduction = localCaPso->numberOfPreys();
-                break;
+                continue;
             }
 
-            if(!(genCount % 10))
+            // Items that are not sweeps have no point
+            if(termination.point >= 0)
             {
-                resultsStream << genCount / 10 << "," <<
-                                 localCaPso->numberOfPreys() << "," <<
-                                 localCaPso->numberOfPredators() << "," <<
-                                 preyCountBeforeReproduction << "," <<
-                                 localCaPso->preyBirthRate() << "," <<
-                                 predatorCountBeforeReproduction << "," <<
-                                 localCaPso->predatorBirthRate() << "," <<
-                                 preyCountBeforePredatorDeath << "," <<
-                                 localCaPso->predatorDeathProbability() << "," <<
-                                 predatorCountBeforePreyDeath << "," <<
-                                 localCaPso->preyDeathProbability() << "\n";
+                terminationStream << termination.point;
             }
 
-            localCaPso->nextGen();
+            terminationStream << "," << termination.replicate << "," <<
+                                 termination.season << "," <<
+                                 StopRule::reasonName(termination.reason) << "\n";
         }
+    }
 
-        resultsFile.close();
+    return true;
+}
+
+// Writes the estimate of the target statistic of every point of an item
+// that ran in waves to <prefix>_convergence.csv
+bool BatchDialog::writeConvergence(const BatchItem& batchItem,
+                                   const std::deque<SequentialPoint>& points)
+{
+    QFile convergenceFile(batchItem.resultsPath() + batchItem.filenamePrefix() +
+                          "_convergence.csv");
+
+    if(!convergenceFile.open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Truncate))
+    {
+        return false;
     }
 
-    delete localCaPso;
+    QTextStream convergenceStream(&convergenceFile);
+
+    convergenceStream << "Point,Replicates,Statistic,Estimate,HalfWidth,Converged\n";
+
+    for(const SequentialPoint& point : points)
+    {
+        if(point.batchItem != &batchItem)
+        {
+            continue;
+        }
+
+        convergenceStream << point.point << "," <<
+                             point.target.count() << "," <<
+                             ConvergenceTarget::statisticName(point.target.statistic()) << "," <<
+                             point.target.estimate() << "," <<
+                             point.target.halfWidth() << "," <<
+                             (point.target.converged() ? 1 : 0) << "\n";
+    }
+
+    return true;
 }
 
-void BatchDialog::on_buttonStart_clicked()
+bool BatchDialog::runTasks(QList<Task>& tasks, int wave)
 {
     QProgressDialog progressDialog;
-    progressDialog.setLabelText("Processing jobs. Please wait.");
+
+    if(wave > 0)
+    {
+        progressDialog.setLabelText(QString("Processing wave %1 of replicates. Please wait.")
+                                    .arg(wave + 1));
+    }
+    else
+    {
+        progressDialog.setLabelText("Processing jobs. Please wait.");
+    }
 
     QFutureWatcher<void> futureWatcher;
     connect(&futureWatcher, SIGNAL(finished()),
@@ -214,9 +634,16 @@ void BatchDialog::on_buttonStart_clicked()
     // Start the computation. To be able to use a member function in the call to
     // map(), an instance to the containing class is needed, i.e., the 'this'
     // pointer. A lambda is used hwere to provide such pointer.
-    futureWatcher.setFuture(QtConcurrent::map(batchItems, [this](BatchItem& batchItem)
+    futureWatcher.setFuture(QtConcurrent::map(tasks, [this](Task& task)
     {
-        processItem(batchItem);
+        if(task.point < 0)
+        {
+            processItem(batchItems[task.item]);
+        }
+        else
+        {
+            processPoint(batchItems[task.item], task);
+        }
     }));
 
 
@@ -225,6 +652,162 @@ void BatchDialog::on_buttonStart_clicked()
 
     futureWatcher.waitForFinished();
 
+    return !futureWatcher.future().isCanceled();
+}
+
+void BatchDialog::on_buttonStart_clicked()
+{
+    // Sweep items are expanded into a task per replicate of every point so
+    // that they spread over all the cores, other items are a single task
+    QList<Task> tasks;
+
+    // Shared by the replicates of every point of the sweeps in summary mode
+    std::vector<std::unique_ptr<SeasonAggregator>> aggregators;
+
+    // Points of the items with a convergence target, whose replicates are
+    // launched in waves. A deque keeps the targets in place for the tasks.
+    std::deque<SequentialPoint> sequentialPoints;
+
+    for(int item = 0; item < batchItems.size(); item++)
+    {
+        const BatchItem& batchItem = batchItems[item];
+
+        Sweep sweep;
+        int replicates = batchItem.numberOfSimulations();
+        bool isSweep = util::loadSweep(sweep, replicates, batchItem.settingsFile());
+        bool sequential = batchItem.convergenceTarget().enabled();
+
+        if(!isSweep && !sequential)
+        {
+            tasks << Task{ item, -1, 0, 0, CaPsoSettings(), nullptr, nullptr };
+            continue;
+        }
+
+        if(isSweep && !writePoints(batchItem, sweep))
+        {
+            QMessageBox::critical(this, "Error!", "Cannot write file: " +
+                                  batchItem.resultsPath() + batchItem.filenamePrefix() +
+                                  "_points.csv");
+            return;
+        }
+
+        // An item that is not a sweep is a sweep of a single point
+        CaPsoSettings base;
+        util::loadSettings(base, batchItem.settingsFile());
+
+        for(int point = 0; point < sweep.numberOfPoints(); point++)
+        {
+            SeasonAggregator* aggregator = nullptr;
+
+            if(batchItem.summaryOnly())
+            {
+                aggregators.emplace_back(new SeasonAggregator(batchItem.numberOfSeasons()));
+                aggregator = aggregators.back().get();
+            }
+
+            if(sequential)
+            {
+                sequentialPoints.push_back({ &batchItem, item, point, sweep.settings(base, point),
+                                             aggregator, batchItem.convergenceTarget(),
+                                             replicates, 0 });
+                continue;
+            }
+
+            for(int replicate = 0; replicate < replicates; replicate++)
+            {
+                tasks << Task{ item, point, replicate, replicates,
+                               sweep.settings(base, point), aggregator, nullptr };
+            }
+        }
+    }
+
+    if(checkBoxTrace->isChecked())
+    {
+        Tracer::instance().start();
+    }
+
+    // The first wave runs every other task and the first replicates of the
+    // sequential points, the next ones only the points that did not converge
+    for(SequentialPoint& point : sequentialPoints)
+    {
+        point.launched = std::min(point.firstWave, point.target.maximumReplicates());
+    }
+
+    bool canceled = false;
+
+    for(int wave = 0; !canceled; wave++)
+    {
+        for(SequentialPoint& point : sequentialPoints)
+        {
+            int launched = point.launched;
+
+            if(wave > 0)
+            {
+                point.launched += point.target.additionalReplicates(launched);
+            }
+            else
+            {
+                launched = 0;
+            }
+
+            // The number of replicates is not known in advance, summaries
+            // are written once the waves are over
+            for(int replicate = launched; replicate < point.launched; replicate++)
+            {
+                tasks << Task{ point.item, point.point, replicate, -1,
+                               point.settings, point.aggregator, &point.target };
+            }
+        }
+
+        if(tasks.isEmpty())
+        {
+            break;
+        }
+
+        canceled = !runTasks(tasks, wave);
+
+        tasks.clear();
+    }
+
+    for(const SequentialPoint& point : sequentialPoints)
+    {
+        if(point.aggregator)
+        {
+            writeSummary(point.batchItem->resultsPath() + point.batchItem->filenamePrefix() +
+                         "_" + QString::number(point.point) + "_summary.csv", *point.aggregator);
+        }
+    }
+
+    for(const BatchItem& batchItem : batchItems)
+    {
+        if(batchItem.convergenceTarget().enabled() && !writeConvergence(batchItem, sequentialPoints))
+        {
+            QMessageBox::critical(this, "Error!", "Cannot write file: " +
+                                  batchItem.resultsPath() + batchItem.filenamePrefix() +
+                                  "_convergence.csv");
+        }
+    }
+
+    if(!writeTerminations())
+    {
+        QMessageBox::critical(this, "Error!", "Cannot write the termination files to: " +
+                              lineEditPath->text());
+    }
+
+    mTerminations.clear();
+
+    if(checkBoxTrace->isChecked())
+    {
+        Tracer::instance().stop();
+
+        QString traceFilename = lineEditPath->text() + "batch_trace.json";
+
+        if(!Tracer::instance().write(QFile::encodeName(traceFilename).toStdString()))
+        {
+            QMessageBox::critical(this, "Error!", "Cannot write file: " + traceFilename);
+        }
+    }
+
     // Query the future to check if was canceled
-    qDebug() << "Canceled?" << futureWatcher.future().isCanceled();
+    qDebug() << "Canceled?" << canceled;
 }
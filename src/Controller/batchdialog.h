@@ -1,10 +1,15 @@
 #pragma once
 
+#include <deque>
 #include <QDialog>
 #include <QList>
+#include <QMutex>
 #include "ui_batchdialog.h"
 #include "capsosettings.h"
 #include "batchitem.h"
+#include "convergencetarget.h"
+#include "seasonaggregator.h"
+#include "sweep.h"
 
 class BatchDialog : public QDialog, private Ui::BatchDialog
 {
@@ -22,9 +27,63 @@ private slots:
     void on_lineEditPath_textChanged(QString text);
 
 private:
+    // A unit of work of a batch, either a whole item or a single replicate
+    // of a point of a sweep item
+    struct Task
+    {
+        int item;
+        int point;
+        int replicate;
+        int replicates;
+        CaPsoSettings settings;
+        SeasonAggregator* aggregator;
+        ConvergenceTarget* target;
+    };
+
+    // A point whose replicates are launched in waves until the confidence
+    // interval of its target statistic is narrow enough
+    struct SequentialPoint
+    {
+        const BatchItem* batchItem;
+        int item;
+        int point;
+        CaPsoSettings settings;
+        SeasonAggregator* aggregator;
+        ConvergenceTarget target;
+        int firstWave;
+        int launched;
+    };
+
+    // A simulation that stopped before its last season
+    struct Termination
+    {
+        const BatchItem* batchItem;
+        int point;
+        int replicate;
+        int season;
+        StopRule::Reason reason;
+    };
+
     void processItem(BatchItem& batchItem);
+    void processPoint(const BatchItem& batchItem, const Task& task);
+    bool writePoints(const BatchItem& batchItem, const Sweep& sweep);
+    bool writeConvergence(const BatchItem& batchItem,
+                          const std::deque<SequentialPoint>& points);
+
+    // Runs the tasks over all the cores, returns false if canceled
+    bool runTasks(QList<Task>& tasks, int wave);
+
+    // Safe to call from the simulation threads
+    void addTermination(const BatchItem& batchItem, int point, int replicate,
+                        const StopRule& stopRule);
+    bool writeTerminations();
 
 private:
     CaType mType;
     QList<BatchItem> batchItems;
+
+    QMutex mTerminationsMutex;
+    QList<Termination> mTerminations;
+
+    QMutex mTargetsMutex;
 };
@@ -2,14 +2,24 @@
 
 BatchItem::BatchItem(QString settingsFile, int width, int height,
                      int numberOfSimulations, int numberOfSeasons,
-                     QString filenamePrefix, QString resultsPath) :
+                     int numberOfBurnInSeasons,
+                     QString filenamePrefix, QString resultsPath,
+                     bool appendProfiling, bool summaryOnly,
+                     const StopRule& stopRule, bool fillStoppedSeasons,
+                     const ConvergenceTarget& convergenceTarget) :
     mSettingsFile(settingsFile),
     mWidth(width),
     mHeight(height),
     mNumberOfSimulations(numberOfSimulations),
     mNumberOfSeasons(numberOfSeasons),
+    mNumberOfBurnInSeasons(numberOfBurnInSeasons),
     mFilenamePrefix(filenamePrefix),
-    mResultsPath(resultsPath)
+    mResultsPath(resultsPath),
+    mAppendProfiling(appendProfiling),
+    mSummaryOnly(summaryOnly),
+    mStopRule(stopRule),
+    mFillStoppedSeasons(fillStoppedSeasons),
+    mConvergenceTarget(convergenceTarget)
 {
 }
 
@@ -58,6 +68,16 @@ int BatchItem::numberOfSeasons() const
     return mNumberOfSeasons;
 }
 
+int BatchItem::numberOfBurnInSeasons() const
+{
+    return mNumberOfBurnInSeasons;
+}
+
+void BatchItem::setNumberOfBurnInSeasons(int value)
+{
+    mNumberOfBurnInSeasons = value;
+}
+
 const QString& BatchItem::filenamePrefix() const
 {
     return mFilenamePrefix;
@@ -77,3 +97,53 @@ void BatchItem::setResultsPath(QString path)
 {
     mResultsPath = path;
 }
+
+bool BatchItem::appendProfiling() const
+{
+    return mAppendProfiling;
+}
+
+void BatchItem::setAppendProfiling(bool value)
+{
+    mAppendProfiling = value;
+}
+
+bool BatchItem::summaryOnly() const
+{
+    return mSummaryOnly;
+}
+
+void BatchItem::setSummaryOnly(bool value)
+{
+    mSummaryOnly = value;
+}
+
+const StopRule& BatchItem::stopRule() const
+{
+    return mStopRule;
+}
+
+void BatchItem::setStopRule(const StopRule& rule)
+{
+    mStopRule = rule;
+}
+
+bool BatchItem::fillStoppedSeasons() const
+{
+    return mFillStoppedSeasons;
+}
+
+void BatchItem::setFillStoppedSeasons(bool value)
+{
+    mFillStoppedSeasons = value;
+}
+
+const ConvergenceTarget& BatchItem::convergenceTarget() const
+{
+    return mConvergenceTarget;
+}
+
+void BatchItem::setConvergenceTarget(const ConvergenceTarget& target)
+{
+    mConvergenceTarget = target;
+}
@@ -2,13 +2,19 @@
 #define BATCHITEM_H
 
 #include <QString>
+#include "convergencetarget.h"
+#include "stoprule.h"
 
 class BatchItem
 {
 public:
     BatchItem(QString settingsFile, int width, int height,
               int numberOfSimulations, int numberOfSeasons,
-              QString filenamePrefix, QString resultsPath);
+              int numberOfBurnInSeasons,
+              QString filenamePrefix, QString resultsPath,
+              bool appendProfiling = false, bool summaryOnly = false,
+              const StopRule& stopRule = StopRule(), bool fillStoppedSeasons = false,
+              const ConvergenceTarget& convergenceTarget = ConvergenceTarget());
 
     const QString& settingsFile() const;
     void setSettingsFile(QString file);
@@ -25,20 +31,50 @@ public:
     int numberOfSeasons() const;
     void setNumberOfSeasons(int value);
 
+    int numberOfBurnInSeasons() const;
+    void setNumberOfBurnInSeasons(int value);
+
     const QString& filenamePrefix() const;
     void setFilenamePrefix(QString prefix);
 
     const QString& resultsPath() const;
     void setResultsPath(QString path);
 
+    bool appendProfiling() const;
+    void setAppendProfiling(bool value);
+
+    // Aggregate the replicates into a single summary file instead of
+    // writing a results file per replicate
+    bool summaryOnly() const;
+    void setSummaryOnly(bool value);
+
+    const StopRule& stopRule() const;
+    void setStopRule(const StopRule& rule);
+
+    // Repeat the season a simulation stopped at until the last season
+    // instead of leaving the remaining seasons out
+    bool fillStoppedSeasons() const;
+    void setFillStoppedSeasons(bool value);
+
+    // When enabled the number of simulations is the first wave of
+    // replicates of every point, more are added until the target converges
+    const ConvergenceTarget& convergenceTarget() const;
+    void setConvergenceTarget(const ConvergenceTarget& target);
+
 private:
     QString mSettingsFile;
     int mWidth;
     int mHeight;
     int mNumberOfSimulations;
     int mNumberOfSeasons;
+    int mNumberOfBurnInSeasons;
     QString mFilenamePrefix;
     QString mResultsPath;
+    bool mAppendProfiling;
+    bool mSummaryOnly;
+    StopRule mStopRule;
+    bool mFillStoppedSeasons;
+    ConvergenceTarget mConvergenceTarget;
 };
 
 #endif // BATCHITEM_H
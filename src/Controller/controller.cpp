@@ -2,11 +2,14 @@
 #include <QCloseEvent>
 #include <QFileDialog>
 #include <QMessageBox>
+#include <QProgressDialog>
 #include "controller.h"
 #include "localcapso.h"
 #include "localsettingsdialog.h"
 #include "globalsettingsdialog.h"
 #include "batchdialog.h"
+#include "replaydialog.h"
+#include "frameexporter.h"
 #include "globalcapso.h"
 #include "util.h"
 
@@ -18,11 +21,7 @@ Controller::Controller(QWidget *parent)
     mResultsStream(&mResultsFile),
     mTimerId(-1),
     mTimerCount(0),
-    mSeasonLength(10),
-    mPreyCountBeforeReproduction(0),
-    mPredatorCountBeforeReproduction(0),
-    mPredatorCountBeforePreyDeath(0),
-    mPreyCountBeforePredatorDeath(0)
+    mSeasonLength(10)
 {
     this->setupUi(this);
 
@@ -40,46 +39,30 @@ Controller::~Controller()
 {
     mResultsFile.close();
 
+    stopRecording();
+
     delete mCellularAutomaton;
     delete mView;
 }
 
 void Controller::timerEvent(QTimerEvent*)
 {
-    if(mCurrentType == LOCAL)
-    {
-        auto local = dynamic_cast<LocalCaPso*>(mCellularAutomaton);
-
-        switch(local->currentStage())
-        {
-        case 2:
-            mPredatorCountBeforeReproduction = local->numberOfPredators();
-            break;
-        case 3:
-            mPreyCountBeforePredatorDeath = local->numberOfPreys();
-            break;
-        case 4:
-            mPredatorCountBeforePreyDeath = local->numberOfPredators();
-            break;
-        case 5:
-            mPreyCountBeforeReproduction = local->numberOfPreys();
-            break;
-        }
-    }
-
-    mCellularAutomaton->nextGen();
+    nextGen();
 
     mTimerCount++;
 
     if(!(mTimerCount % mSeasonLength))
     {
         writeResults();
+        updateProfiling();
         mResultsSaved = false;
     }
 
+    recordFrame();
+
     statusBarGeneration->showMessage(QString::number(mTimerCount));
 
-    mView->update();
+    updateView();
 }
 
 void Controller::closeEvent(QCloseEvent* event)
@@ -175,40 +158,22 @@ void Controller::step()
         mTimerId = -1;
     }
 
-    if(mCurrentType == LOCAL)
-    {
-        auto local = dynamic_cast<LocalCaPso*>(mCellularAutomaton);
-
-        switch(local->currentStage())
-        {
-        case 2:
-            mPredatorCountBeforeReproduction = local->numberOfPredators();
-            break;
-        case 3:
-            mPreyCountBeforePredatorDeath = local->numberOfPreys();
-            break;
-        case 4:
-            mPredatorCountBeforePreyDeath = local->numberOfPredators();
-            break;
-        case 5:
-            mPreyCountBeforeReproduction = local->numberOfPreys();
-            break;
-        }
-    }
-
-    mCellularAutomaton->nextGen();
+    nextGen();
 
     mTimerCount++;
 
     if(!(mTimerCount % mSeasonLength))
     {
         writeResults();
+        updateProfiling();
         mResultsSaved = false;
     }
 
+    recordFrame();
+
     statusBarGeneration->showMessage(QString::number(mTimerCount));
 
-    mView->update();
+    updateView();
 }
 
 void Controller::clear()
@@ -222,7 +187,7 @@ void Controller::clear()
 
     mCellularAutomaton->clear();
 
-    mView->update();
+    updateView();
 }
 
 void Controller::initialize()
@@ -234,12 +199,14 @@ void Controller::initialize()
         mTimerId = -1;
     }
 
+    // A trajectory cannot span two different runs
+    stopRecording();
+
     mCellularAutomaton->initialize();
 
-    mPreyCountBeforeReproduction = 0;
-    mPredatorCountBeforeReproduction = 0;
-    mPreyCountBeforePredatorDeath = 0;
-    mPredatorCountBeforePreyDeath = 0;
+    resetProfile();
+
+    mSeasonCounter = SeasonCounter();
 
     mTimerCount = 0;
 
@@ -247,7 +214,7 @@ void Controller::initialize()
 
     writeResults();
 
-    mView->update();
+    updateView();
 }
 
 void Controller::showSettings()
@@ -261,6 +228,31 @@ void Controller::showBatchDialog()
     batchDialog->exec();
 }
 
+void Controller::showProfiling()
+{
+    if(!mProfilingDialog)
+    {
+        mProfilingDialog = new ProfilingDialog(this);
+        connect(mProfilingDialog, SIGNAL(resetRequested()),
+                this, SLOT(resetProfile()));
+    }
+
+    updateProfiling();
+
+    mProfilingDialog->show();
+    mProfilingDialog->raise();
+}
+
+void Controller::resetProfile()
+{
+    if(mCurrentType == LOCAL)
+    {
+        dynamic_cast<LocalCaPso*>(mCellularAutomaton)->resetProfile();
+    }
+
+    updateProfiling();
+}
+
 void Controller::exportBitmap()
 {
     QString fileName = QFileDialog::getSaveFileName(this, "Export Bitmap",
@@ -273,6 +265,132 @@ void Controller::exportBitmap()
     }
 }
 
+void Controller::recordTrajectory(bool checked)
+{
+    if(!checked)
+    {
+        stopRecording();
+        return;
+    }
+
+    QString filename = QFileDialog::getSaveFileName(this, "Record Trajectory",
+        QCoreApplication::applicationDirPath() + "/" +
+        "capso.traj", tr("Trajectory (*.traj)"));
+
+    if(filename.isEmpty())
+    {
+        actionRecordTrajectory->setChecked(false);
+        return;
+    }
+
+    // Either every stage or only the end of every season is recorded, the
+    // first frame is the next generation that satisfies this.
+    mRecordStep = actionRecordStages->isChecked() ? 1 : mSeasonLength;
+    int firstGeneration = (mTimerCount + mRecordStep - 1) / mRecordStep * mRecordStep;
+
+    mTrajectoryWriter = new TrajectoryWriter(mCellularAutomaton->width(),
+                                             mCellularAutomaton->height());
+
+    if(!mTrajectoryWriter->open(QFile::encodeName(filename).toStdString(),
+                                firstGeneration, mRecordStep))
+    {
+        QMessageBox::critical(this, "Error!", "Cannot create file: " + filename);
+
+        stopRecording();
+        return;
+    }
+
+    actionRecordStages->setEnabled(false);
+
+    recordFrame();
+}
+
+void Controller::replayTrajectory()
+{
+    pause();
+
+    QString filename = QFileDialog::getOpenFileName(this, "Replay Trajectory", "",
+                                                    tr("Trajectory (*.traj)"));
+
+    if(filename.isEmpty())
+    {
+        return;
+    }
+
+    ReplayDialog replayDialog(this);
+    connect(&replayDialog, SIGNAL(frameChanged(int)),
+            this, SLOT(showReplayGeneration(int)));
+
+    if(!replayDialog.openTrajectory(filename))
+    {
+        QMessageBox::critical(this, "Error!", "Cannot read file: " + filename);
+        return;
+    }
+
+    // Show the recorded frames until the dialog is closed, the dialog is
+    // modal so the simulation cannot be resumed meanwhile
+    mView->setLatticeData(replayDialog.latticeData(),
+                          replayDialog.latticeWidth(),
+                          replayDialog.latticeHeight());
+
+    replayDialog.exec();
+
+    mView->setLatticeData(mCellularAutomaton->linearLattice(),
+                          mCellularAutomaton->width(),
+                          mCellularAutomaton->height());
+
+    statusBarGeneration->showMessage(QString::number(mTimerCount));
+}
+
+void Controller::showReplayGeneration(int generation)
+{
+    statusBarGeneration->showMessage(tr("Replay: %1").arg(generation));
+
+    mView->update();
+}
+
+void Controller::exportAnimation()
+{
+    pause();
+
+    QString trajectory = QFileDialog::getOpenFileName(this, "Export Animation", "",
+                                                      tr("Trajectory (*.traj)"));
+
+    if(trajectory.isEmpty())
+    {
+        return;
+    }
+
+    QString output = QFileDialog::getSaveFileName(this, "Export Animation",
+        QCoreApplication::applicationDirPath() + "/" +
+        "lattice.y4m", tr("Y4M video (*.y4m);;PNG sequence (*.png)"));
+
+    if(output.isEmpty())
+    {
+        return;
+    }
+
+    QProgressDialog progressDialog("Exporting frames. Please wait.", "Cancel",
+                                   0, 0, this);
+    progressDialog.setWindowModality(Qt::WindowModal);
+
+    // Frames are encoded on a thread pool, the progress dialog only keeps
+    // the interface responsive while they are submitted
+    bool exported = FrameExporter::exportTrajectory(trajectory, output, 30,
+                                                    [&progressDialog](int frame, int total)
+    {
+        progressDialog.setMaximum(total);
+        progressDialog.setValue(frame);
+
+        return !progressDialog.wasCanceled();
+    });
+
+    if(!exported && !progressDialog.wasCanceled())
+    {
+        QMessageBox::critical(this, "Error!", "Cannot export file: " + output);
+    }
+}
+
 void Controller::updateSettings()
 {
     if(!util::writeSettings(mSettings))
@@ -363,6 +481,58 @@ void Controller::initializeSettings()
     mCellularAutomaton->initialize();
 }
 
+void Controller::recordFrame()
+{
+    if(mTrajectoryWriter && !(mTimerCount % mRecordStep))
+    {
+        mTrajectoryWriter->write(mCellularAutomaton->linearLattice());
+    }
+}
+
+void Controller::updateView()
+{
+    // Tiled lattices are shown through their row major copy
+    mCellularAutomaton->linearLattice();
+
+    mView->update();
+}
+
+void Controller::stopRecording()
+{
+    if(mTrajectoryWriter)
+    {
+        // Closing waits for the pending frames to be written
+        delete mTrajectoryWriter;
+        mTrajectoryWriter = nullptr;
+    }
+
+    actionRecordTrajectory->setChecked(false);
+    actionRecordStages->setEnabled(true);
+}
+
+void Controller::updateProfiling()
+{
+    // Refreshed once per season, the table is too slow to follow every stage
+    if(mProfilingDialog && mProfilingDialog->isVisible() && mCurrentType == LOCAL)
+    {
+        mProfilingDialog->updateProfile(*dynamic_cast<LocalCaPso*>(mCellularAutomaton));
+    }
+}
+
+void Controller::nextGen()
+{
+    // Only the local model writes results, it reports the populations
+    // before its stages as it runs them
+    if(mCurrentType == LOCAL)
+    {
+        dynamic_cast<LocalCaPso*>(mCellularAutomaton)->nextGen(mSeasonCounter);
+    }
+    else
+    {
+        mCellularAutomaton->nextGen();
+    }
+}
+
 void Controller::makeConnections()
 {
     connect(actionSave, SIGNAL(triggered()), this, SLOT(save()));
@@ -373,7 +543,11 @@ void Controller::makeConnections()
     connect(actionInitialize, SIGNAL(triggered()), this, SLOT(initialize()));
     connect(actionSettings, SIGNAL(triggered()), this, SLOT(showSettings()));
     connect(actionBatch, SIGNAL(triggered()), this, SLOT(showBatchDialog()));
+    connect(actionProfiling, SIGNAL(triggered()), this, SLOT(showProfiling()));
     connect(actionExportBitmap, SIGNAL(triggered()), this, SLOT(exportBitmap()));
+    connect(actionRecordTrajectory, SIGNAL(triggered(bool)), this, SLOT(recordTrajectory(bool)));
+    connect(actionReplayTrajectory, SIGNAL(triggered()), this, SLOT(replayTrajectory()));
+    connect(actionExportAnimation, SIGNAL(triggered()), this, SLOT(exportAnimation()));
     connect(actionImportSettings, SIGNAL(triggered()), this, SLOT(importSettings()));
     connect(actionExportSettings, SIGNAL(triggered()), this, SLOT(exportSettings()));
     connect(actionExit, SIGNAL(triggered()), this, SLOT(close()));
@@ -400,7 +574,7 @@ void Controller::createCa()
 
 void Controller::createView()
 {
-    mView = new CaView(mCellularAutomaton->latticeData(),
+    mView = new CaView(mCellularAutomaton->linearLattice(),
                        mCellularAutomaton->width(),
                        mCellularAutomaton->height(),
                        this);
@@ -466,13 +640,13 @@ void Controller::writeResults()
             mResultsStream << mTimerCount / mSeasonLength << "," <<
                               local->numberOfPreys() << "," <<
                               local->numberOfPredators() << "," <<
-                              mPreyCountBeforeReproduction << "," <<
+                              mSeasonCounter.preyCountBeforeReproduction() << "," <<
                               local->preyBirthRate() << "," <<
-                              mPredatorCountBeforeReproduction << "," <<
+                              mSeasonCounter.predatorCountBeforeReproduction() << "," <<
                               local->predatorBirthRate() << "," <<
-                              mPreyCountBeforePredatorDeath << "," <<
+                              mSeasonCounter.preyCountBeforePredatorDeath() << "," <<
                               local->predatorDeathProbability() << "," <<
-                              mPredatorCountBeforePreyDeath << "," <<
+                              mSeasonCounter.predatorCountBeforePreyDeath() << "," <<
                               local->preyDeathProbability() << "\n";
         }
         break;
@@ -8,6 +8,9 @@
 #include "capsosettings.h"
 #include "cellularautomaton.h"
 #include "caview.h"
+#include "trajectorywriter.h"
+#include "profilingdialog.h"
+#include "stageobserver.h"
 
 class Controller : public QMainWindow, private Ui::ControllerClass
 {
@@ -31,7 +34,13 @@ private slots:
     void initialize();
     void showSettings();
     void showBatchDialog();
+    void showProfiling();
+    void resetProfile();
     void exportBitmap();
+    void recordTrajectory(bool checked);
+    void replayTrajectory();
+    void showReplayGeneration(int generation);
+    void exportAnimation();
     void updateSettings();
     void importSettings();
     void exportSettings();
@@ -44,6 +53,11 @@ private:
     void createSettingsDialog();
     void initializeResultsFile();
     void writeResults();
+    void recordFrame();
+    void updateView();
+    void stopRecording();
+    void updateProfiling();
+    void nextGen();
 
     CaType mCurrentType;
     CellularAutomaton* mCellularAutomaton;
@@ -57,11 +71,17 @@ private:
     QTextStream mResultsStream;
     bool        mResultsSaved = { false };
 
+    // Support for recording trajectories
+    TrajectoryWriter* mTrajectoryWriter = { nullptr };
+    int               mRecordStep       = { 1 };
+
+    // Non modal panel with the per stage profile of the model
+    ProfilingDialog* mProfilingDialog = { nullptr };
+
     int mTimerId;
     int mTimerCount;
     int mSeasonLength;
-    int mPreyCountBeforeReproduction;
-    int mPredatorCountBeforeReproduction;
-    int mPredatorCountBeforePreyDeath;
-    int mPreyCountBeforePredatorDeath;
+
+    // Populations before the stages of the current season
+    SeasonCounter mSeasonCounter;
 };
@@ -0,0 +1,61 @@
+#include "profilingdialog.h"
+
+ProfilingDialog::ProfilingDialog(QWidget* parent) :
+    QDialog(parent)
+{
+    this->setupUi(this);
+
+    tableProfile->setRowCount(6);
+
+    for(int stage = 0; stage < 6; stage++)
+    {
+        tableProfile->setVerticalHeaderItem(stage,
+            new QTableWidgetItem(LocalCaPso::stageName(stage)));
+
+        for(int column = 0; column < tableProfile->columnCount(); column++)
+        {
+            auto item = new QTableWidgetItem();
+            item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+            tableProfile->setItem(stage, column, item);
+        }
+    }
+
+    if(!profilingEnabled())
+    {
+        labelStatus->setText(tr("Profiling is disabled, rebuild with "
+                                "-DENABLE_PROFILING=ON to collect it."));
+        buttonReset->setEnabled(false);
+    }
+}
+
+void ProfilingDialog::updateProfile(const LocalCaPso& ca)
+{
+    double totalSeconds = 0.0;
+
+    for(int stage = 0; stage < 6; stage++)
+    {
+        totalSeconds += ca.stageProfile(stage).seconds;
+    }
+
+    for(int stage = 0; stage < 6; stage++)
+    {
+        const StageProfile& profile = ca.stageProfile(stage);
+
+        double share = totalSeconds > 0.0 ? 100.0 * profile.seconds / totalSeconds : 0.0;
+
+        tableProfile->item(stage, 0)->setText(QString::number(profile.calls));
+        tableProfile->item(stage, 1)->setText(QString::number(profile.seconds, 'f', 3));
+        tableProfile->item(stage, 2)->setText(QString::number(share, 'f', 1));
+        tableProfile->item(stage, 3)->setText(QString::number(profile.cellsVisited));
+        tableProfile->item(stage, 4)->setText(QString::number(profile.randomDraws));
+        tableProfile->item(stage, 5)->setText(QString::number(profile.notifyCalls));
+        tableProfile->item(stage, 6)->setText(QString::number(profile.births));
+        tableProfile->item(stage, 7)->setText(QString::number(profile.deaths));
+        tableProfile->item(stage, 8)->setText(QString::number(profile.particleMoves));
+    }
+}
+
+void ProfilingDialog::on_buttonReset_clicked()
+{
+    emit resetRequested();
+}
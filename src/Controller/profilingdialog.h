@@ -0,0 +1,22 @@
+#pragma once
+
+#include <QDialog>
+#include "ui_profilingdialog.h"
+#include "localcapso.h"
+
+// Shows the per stage instrumentation collected by LocalCaPso
+class ProfilingDialog : public QDialog, private Ui::ProfilingDialog
+{
+    Q_OBJECT
+
+public:
+    explicit ProfilingDialog(QWidget* parent = 0);
+
+    void updateProfile(const LocalCaPso& ca);
+
+signals:
+    void resetRequested();
+
+private slots:
+    void on_buttonReset_clicked();
+};
@@ -0,0 +1,133 @@
+#include <algorithm>
+#include <QFile>
+#include <QSignalBlocker>
+#include "replaydialog.h"
+
+ReplayDialog::ReplayDialog(QWidget* parent) :
+    QDialog(parent)
+{
+    this->setupUi(this);
+}
+
+bool ReplayDialog::openTrajectory(const QString& filename)
+{
+    if(!mPlayer.open(QFile::encodeName(filename).toStdString()) ||
+        mPlayer.frameCount() == 0)
+    {
+        return false;
+    }
+
+    mLattice.assign(mPlayer.width() * mPlayer.height(), 0);
+
+    sliderFrame->setRange(0, mPlayer.frameCount() - 1);
+
+    showFrame(0);
+
+    return true;
+}
+
+unsigned char* ReplayDialog::latticeData()
+{
+    return mLattice.data();
+}
+
+int ReplayDialog::latticeWidth() const
+{
+    return mPlayer.width();
+}
+
+int ReplayDialog::latticeHeight() const
+{
+    return mPlayer.height();
+}
+
+void ReplayDialog::timerEvent(QTimerEvent*)
+{
+    qint64 elapsed = mClock.elapsed();
+    int frame = mPlaybackStartFrame +
+            static_cast<int>(elapsed * spinBoxSpeed->value() / 1000);
+
+    if(frame >= mPlayer.frameCount())
+    {
+        frame = mPlayer.frameCount() - 1;
+        on_buttonPause_clicked();
+    }
+
+    if(frame != mCurrentFrame)
+    {
+        showFrame(frame);
+    }
+}
+
+void ReplayDialog::on_buttonPlay_clicked()
+{
+    if(mTimerId != -1)
+    {
+        return;
+    }
+
+    // Start over if the end has been reached
+    if(mCurrentFrame == mPlayer.frameCount() - 1)
+    {
+        showFrame(0);
+    }
+
+    mPlaybackStartFrame = mCurrentFrame;
+    mClock.start();
+
+    mTimerId = startTimer(std::max(1, 1000 / spinBoxSpeed->value()),
+                          Qt::PreciseTimer);
+}
+
+void ReplayDialog::on_buttonPause_clicked()
+{
+    if(mTimerId != -1)
+    {
+        killTimer(mTimerId);
+        mTimerId = -1;
+    }
+}
+
+void ReplayDialog::on_sliderFrame_valueChanged(int frame)
+{
+    showFrame(frame);
+
+    // Keep playing from the new position
+    mPlaybackStartFrame = mCurrentFrame;
+    mClock.start();
+}
+
+void ReplayDialog::on_spinBoxSpeed_valueChanged(int)
+{
+    if(mTimerId != -1)
+    {
+        on_buttonPause_clicked();
+        on_buttonPlay_clicked();
+    }
+}
+
+void ReplayDialog::reject()
+{
+    on_buttonPause_clicked();
+
+    QDialog::reject();
+}
+
+void ReplayDialog::showFrame(int frame)
+{
+    if(!mPlayer.readFrame(frame, mLattice.data()))
+    {
+        return;
+    }
+
+    mCurrentFrame = frame;
+
+    {
+        const QSignalBlocker blocker(sliderFrame);
+        sliderFrame->setValue(frame);
+    }
+
+    labelGeneration->setText(tr("Generation: %1").arg(mPlayer.generation(frame)));
+
+    emit frameChanged(mPlayer.generation(frame));
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <vector>
+#include <QDialog>
+#include <QElapsedTimer>
+#include "ui_replaydialog.h"
+#include "trajectoryplayer.h"
+
+// Plays back a recorded trajectory. Frames are decoded into a buffer owned by
+// the dialog, which the view displays while the dialog is open; no model code
+// runs during playback.
+class ReplayDialog : public QDialog, private Ui::ReplayDialog
+{
+    Q_OBJECT
+
+public:
+    explicit ReplayDialog(QWidget* parent = 0);
+
+    bool openTrajectory(const QString& filename);
+
+    unsigned char* latticeData();
+    int latticeWidth() const;
+    int latticeHeight() const;
+
+signals:
+    void frameChanged(int generation);
+
+protected:
+    void timerEvent(QTimerEvent*);
+
+private slots:
+    void on_buttonPlay_clicked();
+    void on_buttonPause_clicked();
+    void on_sliderFrame_valueChanged(int frame);
+    void on_spinBoxSpeed_valueChanged(int);
+    virtual void reject();
+
+private:
+    void showFrame(int frame);
+
+    TrajectoryPlayer mPlayer;
+    std::vector<unsigned char> mLattice;
+
+    // Playback runs against a clock so that frames are skipped rather than
+    // slowing down when the requested speed exceeds the repaint rate.
+    QElapsedTimer mClock;
+    int mTimerId            { -1 };
+    int mCurrentFrame       { 0 };
+    int mPlaybackStartFrame { 0 };
+};
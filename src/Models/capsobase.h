@@ -0,0 +1,1127 @@
+#ifndef CAPSOBASE_H
+#define CAPSOBASE_H
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <list>
+#include <memory>
+#include "cellularautomaton.h"
+#include "kernels.h"
+#include "swarm.h"
+#include "neighborhood.h"
+#include "seasonrecord.h"
+#include "stageobserver.h"
+#include "stageprofile.h"
+
+// Stages shared by the local and the global CA-PSO models. The model is a
+// policy given as template parameter (CRTP), thus the stages are compiled
+// once per model and its hooks are resolved, and inlined, at compile time:
+//
+//   void moveParticles();                    One step of the swarm
+//   void particleAdded(Particle&);           After a predator is born
+//   void particleRemoved(const Particle&);   Before a predator dies
+//   void preysEaten();                       After the predators fed
+//   void wrapOffspring(int& row, int& col);  Wrap a cell around the torus
+//   static const int PREDATION_RADIUS;       Cells a predator feeds on
+//
+// Every hook but moveParticles() has a default below a model may hide.
+template<class Model>
+class CaPsoBase : public CellularAutomaton, public CaPsoStage
+{
+public:
+    enum State { EMPTY, PREY, PREDATOR, PREY_PREDATOR };
+
+    static const int PREDATION_RADIUS = 0;
+
+    void initialize() override;
+    virtual void clear() override;
+    void setLayout(int tileSize) override;
+    void setGenericWrap(bool generic) override;
+    void nextGen() override;
+
+    // Run the current stage and tell the observer its counts
+    template<class Observer>
+    void nextGen(Observer& observer);
+
+    // Simulate whole seasons in a single call, a season already started is
+    // finished first and not counted. The callback receives the record of
+    // every season before it is simulated, i.e., its populations and the
+    // counts and rates of the previous one, and stops the run by returning
+    // false. Returns the number of seasons simulated. Stages that run
+    // fused report their events when the fused pass ends.
+    template<class Callback, class Observer = NullObserver>
+    int advanceSeasons(int numberOfSeasons, Callback callback,
+                       Observer&& observer = Observer());
+    void advanceSeasons(int numberOfSeasons);
+
+    // Draw the random numbers of the following runs from a fixed seed, call
+    // initialize() afterwards to start a reproducible run
+    void seed(uint64_t seed);
+
+    // Reorder the predators by the Morton (Z-order) index of their positions
+    // at the start of every given number of seasons, 0 keeps the order of
+    // birth. Consecutive predators then touch nearby cells, but the random
+    // numbers are drawn in another order, thus runs are only statistically
+    // the same as without sorting.
+    void setParticleSortInterval(int seasons);
+    int particleSortInterval() const;
+
+    // Run the bulk loops of the stages with the given kernels instead of the
+    // fastest ones, the results stay the same
+    void setKernels(const Kernels& kernels);
+    const Kernels& kernels() const;
+
+    int   numberOfPreys() const;
+    int   numberOfPredators() const;
+    float preyBirthRate() const;
+    float predatorBirthRate() const;
+    float preyDeathProbability() const;
+    float predatorDeathProbability() const;
+    int   currentStage() const;
+
+    // Per stage instrumentation, empty unless built with CAPSO_PROFILING
+    const StageProfile& stageProfile(int stage) const;
+    void resetProfile();
+
+    static const char* stageName(int stage);
+
+protected:
+    CaPsoBase(int width, int height);
+
+    // Copy of another model drawing from a generator derived from its own
+    CaPsoBase(const CaPsoBase& other, uint64_t stream);
+
+    // Model stages
+    void competitionOfPreys();
+    void migration();
+    void reproductionOfPredators();
+    void predatorsDeath();
+    void predation();
+    void reproductionOfPreys();
+
+    // Death of predators and predation in a single pass over the swarm, only
+    // right after the reproduction of predators
+    template<class Observer>
+    void predatorsDeathAndPredation(Observer& observer);
+    void feed(const Particle& predator);
+
+    // Default hooks
+    void particleAdded(Particle&) {}
+    void particleRemoved(const Particle&) {}
+    void preysEaten() {}
+    void wrapOffspring(int& row, int& col);
+
+    // Misc methods
+    void notifyNeighbors(const int& row, const int& col,
+                         const bool& death_birth);
+    bool checkState(int address, unsigned char state);
+    void setState(int address, unsigned char state);
+    void clearState(int address, unsigned char state);
+
+    // Containers
+    std::vector<unsigned char> mPreyDensities;
+    std::vector<unsigned char> mTemp;
+
+    Swarm mPredatorSwarm;
+
+    // Metrics
+    int mNumberOfPreys              { 0 };
+    int mNumberOfPredators          { 0 };
+    float mPreyBirthRate            { 0.0f };
+    float mPredatorBirthRate        { 0.0f };
+    float mPreyDeathProbability     { 0.0f };
+    float mPredatorDeathProbability { 0.0f };
+    int mCurrentStage               { COMPETITION };
+
+    RandomNumber mRandom;
+
+    std::array<StageProfile, 6> mProfile;
+    uint64_t mNotifyCalls { 0 };
+
+    const Kernels* mKernels { &fastestKernels() };
+
+    // Model parameters
+    double mPreyInitialDensity        { 0.0 };
+    double mPreyCompetitionFactor     { 0.3 };
+    int mPreyReproductiveCapacity     { 10 };
+    int mPreyReproductionRadius       { 2 };
+    int mPredatorReproductiveCapacity { 10 };
+    int mPredatorReproductionRadius   { 2 };
+    int mFitnessRadius                { 3 };
+    int NEIGHBORHOOD_SIZE             { (2 * mFitnessRadius + 1) * (2 * mFitnessRadius + 1) - 1 };
+
+    // PSO parameters
+    int mPredatorInitialSwarmSize       { 3 };
+    int mPredatorMigrationTime          { 5 };
+    int mPredatorMigrationCount         { 0 };
+    int mParticleSortInterval           { 0 };
+    int mSeasonsSinceSort               { 0 };
+    float mPredatorInitialInertiaWeight { 0.9f };
+    float mPredatorFinalInertiaWeight   { 0.2f };
+    const float INERTIA_STEP            { (mPredatorInitialInertiaWeight - mPredatorFinalInertiaWeight) /
+                                            mPredatorMigrationTime };
+
+private:
+    Model& model() { return static_cast<Model&>(*this); }
+
+    // Call visit(col, address, length) for every run of cells of the row
+    // stored one after the other
+    template<class Visit>
+    void forEachRun(int row, Visit visit);
+
+    // Update the densities around the cells where preys were born or died,
+    // through their neighborhoods or, for many cells, all over again
+    void updateDensities(const std::vector<LatticePoint>& cells, bool death);
+    void rebuildDensities();
+
+    // Scratch of the bulk loops
+    std::vector<LatticePoint> mChangedCells;
+    std::vector<int> mIndices;
+    std::vector<int> mSelected;
+    std::vector<float> mDraws;
+    std::vector<float> mLimits;
+    std::vector<unsigned char> mBits;
+    std::vector<unsigned char> mPadded;
+    std::vector<unsigned char> mWindows;
+    std::vector<unsigned char> mSums;
+
+    StageCounts counts(int stage) const
+    {
+        return { stage, mNumberOfPreys, mNumberOfPredators };
+    }
+};
+
+template<class Model>
+CaPsoBase<Model>::CaPsoBase(int width, int height)
+    : CellularAutomaton(width, height),
+    mPreyDensities(mLayout.size()),
+    mTemp(mLayout.size()),
+    mPredatorSwarm(1.0f, 2.0f, 0.9f, 10, 3,
+                   mLattice, mPreyDensities, mTemp,
+                   mLayout, PREDATOR, mRandom)
+{
+}
+
+template<class Model>
+CaPsoBase<Model>::CaPsoBase(const CaPsoBase& other, uint64_t stream)
+    : CellularAutomaton(other),
+    mPreyDensities(other.mPreyDensities),
+    mTemp(other.mTemp),
+    mPredatorSwarm(other.mPredatorSwarm,
+                   mLattice, mPreyDensities, mTemp, mLayout, mRandom),
+    mNumberOfPreys(other.mNumberOfPreys),
+    mNumberOfPredators(other.mNumberOfPredators),
+    mPreyBirthRate(other.mPreyBirthRate),
+    mPredatorBirthRate(other.mPredatorBirthRate),
+    mPreyDeathProbability(other.mPreyDeathProbability),
+    mPredatorDeathProbability(other.mPredatorDeathProbability),
+    mCurrentStage(other.mCurrentStage),
+    mRandom(other.mRandom, stream),
+    mProfile(other.mProfile),
+    mKernels(other.mKernels),
+    mPreyInitialDensity(other.mPreyInitialDensity),
+    mPreyCompetitionFactor(other.mPreyCompetitionFactor),
+    mPreyReproductiveCapacity(other.mPreyReproductiveCapacity),
+    mPreyReproductionRadius(other.mPreyReproductionRadius),
+    mPredatorReproductiveCapacity(other.mPredatorReproductiveCapacity),
+    mPredatorReproductionRadius(other.mPredatorReproductionRadius),
+    mFitnessRadius(other.mFitnessRadius),
+    NEIGHBORHOOD_SIZE(other.NEIGHBORHOOD_SIZE),
+    mPredatorInitialSwarmSize(other.mPredatorInitialSwarmSize),
+    mPredatorMigrationTime(other.mPredatorMigrationTime),
+    mPredatorMigrationCount(other.mPredatorMigrationCount),
+    mParticleSortInterval(other.mParticleSortInterval),
+    mSeasonsSinceSort(other.mSeasonsSinceSort),
+    mPredatorInitialInertiaWeight(other.mPredatorInitialInertiaWeight),
+    mPredatorFinalInertiaWeight(other.mPredatorFinalInertiaWeight),
+    INERTIA_STEP(other.INERTIA_STEP)
+{
+}
+
+template<class Model>
+void CaPsoBase<Model>::initialize()
+{
+    clear();
+
+    // Create and render predators
+    mPredatorSwarm.initialize(mPredatorInitialSwarmSize);
+
+    for(auto& p : mPredatorSwarm)
+    {
+        setState(getAddress(p->position.row, p->position.col), PREDATOR);
+
+        model().particleAdded(*p);
+
+        mNumberOfPredators++;
+    }
+
+    // Randomly create preys, drawing a row at a time
+    float limit = floatBelow(mPreyInitialDensity);
+
+    mDraws.resize(mWidth);
+
+    for(int row = 0; row < mHeight; row++)
+    {
+        mRandom.fill(mDraws.data(), mWidth);
+
+        forEachRun(row, [&, this](int col, int address, int length)
+        {
+            mNumberOfPreys += mKernels->markBelow(&mDraws[col], length, limit,
+                                                  &mLattice[address], PREY);
+        });
+    }
+
+    rebuildDensities();
+
+    // Reset the migration counter
+    mPredatorMigrationCount = 0;
+    mSeasonsSinceSort = 0;
+
+    mCurrentStage = COMPETITION;
+}
+
+template<class Model>
+void CaPsoBase<Model>::clear()
+{
+    CellularAutomaton::clear();
+
+    // Reset the densities
+    std::fill(mPreyDensities.begin(), mPreyDensities.end(), 0);
+
+    mNumberOfPreys = 0;
+    mNumberOfPredators = 0;
+    mPreyBirthRate = 0;
+    mPredatorBirthRate = 0;
+    mPreyDeathProbability = 0;
+    mPredatorDeathProbability = 0;
+}
+
+template<class Model>
+void CaPsoBase<Model>::setLayout(int tileSize)
+{
+    CellularAutomaton::setLayout(tileSize);
+
+    mPreyDensities.assign(mLayout.size(), 0);
+    mTemp.assign(mLayout.size(), 0);
+
+    clear();
+}
+
+template<class Model>
+void CaPsoBase<Model>::setGenericWrap(bool generic)
+{
+    CellularAutomaton::setGenericWrap(generic);
+
+    mPredatorSwarm.setGenericWrap(generic);
+}
+
+template<class Model>
+void CaPsoBase<Model>::nextGen()
+{
+    NullObserver observer;
+
+    nextGen(observer);
+}
+
+template<class Model>
+template<class Observer>
+void CaPsoBase<Model>::nextGen(Observer& observer)
+{
+    int stage = mCurrentStage;
+
+    observer.stageBegin(counts(stage));
+
+#ifdef CAPSO_PROFILING
+    StageProfile& profile = mProfile[stage];
+
+    int preys = mNumberOfPreys;
+    int predators = mNumberOfPredators;
+    uint64_t draws = mRandom.draws();
+    uint64_t notifyCalls = mNotifyCalls;
+    uint64_t moves = mPredatorSwarm.moves();
+    uint64_t cells = mPredatorSwarm.cellsVisited();
+
+    auto start = std::chrono::steady_clock::now();
+#endif
+
+    // Every stage sets the one that follows it
+    switch(mCurrentStage)
+    {
+    case COMPETITION:
+        competitionOfPreys();
+        break;
+    case MIGRATION:
+        migration();
+        break;
+    case REPRODUCTION_OF_PREDATORS:
+        reproductionOfPredators();
+        break;
+    case DEATH_OF_PREDATORS:
+        predatorsDeath();
+        break;
+    case DEATH_OF_PREYS:
+        predation();
+        break;
+    case REPRODUCTION_OF_PREYS:
+        reproductionOfPreys();
+        break;
+    }
+
+#ifdef CAPSO_PROFILING
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    profile.calls++;
+    profile.seconds += elapsed.count();
+    profile.randomDraws += mRandom.draws() - draws;
+    profile.notifyCalls += mNotifyCalls - notifyCalls;
+    profile.particleMoves += mPredatorSwarm.moves() - moves;
+
+    // Every stage either creates or removes individuals
+    int change = (mNumberOfPreys - preys) + (mNumberOfPredators - predators);
+    (change > 0 ? profile.births : profile.deaths) += std::abs(change);
+
+    // Derive the cells visited from the size of the loops of each stage
+    // rather than counting them inside the loops, only the neighbor
+    // searches of the migration count their own
+    switch(stage)
+    {
+    case COMPETITION:
+    case REPRODUCTION_OF_PREYS:
+        profile.cellsVisited += mWidth * mHeight;
+        break;
+    case MIGRATION:
+        profile.cellsVisited += mPredatorSwarm.cellsVisited() - cells;
+        break;
+    default:
+        profile.cellsVisited += predators;
+        break;
+    }
+#endif
+
+    observer.stageEnd(counts(stage));
+}
+
+template<class Model>
+template<class Callback, class Observer>
+int CaPsoBase<Model>::advanceSeasons(int numberOfSeasons, Callback callback,
+                                     Observer&& observer)
+{
+    while(mCurrentStage != COMPETITION)
+    {
+        nextGen(observer);
+    }
+
+    SeasonRecord record = SeasonRecord();
+
+    int season = 0;
+
+    for(; season < numberOfSeasons; season++)
+    {
+        record.season = season;
+        record.preys = mNumberOfPreys;
+        record.predators = mNumberOfPredators;
+        record.preyBirthRate = mPreyBirthRate;
+        record.predatorBirthRate = mPredatorBirthRate;
+        record.predatorDeathProbability = mPredatorDeathProbability;
+        record.preyDeathProbability = mPreyDeathProbability;
+
+        if(!callback(static_cast<const SeasonRecord&>(record)))
+        {
+            break;
+        }
+
+#ifdef CAPSO_PROFILING
+        // Profiles are kept per stage, thus the stages are not fused
+        do
+        {
+            switch(mCurrentStage)
+            {
+            case REPRODUCTION_OF_PREDATORS:
+                record.predatorCountBeforeReproduction = mNumberOfPredators;
+                break;
+            case DEATH_OF_PREDATORS:
+                record.preyCountBeforePredatorDeath = mNumberOfPreys;
+                break;
+            case DEATH_OF_PREYS:
+                record.predatorCountBeforePreyDeath = mNumberOfPredators;
+                break;
+            case REPRODUCTION_OF_PREYS:
+                record.preyCountBeforeReproduction = mNumberOfPreys;
+                break;
+            }
+
+            nextGen(observer);
+        }
+        while(mCurrentStage != COMPETITION);
+#else
+        observer.stageBegin(counts(COMPETITION));
+        competitionOfPreys();
+        observer.stageEnd(counts(COMPETITION));
+
+        do
+        {
+            observer.stageBegin(counts(MIGRATION));
+            migration();
+            observer.stageEnd(counts(MIGRATION));
+        }
+        while(mCurrentStage == MIGRATION);
+
+        record.predatorCountBeforeReproduction = mNumberOfPredators;
+        observer.stageBegin(counts(REPRODUCTION_OF_PREDATORS));
+        reproductionOfPredators();
+        observer.stageEnd(counts(REPRODUCTION_OF_PREDATORS));
+
+        record.preyCountBeforePredatorDeath = mNumberOfPreys;
+        predatorsDeathAndPredation(observer);
+
+        // Predation leaves the predators as they were after their deaths
+        record.predatorCountBeforePreyDeath = mNumberOfPredators;
+        record.preyCountBeforeReproduction = mNumberOfPreys;
+        observer.stageBegin(counts(REPRODUCTION_OF_PREYS));
+        reproductionOfPreys();
+        observer.stageEnd(counts(REPRODUCTION_OF_PREYS));
+#endif
+    }
+
+    return season;
+}
+
+template<class Model>
+void CaPsoBase<Model>::advanceSeasons(int numberOfSeasons)
+{
+    advanceSeasons(numberOfSeasons, [](const SeasonRecord&)
+    {
+        return true;
+    });
+}
+
+template<class Model>
+void CaPsoBase<Model>::seed(uint64_t seed)
+{
+    mRandom.seed(seed);
+}
+
+template<class Model>
+void CaPsoBase<Model>::setParticleSortInterval(int seasons)
+{
+    mParticleSortInterval = seasons;
+}
+
+template<class Model>
+int CaPsoBase<Model>::particleSortInterval() const
+{
+    return mParticleSortInterval;
+}
+
+template<class Model>
+void CaPsoBase<Model>::setKernels(const Kernels& kernels)
+{
+    mKernels = &kernels;
+}
+
+template<class Model>
+const Kernels& CaPsoBase<Model>::kernels() const
+{
+    return *mKernels;
+}
+
+template<class Model>
+int CaPsoBase<Model>::numberOfPreys() const
+{
+    return mNumberOfPreys;
+}
+
+template<class Model>
+int CaPsoBase<Model>::numberOfPredators() const
+{
+    return mNumberOfPredators;
+}
+
+template<class Model>
+float CaPsoBase<Model>::preyBirthRate() const
+{
+    return mPreyBirthRate;
+}
+
+template<class Model>
+float CaPsoBase<Model>::predatorBirthRate() const
+{
+    return mPredatorBirthRate;
+}
+
+template<class Model>
+float CaPsoBase<Model>::preyDeathProbability() const
+{
+    return mPreyDeathProbability;
+}
+
+template<class Model>
+float CaPsoBase<Model>::predatorDeathProbability() const
+{
+    return mPredatorDeathProbability;
+}
+
+template<class Model>
+int CaPsoBase<Model>::currentStage() const
+{
+    return mCurrentStage;
+}
+
+template<class Model>
+const StageProfile& CaPsoBase<Model>::stageProfile(int stage) const
+{
+    return mProfile[stage];
+}
+
+template<class Model>
+void CaPsoBase<Model>::resetProfile()
+{
+    mProfile.fill(StageProfile());
+}
+
+template<class Model>
+const char* CaPsoBase<Model>::stageName(int stage)
+{
+    static const char* names[] = { "Competition", "Migration",
+                                   "ReproductionOfPredators", "DeathOfPredators",
+                                   "DeathOfPreys", "ReproductionOfPreys" };
+
+    return names[stage];
+}
+
+template<class Model>
+void CaPsoBase<Model>::competitionOfPreys()
+{
+    // Seasons start here, and the competition of preys ignores the order of
+    // the predators
+    if(mParticleSortInterval > 0 && ++mSeasonsSinceSort >= mParticleSortInterval)
+    {
+        mPredatorSwarm.sortByPosition();
+        mSeasonsSinceSort = 0;
+    }
+
+    std::copy(mPreyDensities.begin(), mPreyDensities.end(), mTemp.begin());
+
+    // The death probability of a prey only depends on its density
+    float deathLimits[256];
+
+    for(int density = 0; density < 256; density++)
+    {
+        deathLimits[density] = floatAtMost(density * mPreyCompetitionFactor / NEIGHBORHOOD_SIZE);
+    }
+
+    mIndices.resize(mWidth);
+    mSelected.resize(mWidth);
+    mDraws.resize(mWidth);
+    mLimits.resize(mWidth);
+    mChangedCells.clear();
+
+    for(int row = 0; row < mHeight; row++)
+    {
+        forEachRun(row, [&, this](int col, int address, int length)
+        {
+            // Every prey draws a number, in the order of the cells
+            size_t preys = mKernels->findState(&mLattice[address], length, PREY, mIndices.data());
+
+            mRandom.fill(mDraws.data(), preys);
+
+            for(size_t i = 0; i < preys; i++)
+            {
+                mLimits[i] = deathLimits[mTemp[address + mIndices[i]]];
+            }
+
+            size_t deaths = mKernels->selectBelow(mDraws.data(), mLimits.data(), mIndices.data(),
+                                                  preys, mSelected.data());
+
+            // Only kill the preys
+            for(size_t i = 0; i < deaths; i++)
+            {
+                clearState(address + mSelected[i], PREY);
+
+                mChangedCells.push_back({ row, col + mSelected[i] });
+            }
+
+            mNumberOfPreys -= static_cast<int>(deaths);
+        });
+    }
+
+    updateDensities(mChangedCells, true);
+
+    mCurrentStage = MIGRATION;
+}
+
+template<class Model>
+void CaPsoBase<Model>::migration()
+{
+    // Update the positions of all predators
+    model().moveParticles();
+
+    // Decrease the inertia weight and increase the migration counter
+    float weight = mPredatorSwarm.inertiaWeight() - INERTIA_STEP;
+    mPredatorSwarm.setInertiaWeight(weight);
+    mPredatorMigrationCount++;
+
+    // If migration has ended, point to the next stage and reset the inertia
+    // weight and migration count
+    if(mPredatorMigrationCount == mPredatorMigrationTime)
+    {
+        mCurrentStage = REPRODUCTION_OF_PREDATORS;
+        mPredatorMigrationCount = 0;
+        mPredatorSwarm.setInertiaWeight(mPredatorInitialInertiaWeight);
+    }
+}
+
+template<class Model>
+void CaPsoBase<Model>::reproductionOfPredators()
+{
+    std::copy(mLattice.begin(), mLattice.end(), mTemp.begin());
+
+    std::list<std::shared_ptr<Particle>> newParticles;
+
+    int initialNumberOfPredators = mNumberOfPredators;
+
+    for(auto& p : mPredatorSwarm)
+    {
+        int pRow = p->position.row;
+        int pCol = p->position.col;
+
+        int birthCount = 0;
+
+        while(birthCount < mPredatorReproductiveCapacity)
+        {
+            // Obtain an offset
+            int finalRow = mRandom.GetRandomInt(-mPredatorReproductionRadius, mPredatorReproductionRadius);
+            int finalCol = mRandom.GetRandomInt(-mPredatorReproductionRadius, mPredatorReproductionRadius);
+
+            if(finalRow == 0 && finalCol == 0)
+            {
+                continue;
+            }
+
+            // Get relative coordinates
+            finalRow += pRow;
+            finalCol += pCol;
+
+            // Get final coordinates
+            model().wrapOffspring(finalRow, finalCol);
+
+            if(!checkState(getAddress(finalRow, finalCol), PREDATOR))
+            {
+                // Create a new particle
+                auto particle = std::make_shared<Particle>();
+                particle->position.row = finalRow;
+                particle->position.col = finalCol;
+                particle->bestPosition.row = p->bestPosition.row;
+                particle->bestPosition.col = p->bestPosition.col;
+
+                setState(getAddress(finalRow, finalCol), PREDATOR);
+
+                newParticles.push_back(particle);
+                model().particleAdded(*particle);
+
+                mNumberOfPredators++;
+            }
+
+            birthCount++;
+        }
+    }
+
+    mPredatorSwarm.add(newParticles);
+
+    int numberOfBirths = mNumberOfPredators - initialNumberOfPredators;
+
+    mPredatorBirthRate = static_cast<float>(numberOfBirths) / (mWidth * mHeight);
+
+    mCurrentStage = DEATH_OF_PREDATORS;
+}
+
+template<class Model>
+void CaPsoBase<Model>::predatorsDeath()
+{
+    int currentAddress;
+
+    int initialNumberOfPredators = mNumberOfPredators;
+
+    for(auto it = mPredatorSwarm.begin(); it != mPredatorSwarm.end();)
+    {
+        currentAddress = getAddress((*it)->position.row, (*it)->position.col);
+
+        if(!checkState(currentAddress, PREY))
+        {
+            clearState(currentAddress, PREDATOR);
+            model().particleRemoved(**it);
+
+            // Since the iterator is invalidated when erase() is called, we must
+            // use its return value (an iterator pointing to the element following
+            // the element that has just been erased) to keep a valid iterator.
+            it = mPredatorSwarm.erase(it);
+            mNumberOfPredators--;
+        }
+        else
+        {
+            it++;
+        }
+    }
+
+    int numberOfDeaths = initialNumberOfPredators - mNumberOfPredators;
+
+    mPredatorDeathProbability = static_cast<float>(numberOfDeaths) /
+            initialNumberOfPredators;
+
+    mCurrentStage = DEATH_OF_PREYS;
+}
+
+template<class Model>
+void CaPsoBase<Model>::predation()
+{
+    int initialNumberOfPreys = mNumberOfPreys;
+
+    for(auto& p : mPredatorSwarm)
+    {
+        feed(*p);
+    }
+
+    int numberOfDeaths = initialNumberOfPreys - mNumberOfPreys;
+
+    mPreyDeathProbability = static_cast<float>(numberOfDeaths) /
+            initialNumberOfPreys;
+
+    model().preysEaten();
+
+    mCurrentStage = REPRODUCTION_OF_PREYS;
+}
+
+template<class Model>
+template<class Observer>
+void CaPsoBase<Model>::predatorsDeathAndPredation(Observer& observer)
+{
+    int currentAddress;
+
+    int initialNumberOfPredators = mNumberOfPredators;
+    int initialNumberOfPreys = mNumberOfPreys;
+
+    observer.stageBegin(counts(DEATH_OF_PREDATORS));
+
+    for(auto it = mPredatorSwarm.begin(); it != mPredatorSwarm.end();)
+    {
+        currentAddress = getAddress((*it)->position.row, (*it)->position.col);
+
+        // Deaths depend on the preys before anyone fed, which are still in
+        // the copy of the lattice made by the reproduction of predators, so
+        // a survivor may feed at once as it would in a later pass
+        if(!(mTemp[currentAddress] & PREY))
+        {
+            clearState(currentAddress, PREDATOR);
+            model().particleRemoved(**it);
+
+            it = mPredatorSwarm.erase(it);
+            mNumberOfPredators--;
+        }
+        else
+        {
+            feed(**it);
+
+            it++;
+        }
+    }
+
+    int numberOfDeaths = initialNumberOfPredators - mNumberOfPredators;
+
+    mPredatorDeathProbability = static_cast<float>(numberOfDeaths) /
+            initialNumberOfPredators;
+
+    // The deaths of predators left the preys untouched
+    StageCounts afterDeaths = { DEATH_OF_PREDATORS, initialNumberOfPreys, mNumberOfPredators };
+    observer.stageEnd(afterDeaths);
+
+    afterDeaths.stage = DEATH_OF_PREYS;
+    observer.stageBegin(afterDeaths);
+
+    numberOfDeaths = initialNumberOfPreys - mNumberOfPreys;
+
+    mPreyDeathProbability = static_cast<float>(numberOfDeaths) /
+            initialNumberOfPreys;
+
+    model().preysEaten();
+
+    mCurrentStage = REPRODUCTION_OF_PREYS;
+
+    observer.stageEnd(counts(DEATH_OF_PREYS));
+}
+
+template<class Model>
+void CaPsoBase<Model>::feed(const Particle& predator)
+{
+    const int RADIUS = Model::PREDATION_RADIUS;
+
+    int pRow = predator.position.row;
+    int pCol = predator.position.col;
+
+    // Kill the preys around the predator, with a radius of 0 only the one in
+    // its own cell
+    withWrap([&](const auto& wrap)
+    {
+        for(int nRow = pRow - RADIUS; nRow <= pRow + RADIUS; nRow++)
+        {
+            for(int nCol = pCol - RADIUS; nCol <= pCol + RADIUS; nCol++)
+            {
+                int finalRow = wrap.row(nRow);
+                int finalCol = wrap.col(nCol);
+
+                int currentAddress = getAddress(finalRow, finalCol);
+
+                if(checkState(currentAddress, PREY))
+                {
+                    clearState(currentAddress, PREY);
+
+                    notifyNeighbors(finalRow, finalCol, true);
+
+                    mNumberOfPreys--;
+                }
+            }
+        }
+    });
+}
+
+template<class Model>
+void CaPsoBase<Model>::reproductionOfPreys()
+{
+    std::copy(mLattice.begin(), mLattice.end(), mTemp.begin());
+
+    int finalRow, finalCol, neighbourAddress;
+    int birthCount, initialNumberOfPreys = mNumberOfPreys;
+
+    mIndices.resize(mWidth);
+    mChangedCells.clear();
+
+    for(int row = 0; row < mHeight; row++)
+    {
+        forEachRun(row, [&, this](int firstCol, int address, int length)
+        {
+            size_t preys = mKernels->findState(&mTemp[address], length, PREY, mIndices.data());
+
+            for(size_t i = 0; i < preys; i++)
+            {
+                int col = firstCol + mIndices[i];
+
+                birthCount = 0;
+
+                while(birthCount < mPreyReproductiveCapacity)
+                {
+                    // Obtain an offset
+                    finalRow = mRandom.GetRandomInt(-mPreyReproductionRadius, mPreyReproductionRadius);
+                    finalCol = mRandom.GetRandomInt(-mPreyReproductionRadius, mPreyReproductionRadius);
+
+                    if(finalRow == 0 && finalCol == 0)
+                    {
+                        continue;
+                    }
+
+                    // Get relative coordinates
+                    finalRow += row;
+                    finalCol += col;
+
+                    // Get final coordinates
+                    model().wrapOffspring(finalRow, finalCol);
+
+                    neighbourAddress = getAddress(finalRow, finalCol);
+
+                    if(!(mLattice[neighbourAddress] & PREY))
+                    {
+                        mLattice[neighbourAddress] |= PREY;
+
+                        mChangedCells.push_back({ finalRow, finalCol });
+
+                        mNumberOfPreys++;
+                    }
+
+                    birthCount++;
+                }
+            }
+        });
+    }
+
+    updateDensities(mChangedCells, false);
+
+    int numberOfBirths = mNumberOfPreys - initialNumberOfPreys;
+
+    mPreyBirthRate = static_cast<float>(numberOfBirths) / (mWidth * mHeight);
+
+    mCurrentStage = COMPETITION;
+}
+
+template<class Model>
+void CaPsoBase<Model>::wrapOffspring(int& row, int& col)
+{
+    if (row < 0 && col < 0)
+    {
+        row = mHeight + row % mHeight;
+        col = mWidth + col % mWidth;
+    }
+    else if (row < 0 && col >= 0)
+    {
+        row = mHeight + row % mHeight;
+        col = col % mWidth;
+    }
+    else if (row >= 0 && col < 0)
+    {
+        row = row % mHeight;
+        col = mWidth + col % mWidth;
+    }
+    else
+    {
+        row = row % mHeight;
+        col = col % mWidth;
+    }
+}
+
+template<class Model>
+template<class Visit>
+void CaPsoBase<Model>::forEachRun(int row, Visit visit)
+{
+    int run = mLayout.runLength();
+
+    for(int col = 0; col < mWidth; col += run)
+    {
+        visit(col, getAddress(row, col), std::min(run, mWidth - col));
+    }
+}
+
+template<class Model>
+void CaPsoBase<Model>::updateDensities(const std::vector<LatticePoint>& cells, bool death)
+{
+    // Each neighborhood costs its cells, scattered, while the whole lattice
+    // costs a few vector passes over every cell
+    int64_t side = 2 * mFitnessRadius + 1;
+    int64_t neighborhoods = static_cast<int64_t>(cells.size()) * side * side;
+
+    if(neighborhoods * 16 > static_cast<int64_t>(mWidth) * mHeight * (side + 4))
+    {
+        CAPSO_PROFILE(mNotifyCalls += cells.size());
+
+        rebuildDensities();
+
+        return;
+    }
+
+    for(const LatticePoint& cell : cells)
+    {
+        notifyNeighbors(cell.row, cell.col, death);
+    }
+}
+
+template<class Model>
+void CaPsoBase<Model>::rebuildDensities()
+{
+    // The density of a cell is the number of preys in the square of side
+    // 2r + 1 around it, but itself. Each row of squares is the sum of the
+    // windows of columns of 2r + 1 rows, which slide down one row at a
+    // time. The windows are kept in a ring of 2r + 2 rows.
+    const int radius = mFitnessRadius;
+    const int side = 2 * radius + 1;
+    const int slots = side + 1;
+
+    auto wrap = [](int value, int size)
+    {
+        return (value % size + size) % size;
+    };
+
+    mBits.resize(mWidth);
+    mPadded.resize(mWidth + 2 * radius);
+    mWindows.resize(static_cast<size_t>(slots) * mWidth);
+    mSums.resize(mWidth);
+
+    auto loadBits = [&, this](int row)
+    {
+        forEachRun(row, [&, this](int col, int address, int length)
+        {
+            mKernels->maskState(&mLattice[address], length, PREY, &mBits[col]);
+        });
+    };
+
+    // Windows of the row at the given offset from the first one, any
+    // offset from -r to height + r
+    auto window = [&, this](int offset)
+    {
+        return &mWindows[static_cast<size_t>(wrap(offset, slots)) * mWidth];
+    };
+
+    auto computeWindow = [&, this](int offset)
+    {
+        loadBits(wrap(offset, mHeight));
+
+        // The row with r cells of the other end at each side
+        std::copy(mBits.begin(), mBits.end(), mPadded.begin() + radius);
+
+        for(int i = 0; i < radius; i++)
+        {
+            mPadded[i] = mBits[wrap(i - radius, mWidth)];
+            mPadded[radius + mWidth + i] = mBits[wrap(i, mWidth)];
+        }
+
+        mKernels->windowSum(mPadded.data(), mWidth, side, window(offset));
+    };
+
+    std::fill(mSums.begin(), mSums.end(), 0);
+
+    for(int offset = -radius; offset <= radius; offset++)
+    {
+        computeWindow(offset);
+        mKernels->addRow(mSums.data(), window(offset), mWidth);
+    }
+
+    for(int row = 0; row < mHeight; row++)
+    {
+        // Leave the cell itself out
+        loadBits(row);
+        mKernels->subtractRow(mSums.data(), mBits.data(), mWidth);
+
+        forEachRun(row, [&, this](int col, int address, int length)
+        {
+            std::copy(&mSums[col], &mSums[col] + length, &mPreyDensities[address]);
+        });
+
+        mKernels->addRow(mSums.data(), mBits.data(), mWidth);
+
+        // Slide the square down
+        if(row + 1 < mHeight)
+        {
+            computeWindow(row + radius + 1);
+            mKernels->addRow(mSums.data(), window(row + radius + 1), mWidth);
+            mKernels->subtractRow(mSums.data(), window(row - radius), mWidth);
+        }
+    }
+}
+
+template<class Model>
+void CaPsoBase<Model>::notifyNeighbors(const int& row, const int& col, const bool& death)
+{
+    CAPSO_PROFILE(mNotifyCalls++);
+
+    withWrap([&](const auto& wrap)
+    {
+        notifyNeighborhood(mPreyDensities, mLayout, wrap, row, col, mFitnessRadius, death);
+    });
+}
+
+template<class Model>
+bool CaPsoBase<Model>::checkState(int address, unsigned char state)
+{
+    return mLattice[address] & state;
+}
+
+template<class Model>
+void CaPsoBase<Model>::setState(int address, unsigned char state)
+{
+    mLattice[address] |= state;
+}
+
+template<class Model>
+void CaPsoBase<Model>::clearState(int address, unsigned char state)
+{
+    mLattice[address] &= ~state;
+}
+
+#endif // CAPSOBASE_H
@@ -2,12 +2,14 @@
 #include "cellularautomaton.h"
 
 CellularAutomaton::CellularAutomaton(int width, int height)
-    : mLattice(width * height)
+    : mLayout(width, height),
+      mLattice(mLayout.size())
 {
-    // Set the lattice's width, height and stride
+    // Set the lattice's width and height
     mWidth = width;
     mHeight = height;
-    mStride = width;
+
+    mMaskWrap = isPowerOfTwo(width) && isPowerOfTwo(height);
 }
 
 unsigned char* CellularAutomaton::latticeData() const
@@ -15,6 +17,19 @@ unsigned char* CellularAutomaton::latticeData() const
     return const_cast<unsigned char*>(mLattice.data());
 }
 
+unsigned char* CellularAutomaton::linearLattice()
+{
+    if(mLayout.rowMajor())
+    {
+        return mLattice.data();
+    }
+
+    mLinearLattice.resize(mWidth * mHeight);
+    mLayout.toRowMajor(mLattice.data(), mLinearLattice.data());
+
+    return mLinearLattice.data();
+}
+
 int CellularAutomaton::width() const
 {
     return mWidth;
@@ -25,6 +40,30 @@ int CellularAutomaton::height() const
     return mHeight;
 }
 
+const LatticeLayout& CellularAutomaton::layout() const
+{
+    return mLayout;
+}
+
+void CellularAutomaton::setLayout(int tileSize)
+{
+    mLayout = LatticeLayout(mWidth, mHeight, tileSize);
+
+    mLattice.assign(mLayout.size(), 0);
+    mLinearLattice.clear();
+    mLinearLattice.shrink_to_fit();
+}
+
+void CellularAutomaton::setGenericWrap(bool generic)
+{
+    mMaskWrap = !generic && isPowerOfTwo(mWidth) && isPowerOfTwo(mHeight);
+}
+
+bool CellularAutomaton::maskWrap() const
+{
+    return mMaskWrap;
+}
+
 void CellularAutomaton::setCellState(int row, int col, unsigned char state)
 {
     mLattice[getAddress(row, col)] = state;
@@ -2,18 +2,37 @@
 #define CELLULARAUTOMATON_H
 
 #include <vector>
+#include "latticelayout.h"
+#include "torus.h"
 
 class CellularAutomaton
 {
 public:
     CellularAutomaton(int width, int height);
 
+    // The cells as stored, in the order of layout()
     unsigned char* latticeData() const;
 
+    // The cells row major, for views and recorders. With the row major
+    // layout this is the lattice itself, otherwise every call copies the
+    // lattice into a buffer whose address only changes with the layout.
+    unsigned char* linearLattice();
+
     int width() const;
 
     int height() const;
 
+    const LatticeLayout& layout() const;
+
+    // Store the cells in tiles of tileSize x tileSize cells, or row major
+    // for 0. Clears the lattice, call initialize() afterwards.
+    virtual void setLayout(int tileSize);
+
+    // Lattices whose sides are both powers of two wrap around the torus
+    // with bit masks, unless the generic modulo wrap is forced
+    virtual void setGenericWrap(bool generic);
+    bool maskWrap() const;
+
     void setCellState(int row, int col, unsigned char state);
 
     virtual void clear();
@@ -25,15 +44,38 @@ public:
     virtual ~CellularAutomaton() = 0;
 
 protected:
+    LatticeLayout mLayout;
     std::vector<unsigned char> mLattice;
-    int mWidth, mHeight, mStride;
+    int mWidth, mHeight;
+
+    bool mMaskWrap;
 
     int getAddress(int row, int col);
+
+    // Call kernel with the wrap of the lattice
+    template<class Kernel>
+    void withWrap(Kernel&& kernel) const;
+
+private:
+    std::vector<unsigned char> mLinearLattice;
 };
 
 inline int CellularAutomaton::getAddress(int row, int col)
 {
-    return mStride * row + col;
+    return mLayout.address(row, col);
+}
+
+template<class Kernel>
+void CellularAutomaton::withWrap(Kernel&& kernel) const
+{
+    if(mMaskWrap)
+    {
+        kernel(MaskWrap(mWidth, mHeight));
+    }
+    else
+    {
+        kernel(ModuloWrap(mWidth, mHeight));
+    }
 }
 
 #endif // CELLULARAUTOMATON_H
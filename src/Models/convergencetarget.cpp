@@ -0,0 +1,175 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "convergencetarget.h"
+
+namespace
+{
+    // Two sided 95% quantile of the normal distribution
+    const double Z = 1.959964;
+
+    // The same for Student's t with 1 to 30 degrees of freedom
+    const double T[] =
+    {
+        12.706205, 4.302653, 3.182446, 2.776445, 2.570582, 2.446912, 2.364624,
+        2.306004, 2.262157, 2.228139, 2.200985, 2.178813, 2.160369, 2.144787,
+        2.131450, 2.119905, 2.109816, 2.100922, 2.093024, 2.085963, 2.079614,
+        2.073873, 2.068658, 2.063899, 2.059539, 2.055529, 2.051831, 2.048407,
+        2.045230, 2.042272
+    };
+}
+
+ConvergenceTarget::ConvergenceTarget(Statistic statistic, double halfWidth,
+                                     int maximumReplicates)
+    : mStatistic(statistic),
+      mTargetHalfWidth(halfWidth),
+      mMaximumReplicates(maximumReplicates)
+{
+}
+
+bool ConvergenceTarget::enabled() const
+{
+    return mStatistic != NONE && mTargetHalfWidth > 0.0;
+}
+
+ConvergenceTarget::Statistic ConvergenceTarget::statistic() const
+{
+    return mStatistic;
+}
+
+int ConvergenceTarget::maximumReplicates() const
+{
+    return mMaximumReplicates;
+}
+
+double ConvergenceTarget::replicateValue(Statistic statistic,
+                                         const std::vector<SeasonRecord>& records,
+                                         int numberOfCells, int numberOfSeasons)
+{
+    if(records.empty())
+    {
+        return 0.0;
+    }
+
+    if(statistic == PREDATOR_EXTINCTION)
+    {
+        return records.back().predators == 0 ? 1.0 : 0.0;
+    }
+
+    double sum = 0.0;
+    double last = 0.0;
+
+    for(const SeasonRecord& record : records)
+    {
+        last = statistic == MEAN_PREY_DENSITY ? record.preys : record.predators;
+        sum += last;
+    }
+
+    // The seasons after a stop keep the last population
+    int seasons = std::max(numberOfSeasons, static_cast<int>(records.size()));
+    sum += last * (seasons - static_cast<int>(records.size()));
+
+    return sum / seasons / numberOfCells;
+}
+
+void ConvergenceTarget::add(double value)
+{
+    mStatistics.add(value);
+}
+
+int ConvergenceTarget::count() const
+{
+    return mStatistics.count();
+}
+
+double ConvergenceTarget::estimate() const
+{
+    return mStatistics.mean();
+}
+
+double ConvergenceTarget::halfWidth() const
+{
+    double n = mStatistics.count();
+
+    if(n < 2)
+    {
+        return std::numeric_limits<double>::infinity();
+    }
+
+    if(mStatistic == PREDATOR_EXTINCTION)
+    {
+        double p = mStatistics.mean();
+
+        return Z / (1.0 + Z * Z / n) * std::sqrt(p * (1.0 - p) / n + Z * Z / (4.0 * n * n));
+    }
+
+    return studentQuantile(count() - 1) * mStatistics.standardDeviation() / std::sqrt(n);
+}
+
+bool ConvergenceTarget::converged() const
+{
+    return count() >= MINIMUM_REPLICATES && halfWidth() <= mTargetHalfWidth;
+}
+
+int ConvergenceTarget::additionalReplicates(int launched) const
+{
+    if(converged() || launched >= mMaximumReplicates)
+    {
+        return 0;
+    }
+
+    // Replicates the current estimate of the spread needs to reach the
+    // target, proportions use the center of Wilson's interval so that no
+    // extinction so far does not mean no spread. Means use the quantile of
+    // the replicates so far, which overestimates the need a little
+    double spread = mStatistics.standardDeviation();
+    double quantile = count() > 1 ? studentQuantile(count() - 1) : Z;
+
+    if(mStatistic == PREDATOR_EXTINCTION)
+    {
+        double n = mStatistics.count();
+        double p = (n * estimate() + Z * Z / 2.0) / (n + Z * Z);
+
+        spread = std::sqrt(p * (1.0 - p));
+        quantile = Z;
+    }
+
+    double needed = std::ceil(std::pow(quantile * spread / mTargetHalfWidth, 2.0));
+
+    int more = static_cast<int>(std::min(needed - launched, static_cast<double>(launched)));
+
+    // A small first wave goes straight to the minimum
+    more = std::max(more, MINIMUM_REPLICATES - launched);
+
+    return std::min(std::max(more, 1), mMaximumReplicates - launched);
+}
+
+double ConvergenceTarget::studentQuantile(int degreesOfFreedom)
+{
+    if(degreesOfFreedom < 1)
+    {
+        return std::numeric_limits<double>::infinity();
+    }
+
+    if(degreesOfFreedom <= 30)
+    {
+        return T[degreesOfFreedom - 1];
+    }
+
+    // Cornish-Fisher expansion around the normal quantile, within 1e-5
+    // beyond 30 degrees of freedom
+    double n = degreesOfFreedom;
+    double z3 = Z * Z * Z;
+    double z5 = z3 * Z * Z;
+
+    return Z + (z3 + Z) / (4.0 * n) + (5.0 * z5 + 16.0 * z3 + 3.0 * Z) / (96.0 * n * n) +
+           (3.0 * z5 * Z * Z + 19.0 * z5 + 17.0 * z3 - 15.0 * Z) / (384.0 * n * n * n);
+}
+
+const char* ConvergenceTarget::statisticName(Statistic statistic)
+{
+    static const char* names[] = { "None", "MeanPreyDensity", "MeanPredatorDensity",
+                                   "PredatorExtinction" };
+
+    return names[statistic];
+}
@@ -0,0 +1,63 @@
+#ifndef CONVERGENCETARGET_H
+#define CONVERGENCETARGET_H
+
+#include <vector>
+#include "runningstatistics.h"
+#include "seasonaggregator.h"
+
+// Target width of the 95% confidence interval of a statistic of the
+// replicates of a batch point. Replicates are added in waves until the half
+// width of the interval is below the target or the maximum is reached.
+// Means use the Student t interval, the extinction probability the Wilson
+// score interval, which does not collapse when no replicate goes extinct.
+// No point converges with less than MINIMUM_REPLICATES replicates.
+class ConvergenceTarget
+{
+public:
+    static const int MINIMUM_REPLICATES = 10;
+
+    enum Statistic
+    {
+        NONE,
+        MEAN_PREY_DENSITY,
+        MEAN_PREDATOR_DENSITY,
+        PREDATOR_EXTINCTION
+    };
+
+    ConvergenceTarget(Statistic statistic = NONE, double halfWidth = 0.0,
+                      int maximumReplicates = 0);
+
+    bool enabled() const;
+    Statistic statistic() const;
+    int maximumReplicates() const;
+
+    // Value of the statistic in a single replicate of the given number of
+    // seasons, a replicate that stopped early keeps its last state
+    static double replicateValue(Statistic statistic, const std::vector<SeasonRecord>& records,
+                                 int numberOfCells, int numberOfSeasons);
+
+    void add(double value);
+
+    int count() const;
+    double estimate() const;
+    double halfWidth() const;
+    bool converged() const;
+
+    // Replicates to launch in the next wave given those launched so far,
+    // at most doubling them, 0 when no more are needed
+    int additionalReplicates(int launched) const;
+
+    static const char* statisticName(Statistic statistic);
+
+    // Two sided 95% quantile of Student's t distribution
+    static double studentQuantile(int degreesOfFreedom);
+
+private:
+    Statistic mStatistic;
+    double mTargetHalfWidth;
+    int mMaximumReplicates;
+
+    RunningStatistics mStatistics;
+};
+
+#endif // CONVERGENCETARGET_H
@@ -1,70 +1,50 @@
 #include <algorithm>
-#include <ctime>
 #include <cmath>
-#include <memory>
-#include <QtGlobal>
+#include <iterator>
+#include <thread>
 #include "globalcapso.h"
 
-using std::list;
-using std::shared_ptr;
 using std::weak_ptr;
-using std::make_shared;
 using std::for_each;
-using std::copy;
-using std::transform;
-using std::uniform_int_distribution;
 
 GlobalCaPso::GlobalCaPso(int width, int height)
-    : CellularAutomaton(width, height),
-    mPredatorSwarm(1.0f, 2.0f, 0.9f, 10, 3,
-                   mLattice, mPreyDensities, mTemp,
-                   width, height, PREDATOR, mRandom),
-    // Containers
-    mTemp(width * height),
-    mPreyDensities(width * height),
-    mNumberOfPreys(0),
-    mNumberOfPredators(0),
-    // Model Parameters
-    mInitialPreyPercentage(0.5),
-    mCompetitionFactor(0.3),
-    mCompetitionRadius(5),
-    mPreyMeanOffspring(2),
-    mPreyReproductionRadius(1),
-    mPredatorMeanOffspring(5),
-    mPredatorReproductionRadius(3),
-    NEIGHBORHOOD_SIZE((2 * mCompetitionRadius + 1)*(2 * mCompetitionRadius + 1) - 1),
-    // Pso Parameters
-    mInitialSwarmSize(3),
-    mMigrationTime(5),
-    mMigrationCount(0),
-    mInitialInertiaWeight(0.9f),
-    mCurrentInertiaWeight(mInitialInertiaWeight),
-    mFinalInertiaWeight(0.2f),
-    INERTIA_STEP((mInitialInertiaWeight - mFinalInertiaWeight) / mMigrationTime)
+    : CaPsoBase(width, height),
+    mNextSequence(0),
+    mSearchThreads(1)
 {
+    // Model Parameters
+    mPreyInitialDensity = 0.5;
+    mPreyCompetitionFactor = 0.3;
+    mFitnessRadius = 5;
+    mPreyReproductiveCapacity = 2;
+    mPreyReproductionRadius = 1;
+    mPredatorReproductiveCapacity = 5;
+    mPredatorReproductionRadius = 3;
+    NEIGHBORHOOD_SIZE = (2 * mFitnessRadius + 1)*(2 * mFitnessRadius + 1) - 1;
+
     initialize();
 }
 
 void GlobalCaPso::setInitialPreyPercentage(float value)
 {
-    mInitialPreyPercentage = value;
+    mPreyInitialDensity = value;
 }
 
 void GlobalCaPso::setCompetitionFactor(float value)
 {
-    mCompetitionFactor = value;
+    mPreyCompetitionFactor = value;
 }
 
 void GlobalCaPso::setCompetitionRadius(int value)
 {
-    mCompetitionRadius = value;
+    mFitnessRadius = value;
 
     NEIGHBORHOOD_SIZE = (2 * value + 1)*(2 * value + 1) - 1;
 }
 
 void GlobalCaPso::setPreyMeanOffspring(int value)
 {
-    mPreyMeanOffspring = value;
+    mPreyReproductiveCapacity = value;
 }
 
 void GlobalCaPso::setPreyReproductionRadius(int value)
@@ -74,7 +54,7 @@ void GlobalCaPso::setPreyReproductionRadius(int value)
 
 void GlobalCaPso::setPredatorMeanOffspring(int value)
 {
-    mPredatorMeanOffspring = value;
+    mPredatorReproductiveCapacity = value;
 }
 
 void GlobalCaPso::setPredatorReproductionRadius(int value)
@@ -84,7 +64,7 @@ void GlobalCaPso::setPredatorReproductionRadius(int value)
 
 void GlobalCaPso::setInitialSwarmSize(int value)
 {
-    mInitialSwarmSize = value;
+    mPredatorInitialSwarmSize = value;
 }
 
 void GlobalCaPso::setCognitiveFactor(float value)
@@ -104,61 +84,36 @@ void GlobalCaPso::setMaximumSpeed(int value)
 
 void GlobalCaPso::setMitrationTime(int value)
 {
-    mMigrationTime = value;
+    mPredatorMigrationTime = value;
 }
 
 void GlobalCaPso::setInitialInertialWeight(float value)
 {
-    mInitialInertiaWeight = value;
+    mPredatorInitialInertiaWeight = value;
 }
 
 void GlobalCaPso::setFinalInertiaWeight(float value)
 {
-    mFinalInertiaWeight = value;
+    mPredatorFinalInertiaWeight = value;
 }
 
-int GlobalCaPso::numberOfPreys() const
+void GlobalCaPso::setSearchThreads(int threads)
 {
-    return mNumberOfPreys;
+    mSearchThreads = std::max(threads, 1);
 }
 
-int GlobalCaPso::numberOfPredators() const
+int GlobalCaPso::searchThreads() const
 {
-    return mNumberOfPredators;
+    return mSearchThreads;
 }
 
 void GlobalCaPso::initialize()
 {
-    clear();
-
-    // Create and render predators
-    mPredatorSwarm.initialize(mInitialSwarmSize);
-
-    for_each(mPredatorSwarm.begin(), mPredatorSwarm.end(), [this](weak_ptr<Particle> wp)
-    {
-        if(auto p = wp.lock())
-        {
-            setState(getAddress(p->position.row, p->position.col), PREDATOR);
-
-            mNumberOfPredators++;
-        }
-    });
+    mSlotBest.clear();
+    mSlotSequence.clear();
+    mFreeSlots.clear();
 
-    // Randomly create preys
-    for(int row = 0; row < mHeight; row++)
-    {
-        for(int col = 0; col < mWidth; col++)
-        {
-            if(mRandom.GetRandomFloat() < mInitialPreyPercentage)
-            {
-                setState(getAddress(row, col), PREY);
-
-                notifyNeighbors(row, col, false);
-
-                mNumberOfPreys++;
-            }
-        }
-    }
+    CaPsoBase::initialize();
 
     // Obtain the starting best position known by the swarm
     auto it = mPredatorSwarm.begin();
@@ -182,94 +137,43 @@ void GlobalCaPso::initialize()
 
     // Render the best position
     setState(getAddress(mBestPosition.row, mBestPosition.col), BEST);
-
-    // Reset the migration counter
-    mMigrationCount = 0;
-
-    mNextStage = &GlobalCaPso::competitionOfPreys;
-}
-
-void GlobalCaPso::clear()
-{
-    CellularAutomaton::clear();
-
-    // Reset the densities
-    transform(mPreyDensities.begin(), mPreyDensities.end(), mPreyDensities.begin(), [](unsigned char)
-    {
-        return 0;
-    });
-
-    mNumberOfPreys = 0;
-    mNumberOfPredators = 0;
-}
-
-void GlobalCaPso::nextGen()
-{
-    (this->*mNextStage)();
 }
 
-void GlobalCaPso::competitionOfPreys()
+void GlobalCaPso::moveParticles()
 {
-    copy(mPreyDensities.begin(), mPreyDensities.end(), mTemp.begin());
+    mBatch.resize(std::distance(mPredatorSwarm.begin(), mPredatorSwarm.end()));
 
-    int currentAddress;
-    double deathProbability;
+    // Gather the particles, drawing the random factors in the order of the
+    // swarm
+    size_t i = 0;
 
-    for(int row = 0; row < mHeight; row++)
+    for_each(mPredatorSwarm.begin(), mPredatorSwarm.end(), [&, this](weak_ptr<Particle> wp)
     {
-        for(int col = 0; col < mWidth; col++)
+        if(auto p = wp.lock())
         {
-            currentAddress = getAddress(row, col);
-
-            if(checkState(currentAddress, PREY))
-            {
-                deathProbability = mTemp[currentAddress] *
-                        mCompetitionFactor / NEIGHBORHOOD_SIZE;
-
-                if(mRandom.GetRandomFloat() <= deathProbability)
-                {
-                    // Only kill the prey
-                    clearState(currentAddress, PREY);
-
-                    notifyNeighbors(row, col, true);
+            double r1 = mRandom.GetRandomFloat();
+            double r2 = mRandom.GetRandomFloat();
 
-                    mNumberOfPreys--;
-                }
-            }
+            mBatch.set(i++, p->position.row, p->position.col, p->velocity.row, p->velocity.col,
+                       p->bestPosition.row, p->bestPosition.col,
+                       mBestPosition.row, mBestPosition.col, r1, r2);
         }
-    }
+    });
 
-    mNextStage = &GlobalCaPso::migration;
-}
+    mBatch.resize(i);
 
-void GlobalCaPso::migration()
-{
-    auto validateVector = [this] (int& row, int& col)
+    // Get the new velocities and positions of the whole swarm at once
+    int maxSpeed = mPredatorSwarm.maxSpeed();
+    int threshold = speedThreshold(maxSpeed, [maxSpeed](int squaredSpeed)
     {
-        if(abs(row) > mHeight / 2)
-        {
-            if(row < 0)
-            {
-                row = row + mHeight;
-            }
-            else
-            {
-                row = row - mHeight;
-            }
-        }
+        return sqrt((double)squaredSpeed) > maxSpeed;
+    });
 
-        if(abs(col) > mWidth / 2)
-        {
-            if(col < 0)
-            {
-                col = col + mWidth;
-            }
-            else
-            {
-                col = col - mWidth;
-            }
-        }
-    };
+    mBatch.move(mWidth, mHeight, mPredatorSwarm.inertiaWeight(), mPredatorSwarm.cognitiveFactor(),
+                mPredatorSwarm.socialFactor(), maxSpeed, threshold);
+
+    // Move the particles in the order of the swarm
+    i = 0;
 
     for_each(mPredatorSwarm.begin(), mPredatorSwarm.end(), [&, this](weak_ptr<Particle> wp)
     {
@@ -278,57 +182,16 @@ void GlobalCaPso::migration()
             int pRow = p->position.row;
             int pCol = p->position.col;
 
+            int posRow = mBatch.row(i);
+            int posCol = mBatch.col(i);
+
             // Clear the previous cell
             clearState(getAddress(pRow, pCol), PREDATOR);
 
-            double r1 = mRandom.GetRandomFloat();
-            double r2 = mRandom.GetRandomFloat();
-
-            int currentVelRow = p->velocity.row;
-            int currentVelCol = p->velocity.col;
-
-            validateVector(currentVelRow, currentVelCol);
-
-            int cognitiveVelRow = p->bestPosition.row - pRow;
-            int cognitiveVelCol = p->bestPosition.col - pCol;
-
-            validateVector(cognitiveVelRow, cognitiveVelCol);
-
-            int globalVelRow = mBestPosition.row - pRow;
-            int globalVelCol = mBestPosition.col - pCol;
-
-            validateVector(globalVelRow, globalVelCol);
-
-            int velRow = (int)(mCurrentInertiaWeight * currentVelRow +
-                mPredatorSwarm.cognitiveFactor() * r1 * cognitiveVelRow +
-                mPredatorSwarm.socialFactor() * r2 * globalVelRow);
-            int velCol = (int)(mCurrentInertiaWeight * currentVelCol +
-                mPredatorSwarm.cognitiveFactor() * r1 * cognitiveVelCol +
-                mPredatorSwarm.socialFactor() * r2 * globalVelCol);
-
-            // Adjust speed
-            double speed = sqrt((double)(velRow * velRow + velCol * velCol));
-
-            while(speed > mPredatorSwarm.maxSpeed())
-            {
-                velRow *= (int)(0.9);
-                velCol *= (int)(0.9);
-
-                speed = sqrt((double)(velRow * velRow + velCol * velCol));
-            }
-
-            // Move the particle
-            int posRow = pRow + velRow;
-            int posCol = pCol + velCol;
-
-            // Adjust the position
-            posRow = (mHeight + posRow) % mHeight;
-            posCol = (mWidth + posCol) % mWidth;
-
             p->position.row = posRow;
             p->position.col = posCol;
-            p->velocity.row = velRow;
-            p->velocity.col = velCol;
+            p->velocity.row = mBatch.velocityRow(i);
+            p->velocity.col = mBatch.velocityCol(i);
 
             // Render the particle at its new position
             setState(getAddress(posRow, posCol), PREDATOR);
@@ -338,357 +201,152 @@ void GlobalCaPso::migration()
             {
                 p->bestPosition.row = posRow;
                 p->bestPosition.col = posCol;
+
+                moveBest(*p);
             }
+
+            i++;
         }
     });
-
-    // Decrease the inertia weight and increase the migration counter
-    mCurrentInertiaWeight -= INERTIA_STEP;
-    mMigrationCount++;
-
-    // If migration has ended, point to the next stage and reset the inertia
-    // weight and migration count
-    if(mMigrationCount == mMigrationTime)
-    {
-        mNextStage = &GlobalCaPso::reproductionOfPredators;
-        mMigrationCount = 0;
-        mCurrentInertiaWeight = mInitialInertiaWeight;
-    }
 }
 
-void GlobalCaPso::reproductionOfPredators()
+void GlobalCaPso::preysEaten()
 {
-    copy(mLattice.begin(), mLattice.end(), mTemp.begin());
-
-    list<shared_ptr<Particle>> newParticles;
-
-    for_each(mPredatorSwarm.begin(), mPredatorSwarm.end(), [&, this](weak_ptr<Particle> wp)
+    if(!mPredatorSwarm.empty())
     {
-        if(auto p = wp.lock())
-        {
-            int pRow = p->position.row;
-            int pCol = p->position.col;
-
-            int birthCount = 0;
-
-            while(birthCount < mPredatorMeanOffspring)
-            {
-                // Obtain an offset
-                int finalRow = mRandom.GetRandomInt(-mPredatorReproductionRadius, mPredatorReproductionRadius);
-                int finalCol = mRandom.GetRandomInt(-mPredatorReproductionRadius, mPredatorReproductionRadius);
-
-                if(finalRow == 0 && finalCol == 0)
-                {
-                    continue;
-                }
-
-                // Get relative coordinates
-                finalRow += pRow;
-                finalCol += pCol;
-
-                // Get final coordinates
-                if (finalRow < 0 && finalCol < 0)
-                {
-                    finalRow = mHeight + finalRow % mHeight;
-                    finalCol = mWidth + finalCol % mWidth;
-                }
-                else if (finalRow < 0 && finalCol >= 0)
-                {
-                    finalRow = mHeight + finalRow % mHeight;
-                    finalCol = finalCol % mWidth;
-                }
-                else if (finalRow >= 0 && finalCol < 0)
-                {
-                    finalRow = finalRow % mHeight;
-                    finalCol = mWidth + finalCol % mWidth;
-                }
-                else
-                {
-                    finalRow = finalRow % mHeight;
-                    finalCol = finalCol % mWidth;
-                }
-
-                if(!checkState(getAddress(finalRow, finalCol), PREDATOR))
-                {
-                    // Create a new particle
-                    auto particle = make_shared<Particle>();
-                    particle->position.row = finalRow;
-                    particle->position.col = finalCol;
-                    particle->bestPosition.row = p->bestPosition.row;
-                    particle->bestPosition.col = p->bestPosition.col;
-
-                    setState(getAddress(finalRow, finalCol), PREDATOR);
-
-                    newParticles.push_back(particle);
-
-                    mNumberOfPredators++;
-                }
-
-                birthCount++;
-            }
-        }
-    });
+        // After feeding the current best position becomes invalidated, obtain a new one,
+        // but first delete the original.
+        clearState(getAddress(mBestPosition.row, mBestPosition.col), BEST);
 
-    mPredatorSwarm.add(newParticles);
+        updateGlobalBest();
 
-    mNextStage = &GlobalCaPso::predatorsDeath;
+        // Render the best position
+        setState(getAddress(mBestPosition.row, mBestPosition.col), BEST);
+    }
 }
 
-void GlobalCaPso::predatorsDeath()
+void GlobalCaPso::particleAdded(Particle& particle)
 {
-    int currentAddress;
+    int slot;
 
-    for(auto it = mPredatorSwarm.begin(); it != mPredatorSwarm.end();)
+    if(!mFreeSlots.empty())
     {
-        currentAddress = getAddress((*it)->position.row, (*it)->position.col);
-
-        if(!checkState(currentAddress, PREY))
-        {
-            clearState(currentAddress, PREDATOR);
-            it = mPredatorSwarm.erase(it);
-            mNumberOfPredators--;
-        }
-        else
-        {
-            ++it;
-        }
+        slot = mFreeSlots.back();
+        mFreeSlots.pop_back();
+    }
+    else
+    {
+        slot = mSlotBest.size();
+        mSlotBest.push_back(-1);
+        mSlotSequence.push_back(0);
     }
 
-    mNextStage = &GlobalCaPso::predation;
+    particle.slot = slot;
+    mSlotBest[slot] = getAddress(particle.bestPosition.row, particle.bestPosition.col);
+    mSlotSequence[slot] = mNextSequence++;
 }
 
-void GlobalCaPso::predation()
+void GlobalCaPso::particleRemoved(const Particle& particle)
 {
-    for_each(mPredatorSwarm.begin(), mPredatorSwarm.end(), [this](weak_ptr<Particle> wp)
-    {
-        if(auto p = wp.lock())
-        {
-            int pRow = p->position.row;
-            int pCol = p->position.col;
-
-            int currentAddress = getAddress(pRow, pCol);
-
-            // Kill the prey in the current cell
-            if(checkState(currentAddress, PREY))
-            {
-                clearState(currentAddress, PREY);
-
-                notifyNeighbors(pRow, pCol, true);
+    mSlotBest[particle.slot] = -1;
+    mFreeSlots.push_back(particle.slot);
+}
 
-                mNumberOfPreys--;
-            }
-        }
-    });
+void GlobalCaPso::moveBest(const Particle& particle)
+{
+    mSlotBest[particle.slot] = getAddress(particle.bestPosition.row, particle.bestPosition.col);
+}
 
-    if(!mPredatorSwarm.empty())
+bool GlobalCaPso::betterSlot(int slot, int other) const
+{
+    // The densest best wins, then the particle that joined the swarm first
+    // as in a scan of the swarm
+    if(other < 0)
     {
-        // After feeding the current best position becomes invalidated, obtain a new one,
-        // but first delete the original.
-        clearState(getAddress(mBestPosition.row, mBestPosition.col), BEST);
-
-        auto it = mPredatorSwarm.begin();
-        mBestPosition.row = (*it)->bestPosition.row;
-        mBestPosition.col = (*it)->bestPosition.col;
-
-        for_each(mPredatorSwarm.begin(), mPredatorSwarm.end(), [this](weak_ptr<Particle> wp)
-        {
-            if(auto p = wp.lock())
-            {
-                int pBestRow = p->bestPosition.row;
-                int pBestCol = p->bestPosition.col;
-
-                if(mPreyDensities[getAddress(pBestRow, pBestCol)] > mPreyDensities[getAddress(mBestPosition.row, mBestPosition.col)])
-                {
-                    mBestPosition.row = pBestRow;
-                    mBestPosition.col = pBestCol;
-                }
-            }
-        });
+        return slot >= 0;
+    }
 
-        // Render the best position
-        setState(getAddress(mBestPosition.row, mBestPosition.col), BEST);
+    if(slot < 0)
+    {
+        return false;
     }
 
-    mNextStage = &GlobalCaPso::reproductionOfPreys;
+    int density = mPreyDensities[mSlotBest[slot]];
+    int otherDensity = mPreyDensities[mSlotBest[other]];
+
+    return density > otherDensity ||
+           (density == otherDensity && mSlotSequence[slot] < mSlotSequence[other]);
 }
 
-void GlobalCaPso::predation2()
+int GlobalCaPso::bestSlot(size_t begin, size_t end) const
 {
-    copy(mLattice.begin(), mLattice.end(), mTemp.begin());
+    int best = -1;
+    int bestDensity = -1;
 
-    for_each(mPredatorSwarm.begin(), mPredatorSwarm.end(), [this](weak_ptr<Particle> wp)
+    for(size_t slot = begin; slot < end; slot++)
     {
-        if(auto p = wp.lock())
+        if(mSlotBest[slot] < 0)
         {
-            int pRow = p->position.row;
-            int pCol = p->position.col;
-
-            for(int nRow = pRow - 1; nRow <= pRow + 1; nRow++)
-            {
-                for(int nCol = pCol - 1; nCol <= pCol + 1; nCol++)
-                {
-                    int finalRow = (mHeight + nRow) % mHeight;
-                    int finalCol = (mWidth + nCol) % mWidth;
-
-                    int neighbourAddress = getAddress(finalRow, finalCol);
-
-                    if(checkState(neighbourAddress, PREY))
-                    {
-                        // Kill the prey
-                        clearState(neighbourAddress, PREY);
-
-                        notifyNeighbors(finalRow, finalCol, true);
-
-                        mNumberOfPreys--;
-                    }
-                }
-            }
+            continue;
         }
-    });
-
-    if(!mPredatorSwarm.empty())
-    {
-        // After feeding the current best position becomes invalidated, obtain a new one,
-        // but first delete the original.
-        clearState(getAddress(mBestPosition.row, mBestPosition.col), BEST);
 
-        auto it = mPredatorSwarm.begin();
-        mBestPosition.row = (*it)->bestPosition.row;
-        mBestPosition.col = (*it)->bestPosition.col;
+        int density = mPreyDensities[mSlotBest[slot]];
 
-        for_each(mPredatorSwarm.begin(), mPredatorSwarm.end(), [this](weak_ptr<Particle> wp)
+        if(density > bestDensity ||
+           (density == bestDensity && mSlotSequence[slot] < mSlotSequence[best]))
         {
-            if(auto p = wp.lock())
-            {
-                int pBestRow = p->bestPosition.row;
-                int pBestCol = p->bestPosition.col;
-
-                if(mPreyDensities[getAddress(pBestRow, pBestCol)] > mPreyDensities[getAddress(mBestPosition.row, mBestPosition.col)])
-                {
-                    mBestPosition.row = pBestRow;
-                    mBestPosition.col = pBestCol;
-                }
-            }
-        });
-
-        // Render the best position
-        setState(getAddress(mBestPosition.row, mBestPosition.col), BEST);
+            best = slot;
+            bestDensity = density;
+        }
     }
 
-    mNextStage = &GlobalCaPso::reproductionOfPreys;
+    return best;
 }
 
-void GlobalCaPso::reproductionOfPreys()
+void GlobalCaPso::updateGlobalBest()
 {
-    copy(mLattice.begin(), mLattice.end(), mTemp.begin());
-
-    int finalRow, finalCol, neighbourAddress;
-    int birthCount;
-
-    for(int row = 0; row < mHeight; row++)
+    // Nearly every best position sees its density change between seasons,
+    // so no incremental structure beats a scan. Large swarms are split in
+    // chunks searched in parallel, whose winners are compared in order
+    size_t slots = mSlotBest.size();
+    size_t threads = std::min<size_t>(mSearchThreads, slots / MIN_SLOTS_PER_THREAD);
+    int best;
+
+    if(threads > 1)
     {
-        for(int col = 0; col < mWidth; col++)
+        std::vector<int> winners(threads);
+        std::vector<std::thread> workers;
+        size_t chunk = (slots + threads - 1) / threads;
+
+        for(size_t t = 1; t < threads; t++)
         {
-            if(mTemp[getAddress(row, col)] & PREY)
+            workers.emplace_back([&, t]()
             {
-                birthCount = 0;
-
-                while(birthCount < mPreyMeanOffspring)
-                {
-                    // Obtain an offset
-                    finalRow = mRandom.GetRandomInt(-mPreyReproductionRadius, mPreyReproductionRadius);
-                    finalCol = mRandom.GetRandomInt(-mPreyReproductionRadius, mPreyReproductionRadius);
-
-                    if(finalRow == 0 && finalCol == 0)
-                    {
-                        continue;
-                    }
-
-                    // Get relative coordinates
-                    finalRow += row;
-                    finalCol += col;
-
-                    // Get final coordinates
-                    if (finalRow < 0 && finalCol < 0)
-                    {
-                        finalRow = mHeight + finalRow % mHeight;
-                        finalCol = mWidth + finalCol % mWidth;
-                    }
-                    else if (finalRow < 0 && finalCol >= 0)
-                    {
-                        finalRow = mHeight + finalRow % mHeight;
-                        finalCol = finalCol % mWidth;
-                    }
-                    else if (finalRow >= 0 && finalCol < 0)
-                    {
-                        finalRow = finalRow % mHeight;
-                        finalCol = mWidth + finalCol % mWidth;
-                    }
-                    else
-                    {
-                        finalRow = finalRow % mHeight;
-                        finalCol = finalCol % mWidth;
-                    }
-
-                    neighbourAddress = getAddress(finalRow, finalCol);
-
-                    if(!checkState(neighbourAddress, PREY))
-                    {
-                        setState(neighbourAddress, PREY);
-
-                        notifyNeighbors(finalRow, finalCol, false);
-
-                        mNumberOfPreys++;
-                    }
-
-                    birthCount++;
-                }
-            }
+                winners[t] = bestSlot(t * chunk, std::min(slots, (t + 1) * chunk));
+            });
         }
-    }
 
-    mNextStage = &GlobalCaPso::competitionOfPreys;
-}
-
-void GlobalCaPso::notifyNeighbors(const int& row, const int& col, const bool& death)
-{
-    int finalRow, finalCol;
+        winners[0] = bestSlot(0, chunk);
 
-    for(int nRow = row - mCompetitionRadius; nRow <= row + mCompetitionRadius; nRow++)
-    {
-        for(int nCol = col - mCompetitionRadius; nCol <= col + mCompetitionRadius; nCol++)
+        for(std::thread& worker : workers)
         {
-            if(nRow == row && nCol == col)
-            {
-                continue;
-            }
+            worker.join();
+        }
 
-            finalRow = (mHeight + nRow) % mHeight;
-            finalCol = (mWidth + nCol) % mWidth;
+        best = winners[0];
 
-            if(death)
-            {
-                mPreyDensities[getAddress(finalRow, finalCol)]--;
-            }
-            else
+        for(size_t t = 1; t < threads; t++)
+        {
+            if(betterSlot(winners[t], best))
             {
-                mPreyDensities[getAddress(finalRow, finalCol)]++;
+                best = winners[t];
             }
         }
     }
-}
-
-bool GlobalCaPso::checkState(int address, State state)
-{
-    return mLattice[address] & state;
-}
-
-void GlobalCaPso::setState(int address, State state)
-{
-    mLattice[address] |= state;
-}
+    else
+    {
+        best = bestSlot(0, slots);
+    }
 
-void GlobalCaPso::clearState(int address, State state)
-{
-    mLattice[address] &= ~state;
+    mBestPosition = mLayout.point(mSlotBest[best]);
 }
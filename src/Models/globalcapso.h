@@ -1,13 +1,11 @@
 #ifndef GLOBALCAPSO_H
 #define GLOBALCAPSO_H
 
-#include <random>
-#include <list>
-#include "cellularautomaton.h"
-#include "swarm.h"
-#include "util.h"
+#include "capsobase.h"
+#include "migration.h"
 
-class GlobalCaPso final : public CellularAutomaton
+// Predators follow the best position known by the whole swarm
+class GlobalCaPso final : public CaPsoBase<GlobalCaPso>
 {
 public:
     enum State {EMPTY, PREY, PREDATOR, PREY_PREDATOR, BEST = 4};
@@ -29,67 +27,51 @@ public:
     void setInitialInertialWeight(float value);
     void setFinalInertiaWeight(float value);
 
-    int numberOfPreys() const;
-    int numberOfPredators() const;
+    // Threads searching the global best of large swarms, 1 by default
+    // since batch runs are already parallel across replicates
+    void setSearchThreads(int threads);
+    int searchThreads() const;
 
     void initialize() override;
-    virtual void clear() override;
-    void nextGen() override;
 
 private:
+    friend class CaPsoBase<GlobalCaPso>;
+
     GlobalCaPso(const GlobalCaPso&);
     GlobalCaPso& operator=(const GlobalCaPso&);
 
 private:
-    Swarm mPredatorSwarm;
-
-    // Containers
-    std::vector<unsigned char> mTemp;
-    std::vector<unsigned char> mPreyDensities;
-
-    int mNumberOfPreys, mNumberOfPredators;
-
-    RandomNumber mRandom;
-
-    // A function pointer that handles transitions
-    void (GlobalCaPso::*mNextStage)();
-
-    // Model parameters
-    double mInitialPreyPercentage;
-    double mCompetitionFactor;
-    int mCompetitionRadius;
-    int mPreyMeanOffspring;
-    int mPreyReproductionRadius;
-    int mPredatorMeanOffspring;
-    int mPredatorReproductionRadius;
-    int NEIGHBORHOOD_SIZE;
-
-    // PSO parameters
-    int mInitialSwarmSize;
-    int mMigrationTime;
-    int mMigrationCount;
-    float mInitialInertiaWeight;
-    float mCurrentInertiaWeight;
-    float mFinalInertiaWeight;
-    const float INERTIA_STEP;
     LatticePoint mBestPosition;
 
-    // Model Stages
-    void competitionOfPreys();
-    void migration();
-    void reproductionOfPredators();
-    void predatorsDeath();
-    void predation();
-    void predation2();
-    void reproductionOfPreys();
-
-    // Misc methods
-    void notifyNeighbors(const int& row, const int& col,
-                         const bool& death_birth);
-
-    bool checkState(int address, State state);
-    void setState(int address, State state);
-    void clearState(int address, State state);
+    // Global best tracking: every particle owns a slot holding the address
+    // of its best position and its order of arrival in the swarm, so the
+    // search reads flat arrays instead of walking the swarm
+    std::vector<int> mSlotBest;
+    std::vector<int64_t> mSlotSequence;
+    std::vector<int> mFreeSlots;
+    int64_t mNextSequence;
+    int mSearchThreads;
+
+    // Fewer slots than this per thread are searched by the calling thread
+    static const int MIN_SLOTS_PER_THREAD = 8192;
+
+    // Scratch arrays of a migration step
+    MigrationBatch<double> mBatch;
+
+    // Model hooks, a predation radius of 1 lets predators feed on their
+    // whole Moore neighborhood
+    static const int PREDATION_RADIUS = 0;
+
+    void moveParticles();
+    void particleAdded(Particle& particle);
+    void particleRemoved(const Particle& particle);
+    void preysEaten();
+
+    // Global best tracking
+    void moveBest(const Particle& particle);
+    bool betterSlot(int slot, int other) const;
+    int bestSlot(size_t begin, size_t end) const;
+    void updateGlobalBest();
 };
 
 #endif // GLOBALCAPSO_H
@@ -0,0 +1,144 @@
+// The kernels of one instruction set, only included by the kernels-*.cpp
+// files inside an anonymous namespace. The including file defines
+//
+//   CELL_LANES, VALUE_LANES                  Cells and floats per vector
+//   uint64_t stateMask(cells, state)         Bit i set if cells[i] & state
+//   uint64_t belowMask(values, limits)       Bit i set if values[i] <= limits[i]
+//   uint64_t belowLimit(values, limit)       Bit i set if values[i] <= limit
+//
+// and compiles it for its instruction set. The plain loops below are left
+// to the vectorizer. Nothing from the standard library is used here, as
+// its inline functions would be compiled for the instruction set too.
+
+size_t findState(const unsigned char* cells, size_t size, unsigned char state, int* indices)
+{
+    size_t count = 0;
+    size_t i = 0;
+
+    for(; i + CELL_LANES <= size; i += CELL_LANES)
+    {
+        for(uint64_t mask = stateMask(cells + i, state); mask; mask &= mask - 1)
+        {
+            indices[count++] = static_cast<int>(i) + __builtin_ctzll(mask);
+        }
+    }
+
+    for(; i < size; i++)
+    {
+        if(cells[i] & state)
+        {
+            indices[count++] = static_cast<int>(i);
+        }
+    }
+
+    return count;
+}
+
+size_t selectBelow(const float* values, const float* limits, const int* indices,
+                   size_t size, int* selected)
+{
+    size_t count = 0;
+    size_t i = 0;
+
+    for(; i + VALUE_LANES <= size; i += VALUE_LANES)
+    {
+        for(uint64_t mask = belowMask(values + i, limits + i); mask; mask &= mask - 1)
+        {
+            selected[count++] = indices[i + __builtin_ctzll(mask)];
+        }
+    }
+
+    for(; i < size; i++)
+    {
+        if(values[i] <= limits[i])
+        {
+            selected[count++] = indices[i];
+        }
+    }
+
+    return count;
+}
+
+size_t markBelow(const float* values, size_t size, float limit,
+                 unsigned char* cells, unsigned char state)
+{
+    size_t count = 0;
+    size_t i = 0;
+
+    for(; i + VALUE_LANES <= size; i += VALUE_LANES)
+    {
+        for(uint64_t mask = belowLimit(values + i, limit); mask; mask &= mask - 1)
+        {
+            cells[i + __builtin_ctzll(mask)] |= state;
+            count++;
+        }
+    }
+
+    for(; i < size; i++)
+    {
+        if(values[i] <= limit)
+        {
+            cells[i] |= state;
+            count++;
+        }
+    }
+
+    return count;
+}
+
+void maskState(const unsigned char* __restrict cells, size_t size, unsigned char state,
+               unsigned char* __restrict bits)
+{
+    for(size_t i = 0; i < size; i++)
+    {
+        bits[i] = (cells[i] & state) != 0;
+    }
+}
+
+void windowSum(const unsigned char* __restrict values, size_t size, int span,
+               unsigned char* __restrict sums)
+{
+    for(size_t i = 0; i < size; i++)
+    {
+        sums[i] = values[i];
+    }
+
+    for(int offset = 1; offset < span; offset++)
+    {
+        const unsigned char* shifted = values + offset;
+
+        for(size_t i = 0; i < size; i++)
+        {
+            sums[i] += shifted[i];
+        }
+    }
+}
+
+void addRow(unsigned char* __restrict sums, const unsigned char* __restrict values, size_t size)
+{
+    for(size_t i = 0; i < size; i++)
+    {
+        sums[i] += values[i];
+    }
+}
+
+void subtractRow(unsigned char* __restrict sums, const unsigned char* __restrict values,
+                 size_t size)
+{
+    for(size_t i = 0; i < size; i++)
+    {
+        sums[i] -= values[i];
+    }
+}
+
+const Kernels KERNELS =
+{
+    KERNELS_NAME,
+    findState,
+    selectBelow,
+    markBelow,
+    maskState,
+    windowSum,
+    addRow,
+    subtractRow
+};
@@ -0,0 +1,39 @@
+// Compiled with -mavx2
+#include <cstdint>
+#include <immintrin.h>
+#include "kernels.h"
+
+namespace
+{
+    const size_t CELL_LANES = 32;
+    const size_t VALUE_LANES = 8;
+
+    inline uint64_t stateMask(const unsigned char* cells, unsigned char state)
+    {
+        __m256i masked = _mm256_and_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(cells)),
+                                          _mm256_set1_epi8(static_cast<char>(state)));
+        uint32_t empty = _mm256_movemask_epi8(_mm256_cmpeq_epi8(masked, _mm256_setzero_si256()));
+
+        return ~empty;
+    }
+
+    inline uint64_t belowMask(const float* values, const float* limits)
+    {
+        return _mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(values), _mm256_loadu_ps(limits),
+                                                _CMP_LE_OQ));
+    }
+
+    inline uint64_t belowLimit(const float* values, float limit)
+    {
+        return _mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(values), _mm256_set1_ps(limit),
+                                                _CMP_LE_OQ));
+    }
+
+#define KERNELS_NAME "avx2"
+#include "kernelloops.h"
+}
+
+const Kernels& avx2Kernels()
+{
+    return KERNELS;
+}
@@ -0,0 +1,34 @@
+// Compiled with -mavx512f -mavx512bw
+#include <cstdint>
+#include <immintrin.h>
+#include "kernels.h"
+
+namespace
+{
+    const size_t CELL_LANES = 64;
+    const size_t VALUE_LANES = 16;
+
+    inline uint64_t stateMask(const unsigned char* cells, unsigned char state)
+    {
+        return _mm512_test_epi8_mask(_mm512_loadu_si512(cells),
+                                     _mm512_set1_epi8(static_cast<char>(state)));
+    }
+
+    inline uint64_t belowMask(const float* values, const float* limits)
+    {
+        return _mm512_cmp_ps_mask(_mm512_loadu_ps(values), _mm512_loadu_ps(limits), _CMP_LE_OQ);
+    }
+
+    inline uint64_t belowLimit(const float* values, float limit)
+    {
+        return _mm512_cmp_ps_mask(_mm512_loadu_ps(values), _mm512_set1_ps(limit), _CMP_LE_OQ);
+    }
+
+#define KERNELS_NAME "avx512"
+#include "kernelloops.h"
+}
+
+const Kernels& avx512Kernels()
+{
+    return KERNELS;
+}
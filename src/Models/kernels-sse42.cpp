@@ -0,0 +1,37 @@
+// Compiled with -msse4.2
+#include <cstdint>
+#include <nmmintrin.h>
+#include "kernels.h"
+
+namespace
+{
+    const size_t CELL_LANES = 16;
+    const size_t VALUE_LANES = 4;
+
+    inline uint64_t stateMask(const unsigned char* cells, unsigned char state)
+    {
+        __m128i masked = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(cells)),
+                                       _mm_set1_epi8(static_cast<char>(state)));
+        int empty = _mm_movemask_epi8(_mm_cmpeq_epi8(masked, _mm_setzero_si128()));
+
+        return ~empty & 0xffff;
+    }
+
+    inline uint64_t belowMask(const float* values, const float* limits)
+    {
+        return _mm_movemask_ps(_mm_cmple_ps(_mm_loadu_ps(values), _mm_loadu_ps(limits)));
+    }
+
+    inline uint64_t belowLimit(const float* values, float limit)
+    {
+        return _mm_movemask_ps(_mm_cmple_ps(_mm_loadu_ps(values), _mm_set1_ps(limit)));
+    }
+
+#define KERNELS_NAME "sse4.2"
+#include "kernelloops.h"
+}
+
+const Kernels& sse42Kernels()
+{
+    return KERNELS;
+}
@@ -0,0 +1,169 @@
+#include <cstdlib>
+#include <cstring>
+#include "kernels.h"
+
+#ifdef CAPSO_X86_KERNELS
+const Kernels& sse42Kernels();
+const Kernels& avx2Kernels();
+const Kernels& avx512Kernels();
+#endif
+
+namespace
+{
+    // The reference, one cell at a time
+    size_t findState(const unsigned char* cells, size_t size, unsigned char state, int* indices)
+    {
+        size_t count = 0;
+
+        for(size_t i = 0; i < size; i++)
+        {
+            if(cells[i] & state)
+            {
+                indices[count++] = static_cast<int>(i);
+            }
+        }
+
+        return count;
+    }
+
+    size_t selectBelow(const float* values, const float* limits, const int* indices,
+                       size_t size, int* selected)
+    {
+        size_t count = 0;
+
+        for(size_t i = 0; i < size; i++)
+        {
+            if(values[i] <= limits[i])
+            {
+                selected[count++] = indices[i];
+            }
+        }
+
+        return count;
+    }
+
+    size_t markBelow(const float* values, size_t size, float limit,
+                     unsigned char* cells, unsigned char state)
+    {
+        size_t count = 0;
+
+        for(size_t i = 0; i < size; i++)
+        {
+            if(values[i] <= limit)
+            {
+                cells[i] |= state;
+                count++;
+            }
+        }
+
+        return count;
+    }
+
+    void maskState(const unsigned char* cells, size_t size, unsigned char state,
+                   unsigned char* bits)
+    {
+        for(size_t i = 0; i < size; i++)
+        {
+            bits[i] = (cells[i] & state) ? 1 : 0;
+        }
+    }
+
+    void windowSum(const unsigned char* values, size_t size, int span, unsigned char* sums)
+    {
+        for(size_t i = 0; i < size; i++)
+        {
+            unsigned char sum = 0;
+
+            for(int offset = 0; offset < span; offset++)
+            {
+                sum += values[i + offset];
+            }
+
+            sums[i] = sum;
+        }
+    }
+
+    void addRow(unsigned char* sums, const unsigned char* values, size_t size)
+    {
+        for(size_t i = 0; i < size; i++)
+        {
+            sums[i] += values[i];
+        }
+    }
+
+    void subtractRow(unsigned char* sums, const unsigned char* values, size_t size)
+    {
+        for(size_t i = 0; i < size; i++)
+        {
+            sums[i] -= values[i];
+        }
+    }
+
+    const Kernels& selectKernels()
+    {
+        std::vector<const Kernels*> supported = supportedKernels();
+
+        if(const char* name = std::getenv("CAPSO_KERNELS"))
+        {
+            for(const Kernels* kernels : supported)
+            {
+                if(!std::strcmp(kernels->name, name))
+                {
+                    return *kernels;
+                }
+            }
+        }
+
+        return *supported.back();
+    }
+}
+
+const Kernels& fastestKernels()
+{
+    static const Kernels& kernels = selectKernels();
+
+    return kernels;
+}
+
+const Kernels& scalarKernels()
+{
+    static const Kernels kernels =
+    {
+        "scalar",
+        findState,
+        selectBelow,
+        markBelow,
+        maskState,
+        windowSum,
+        addRow,
+        subtractRow
+    };
+
+    return kernels;
+}
+
+std::vector<const Kernels*> supportedKernels()
+{
+    std::vector<const Kernels*> supported = { &scalarKernels() };
+
+#ifdef CAPSO_X86_KERNELS
+    __builtin_cpu_init();
+
+    if(__builtin_cpu_supports("sse4.2"))
+    {
+        supported.push_back(&sse42Kernels());
+    }
+
+    if(__builtin_cpu_supports("avx2"))
+    {
+        supported.push_back(&avx2Kernels());
+    }
+
+    if(__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw"))
+    {
+        supported.push_back(&avx512Kernels());
+    }
+#endif
+
+    return supported;
+}
@@ -0,0 +1,80 @@
+#ifndef KERNELS_H
+#define KERNELS_H
+
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+// The bulk loops of the models over runs of consecutive cells, compiled
+// once per instruction set. Every set computes exactly the same results as
+// the scalar reference, the models pick the fastest one the CPU supports.
+struct Kernels
+{
+    const char* name;
+
+    // Prey counting: writes the indices of the cells holding the state to
+    // indices and returns how many there are
+    size_t (*findState)(const unsigned char* cells, size_t size, unsigned char state,
+                        int* indices);
+
+    // Competition thresholding: copies indices[i] to selected for every
+    // values[i] <= limits[i] and returns how many were copied
+    size_t (*selectBelow)(const float* values, const float* limits, const int* indices,
+                          size_t size, int* selected);
+
+    // Adds the state to the cells whose value is at most limit and returns
+    // how many there are
+    size_t (*markBelow)(const float* values, size_t size, float limit,
+                        unsigned char* cells, unsigned char state);
+
+    // Density accumulation, modulo 256 as the densities themselves
+    // bits[i] = 1 if cells[i] holds the state, 0 otherwise
+    void (*maskState)(const unsigned char* cells, size_t size, unsigned char state,
+                      unsigned char* bits);
+    // sums[i] = values[i] + ... + values[i + span - 1]
+    void (*windowSum)(const unsigned char* values, size_t size, int span,
+                      unsigned char* sums);
+    // sums[i] += values[i] and sums[i] -= values[i]
+    void (*addRow)(unsigned char* sums, const unsigned char* values, size_t size);
+    void (*subtractRow)(unsigned char* sums, const unsigned char* values, size_t size);
+};
+
+// The fastest set the CPU supports, chosen on the first call. The
+// CAPSO_KERNELS environment variable may name another supported set, e.g.,
+// scalar.
+const Kernels& fastestKernels();
+
+const Kernels& scalarKernels();
+
+// Every set the CPU supports, from the scalar one to the fastest
+std::vector<const Kernels*> supportedKernels();
+
+// Limits for the kernels comparing floats, such that for every float x
+// x <= floatAtMost(value) if and only if x <= value, and
+// x <= floatBelow(value) if and only if x < value
+inline float floatAtMost(double value)
+{
+    float limit = static_cast<float>(value);
+
+    if(limit > value)
+    {
+        limit = std::nextafter(limit, -std::numeric_limits<float>::infinity());
+    }
+
+    return limit;
+}
+
+inline float floatBelow(double value)
+{
+    float limit = floatAtMost(value);
+
+    if(limit == value)
+    {
+        limit = std::nextafter(limit, -std::numeric_limits<float>::infinity());
+    }
+
+    return limit;
+}
+
+#endif // KERNELS_H
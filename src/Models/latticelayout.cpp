@@ -0,0 +1,114 @@
+#include <algorithm>
+#include "latticelayout.h"
+#include "morton.h"
+
+LatticeLayout::LatticeLayout(int width, int height, int tileSize)
+    : mWidth(width),
+      mHeight(height),
+      mTileSize(std::max(tileSize, 0)),
+      mRowOffsets(height),
+      mColOffsets(width)
+{
+    if(rowMajor())
+    {
+        for(int row = 0; row < height; row++)
+        {
+            mRowOffsets[row] = width * row;
+        }
+
+        for(int col = 0; col < width; col++)
+        {
+            mColOffsets[col] = col;
+        }
+    }
+    else
+    {
+        // The Z-order index of a tile splits into a part of its row and one
+        // of its column, since their bits do not overlap
+        const int tileCells = mTileSize * mTileSize;
+
+        for(int row = 0; row < height; row++)
+        {
+            mRowOffsets[row] = static_cast<int>(spreadBits(row / mTileSize) << 1) * tileCells +
+                               (row % mTileSize) * mTileSize;
+        }
+
+        for(int col = 0; col < width; col++)
+        {
+            mColOffsets[col] = static_cast<int>(spreadBits(col / mTileSize)) * tileCells +
+                               col % mTileSize;
+        }
+    }
+
+    // Both offsets grow with the row and the column
+    mSize = width > 0 && height > 0 ? mRowOffsets[height - 1] + mColOffsets[width - 1] + 1 : 0;
+}
+
+LatticePoint LatticeLayout::point(int address) const
+{
+    LatticePoint point;
+
+    if(rowMajor())
+    {
+        point.row = address / mWidth;
+        point.col = address % mWidth;
+    }
+    else
+    {
+        const int tileCells = mTileSize * mTileSize;
+
+        int tile = address / tileCells;
+        int cell = address % tileCells;
+
+        point.row = static_cast<int>(compactBits(tile >> 1)) * mTileSize + cell / mTileSize;
+        point.col = static_cast<int>(compactBits(tile)) * mTileSize + cell % mTileSize;
+    }
+
+    return point;
+}
+
+void LatticeLayout::toRowMajor(const unsigned char* cells, unsigned char* rowMajor) const
+{
+    if(this->rowMajor())
+    {
+        std::copy(cells, cells + mWidth * mHeight, rowMajor);
+        return;
+    }
+
+    for(int row = 0; row < mHeight; row++)
+    {
+        const unsigned char* source = cells + mRowOffsets[row];
+        unsigned char* destination = rowMajor + mWidth * row;
+
+        // Runs of a tile row are contiguous
+        for(int col = 0; col < mWidth; col += mTileSize)
+        {
+            int run = std::min(mTileSize, mWidth - col);
+
+            std::copy(source + mColOffsets[col], source + mColOffsets[col] + run,
+                      destination + col);
+        }
+    }
+}
+
+void LatticeLayout::fromRowMajor(const unsigned char* rowMajor, unsigned char* cells) const
+{
+    if(this->rowMajor())
+    {
+        std::copy(rowMajor, rowMajor + mWidth * mHeight, cells);
+        return;
+    }
+
+    for(int row = 0; row < mHeight; row++)
+    {
+        const unsigned char* source = rowMajor + mWidth * row;
+        unsigned char* destination = cells + mRowOffsets[row];
+
+        for(int col = 0; col < mWidth; col += mTileSize)
+        {
+            int run = std::min(mTileSize, mWidth - col);
+
+            std::copy(source + col, source + col + run, destination + mColOffsets[col]);
+        }
+    }
+}
@@ -0,0 +1,60 @@
+#ifndef LATTICELAYOUT_H
+#define LATTICELAYOUT_H
+
+#include <vector>
+#include "latticepoint.h"
+
+// Where every cell of a width x height lattice lives in memory. Either row
+// major, or square tiles stored one after the other in Z-order, each tile
+// row major. Tiles keep the cells of a small neighborhood within a few cache
+// lines and pages, whatever the width of the lattice.
+//
+// The address of a cell is the sum of an offset of its row and one of its
+// column, from two tables, for both layouts. Tiles that do not fit in the
+// lattice and the gaps of the Z-order over a grid of tiles that is not a
+// square power of two are padding, never addressed.
+class LatticeLayout
+{
+public:
+    // Row major when tileSize is 0
+    LatticeLayout(int width, int height, int tileSize = 0);
+
+    int address(int row, int col) const
+    {
+        return mRowOffsets[row] + mColOffsets[col];
+    }
+
+    int rowOffset(int row) const { return mRowOffsets[row]; }
+    int colOffset(int col) const { return mColOffsets[col]; }
+
+    // Cell at the given address
+    LatticePoint point(int address) const;
+
+    int width() const { return mWidth; }
+    int height() const { return mHeight; }
+    int tileSize() const { return mTileSize; }
+    bool rowMajor() const { return mTileSize == 0; }
+
+    // Cells of a row stored one after the other, starting at every
+    // multiple of it
+    int runLength() const { return rowMajor() ? mWidth : mTileSize; }
+
+    // Cells of storage, padding included
+    int size() const { return mSize; }
+
+    // Copies between a buffer of this layout and a row major one of
+    // width x height cells
+    void toRowMajor(const unsigned char* cells, unsigned char* rowMajor) const;
+    void fromRowMajor(const unsigned char* rowMajor, unsigned char* cells) const;
+
+private:
+    int mWidth;
+    int mHeight;
+    int mTileSize;
+    int mSize;
+
+    std::vector<int> mRowOffsets;
+    std::vector<int> mColOffsets;
+};
+
+#endif // LATTICELAYOUT_H
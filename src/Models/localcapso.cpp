@@ -1,96 +1,29 @@
-#include <algorithm>
-#include <ctime>
-#include <cmath>
-#include <memory>
 #include "localcapso.h"
 
-using std::list;
-using std::weak_ptr;
-using std::shared_ptr;
-using std::make_shared;
-using std::for_each;
-using std::copy;
-using std::transform;
-
 LocalCaPso::LocalCaPso(int width, int height)
-    : CellularAutomaton(width, height),
-    mPreyDensities(width * height),
-    mTemp(width * height),
-    mPredatorSwarm(1.0f, 2.0f, 0.9f, 10, 3,
-                   mLattice, mPreyDensities, mTemp,
-                   width, height, PREDATOR, mRandom)
+    : CaPsoBase(width, height)
 {
     initialize();
 }
 
-void LocalCaPso::initialize()
+LocalCaPso::LocalCaPso(const LocalCaPso& other, uint64_t stream)
+    : CaPsoBase(other, stream)
 {
-    clear();
-
-    // Create and render predators
-    mPredatorSwarm.initialize(mPredatorInitialSwarmSize);
-
-    for_each(mPredatorSwarm.begin(), mPredatorSwarm.end(),
-             [this](weak_ptr<Particle> wp)
-    {
-        if(auto p = wp.lock())
-        {
-            setState(getAddress(p->position.row, p->position.col), PREDATOR);
-
-            mNumberOfPredators++;
-        }
-    });
-
-    // Randomly create preys
-    for(int row = 0; row < mHeight; row++)
-    {
-        for(int col = 0; col < mWidth; col++)
-        {
-            if(mRandom.GetRandomFloat() < mPreyInitialDensity)
-            {
-                setState(getAddress(row, col), PREY);
-
-                notifyNeighbors(row, col, false);
-
-                mNumberOfPreys++;
-            }
-        }
-    }
-
-    // Reset the migration counter
-    mPredatorMigrationCount = 0;
-
-    mNextStage = &LocalCaPso::competitionOfPreys;
-    mCurrentStage = COMPETITION;
 }
 
-void LocalCaPso::clear()
+std::unique_ptr<LocalCaPso> LocalCaPso::clone(uint64_t stream) const
 {
-    CellularAutomaton::clear();
-
-    // Reset the densities
-    std::transform(mPreyDensities.begin(), mPreyDensities.end(),
-                   mPreyDensities.begin(), [](unsigned char)
-    {
-        return 0;
-    });
-
-    mNumberOfPreys = 0;
-    mNumberOfPredators = 0;
-    mPreyBirthRate = 0;
-    mPredatorBirthRate = 0;
-    mPreyDeathProbability = 0;
-    mPredatorDeathProbability = 0;
+    return std::unique_ptr<LocalCaPso>(new LocalCaPso(*this, stream));
 }
 
-void LocalCaPso::nextGen()
+void LocalCaPso::setPredatorMigrationTime(int value)
 {
-    (this->*mNextStage)();
+    mPredatorMigrationTime = value;
 }
 
-void LocalCaPso::setPredatorMigrationTime(int value)
+void LocalCaPso::setNeighborSearch(Swarm::NeighborSearch search)
 {
-    mPredatorMigrationTime = value;
+    mPredatorSwarm.setNeighborSearch(search);
 }
 
 void LocalCaPso::setSettings(const CaPsoSettings &settings)
@@ -134,370 +67,33 @@ CaPsoSettings LocalCaPso::settings() const
     return settings;
 }
 
-int LocalCaPso::numberOfPreys() const
-{
-    return mNumberOfPreys;
-}
-
-int LocalCaPso::numberOfPredators() const
-{
-    return mNumberOfPredators;
-}
-
-float LocalCaPso::preyBirthRate() const
+void LocalCaPso::moveParticles()
 {
-    return mPreyBirthRate;
-}
-
-float LocalCaPso::predatorBirthRate() const
-{
-    return mPredatorBirthRate;
-}
-
-float LocalCaPso::preyDeathProbability() const
-{
-    return mPreyDeathProbability;
-}
-
-float LocalCaPso::predatorDeathProbability() const
-{
-    return mPredatorDeathProbability;
-}
-
-int LocalCaPso::currentStage() const
-{
-    return mCurrentStage;
-}
-
-void LocalCaPso::competitionOfPreys()
-{
-    std::copy(mPreyDensities.begin(), mPreyDensities.end(), mTemp.begin());
-
-    int currentAddress;
-    double deathProbability;
-
-    for(int row = 0; row < mHeight; row++)
-    {
-        for(int col = 0; col < mWidth; col++)
-        {
-            currentAddress = getAddress(row, col);
-
-            if(checkState(currentAddress, PREY))
-            {
-                deathProbability = mTemp[currentAddress] *
-                    mPreyCompetitionFactor / NEIGHBORHOOD_SIZE;
-
-                if(mRandom.GetRandomFloat() <= deathProbability)
-                {
-                    // Only kill the prey
-                    clearState(currentAddress, PREY);
-
-                    notifyNeighbors(row, col, true);
-
-                    mNumberOfPreys--;
-                }
-            }
-        }
-    }
-
-    mNextStage = &LocalCaPso::migration;
-    mCurrentStage = MIGRATION;
-}
-
-void LocalCaPso::migration()
-{
-    // Update the positions of all predators
     mPredatorSwarm.nextGen();
-
-    // Decrease the inertia weight and increase the migration counter
-    float weight = mPredatorSwarm.inertiaWeight() - INERTIA_STEP;
-    mPredatorSwarm.setInertiaWeight(weight);
-    mPredatorMigrationCount++;
-
-    // If migration has ended, point to the next stage and reset the inertia
-    // weight and migration count
-    if(mPredatorMigrationCount == mPredatorMigrationTime)
-    {
-        mNextStage = &LocalCaPso::reproductionOfPredators;
-        mCurrentStage = REPRODUCTION_OF_PREDATORS;
-        mPredatorMigrationCount = 0;
-        mPredatorSwarm.setInertiaWeight(mPredatorInitialInertiaWeight);
-    }
 }
 
-void LocalCaPso::reproductionOfPredators()
+void LocalCaPso::wrapOffspring(int& row, int& col)
 {
-    std::copy(mLattice.begin(), mLattice.end(), mTemp.begin());
-
-    list<shared_ptr<Particle>> newParticles;
-
-    int initialNumberOfPredators = mNumberOfPredators;
-
-    for_each(mPredatorSwarm.begin(), mPredatorSwarm.end(), [&, this](weak_ptr<Particle> wp)
+    // Columns left of the lattice wrap modulo its height, kept as it was
+    // for the results to stay comparable with the published ones
+    if (row < 0 && col < 0)
     {
-        if(auto p = wp.lock())
-        {
-            int pRow = p->position.row;
-            int pCol = p->position.col;
-
-            int birthCount = 0;
-
-            while(birthCount < mPredatorReproductiveCapacity)
-            {
-                // Obtain an offset
-                int finalRow = mRandom.GetRandomInt(-mPredatorReproductionRadius, mPredatorReproductionRadius);
-                int finalCol = mRandom.GetRandomInt(-mPredatorReproductionRadius, mPredatorReproductionRadius);
-
-                if(finalRow == 0 && finalCol == 0)
-                {
-                    continue;
-                }
-
-                // Get relative coordinates
-                finalRow += pRow;
-                finalCol += pCol;
-
-                // Get final coordinates
-                if (finalRow < 0 && finalCol < 0)
-                {
-                    finalRow = mHeight + finalRow % mHeight;
-                    finalCol = mWidth + finalCol % mWidth;
-                }
-                else if (finalRow < 0 && finalCol >= 0)
-                {
-                    finalRow = mHeight + finalRow % mHeight;
-                    finalCol = finalCol % mWidth;
-                }
-                else if (finalRow >= 0 && finalCol < 0)
-                {
-                    finalRow = finalRow % mHeight;
-                    finalCol = mWidth + finalCol % mHeight;
-                }
-                else
-                {
-                    finalRow = finalRow % mHeight;
-                    finalCol = finalCol % mWidth;
-                }
-
-                if(!checkState(getAddress(finalRow, finalCol), PREDATOR))
-                {
-                    // Create a new particle
-                    auto particle = make_shared<Particle>();
-                    particle->position.row = finalRow;
-                    particle->position.col = finalCol;
-                    particle->bestPosition.row = p->bestPosition.row;
-                    particle->bestPosition.col = p->bestPosition.col;
-
-                    setState(getAddress(finalRow, finalCol), PREDATOR);
-
-                    newParticles.push_back(particle);
-
-                    mNumberOfPredators++;
-                }
-
-                birthCount++;
-            }
-        }
-    });
-
-    mPredatorSwarm.add(newParticles);
-
-    int numberOfBirths = mNumberOfPredators - initialNumberOfPredators;
-
-    mPredatorBirthRate = static_cast<float>(numberOfBirths) / mLattice.size();
-
-    mNextStage = &LocalCaPso::predatorsDeath;
-    mCurrentStage = DEATH_OF_PREDATORS;
-}
-
-void LocalCaPso::predatorsDeath()
-{
-    int currentAddress;
-
-    int initialNumberOfPredators = mNumberOfPredators;
-
-    for(auto it = mPredatorSwarm.begin(); it != mPredatorSwarm.end();)
-    {
-        currentAddress = getAddress((*it)->position.row, (*it)->position.col);
-
-        if(!checkState(currentAddress, PREY))
-        {
-            clearState(currentAddress, PREDATOR);
-
-            // Since the iterator is invalidated when erase() is called, we must
-            // use its return value (an iterator pointing to the element following
-            // the element that has just been erased) to keep a valid iterator.
-            it = mPredatorSwarm.erase(it);
-            mNumberOfPredators--;
-        }
-        else
-        {
-            it++;
-        }
+        row = mHeight + row % mHeight;
+        col = mWidth + col % mWidth;
     }
-
-    int numberOfDeaths = initialNumberOfPredators - mNumberOfPredators;
-
-    mPredatorDeathProbability = static_cast<float>(numberOfDeaths) /
-            initialNumberOfPredators;
-
-    mNextStage = &LocalCaPso::predation;
-    mCurrentStage = DEATH_OF_PREYS;
-}
-
-void LocalCaPso::predation()
-{
-    int initialNumberOfPreys = mNumberOfPreys;
-
-    for_each(mPredatorSwarm.begin(), mPredatorSwarm.end(), [&, this](weak_ptr<Particle> wp)
+    else if (row < 0 && col >= 0)
     {
-        if(auto p = wp.lock())
-        {
-            int pRow = p->position.row;
-            int pCol = p->position.col;
-
-            int currentAddress = getAddress(pRow, pCol);
-
-            // Kill the prey in the current cell
-            if(checkState(currentAddress, PREY))
-            {
-                clearState(currentAddress, PREY);
-
-                notifyNeighbors(pRow, pCol, true);
-
-                mNumberOfPreys--;
-            }
-        }
-    });
-
-    int numberOfDeaths = initialNumberOfPreys - mNumberOfPreys;
-
-    mPreyDeathProbability = static_cast<float>(numberOfDeaths) /
-            initialNumberOfPreys;
-
-    mNextStage = &LocalCaPso::reproductionOfPreys;
-    mCurrentStage = REPRODUCTION_OF_PREYS;
-}
-
-void LocalCaPso::reproductionOfPreys()
-{
-    std::copy(mLattice.begin(), mLattice.end(), mTemp.begin());
-
-    int finalRow, finalCol, neighbourAddress;
-    int birthCount, initialNumberOfPreys = mNumberOfPreys;
-
-    for(int row = 0; row < mHeight; row++)
+        row = mHeight + row % mHeight;
+        col = col % mWidth;
+    }
+    else if (row >= 0 && col < 0)
     {
-        for(int col = 0; col < mWidth; col++)
-        {
-            if(mTemp[getAddress(row, col)] & PREY)
-            {
-                birthCount = 0;
-
-                while(birthCount < mPreyReproductiveCapacity)
-                {
-                    // Obtain an offset
-                    finalRow = mRandom.GetRandomInt(-mPreyReproductionRadius, mPreyReproductionRadius);
-                    finalCol = mRandom.GetRandomInt(-mPreyReproductionRadius, mPreyReproductionRadius);
-
-                    if(finalRow == 0 && finalCol == 0)
-                    {
-                        continue;
-                    }
-
-                    // Get relative coordinates
-                    finalRow += row;
-                    finalCol += col;
-
-                    // Get final coordinates
-                    if (finalRow < 0 && finalCol < 0)
-                    {
-                        finalRow = mHeight + finalRow % mHeight;
-                        finalCol = mWidth + finalCol % mWidth;
-                    }
-                    else if (finalRow < 0 && finalCol >= 0)
-                    {
-                        finalRow = mHeight + finalRow % mHeight;
-                        finalCol = finalCol % mWidth;
-                    }
-                    else if (finalRow >= 0 && finalCol < 0)
-                    {
-                        finalRow = finalRow % mHeight;
-                        finalCol = mWidth + finalCol % mHeight;
-                    }
-                    else
-                    {
-                        finalRow = finalRow % mHeight;
-                        finalCol = finalCol % mWidth;
-                    }
-
-                    /*finalRow = (mWidth + finalRow) % mWidth;
-                    finalCol = (mHeight + finalCol) % mHeight;*/
-
-                    neighbourAddress = getAddress(finalRow, finalCol);
-
-                    if(!(mLattice[neighbourAddress] & PREY))
-                    {
-                        mLattice[neighbourAddress] |= PREY;
-
-                        notifyNeighbors(finalRow, finalCol, false);
-
-                        mNumberOfPreys++;
-                    }
-
-                    birthCount++;
-                }
-            }
-        }
+        row = row % mHeight;
+        col = mWidth + col % mHeight;
     }
-
-    int numberOfBirths = mNumberOfPreys - initialNumberOfPreys;
-
-    mPreyBirthRate = static_cast<float>(numberOfBirths) / mLattice.size();
-
-    mNextStage = &LocalCaPso::competitionOfPreys;
-    mCurrentStage = COMPETITION;
-}
-
-void LocalCaPso::notifyNeighbors(const int& row, const int& col, const bool& death)
-{
-    int finalRow, finalCol;
-
-    for(int nRow = row - mFitnessRadius; nRow <= row + mFitnessRadius; nRow++)
+    else
     {
-        for(int nCol = col - mFitnessRadius; nCol <= col + mFitnessRadius; nCol++)
-        {
-            if(nRow == row && nCol == col)
-            {
-                continue;
-            }
-
-            finalRow = (mHeight + nRow) % mHeight;
-            finalCol = (mWidth + nCol) % mWidth;
-
-            if(death)
-            {
-                mPreyDensities[getAddress(finalRow, finalCol)]--;
-            }
-            else
-            {
-                mPreyDensities[getAddress(finalRow, finalCol)]++;
-            }
-        }
+        row = row % mHeight;
+        col = col % mWidth;
     }
 }
-
-bool LocalCaPso::checkState(int address, State state)
-{
-    return mLattice[address] & state;
-}
-
-void LocalCaPso::setState(int address, State state)
-{
-    mLattice[address] |= state;
-}
-
-void LocalCaPso::clearState(int address, State state)
-{
-    mLattice[address] &= ~state;
-}
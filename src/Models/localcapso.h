@@ -3,94 +3,42 @@
 
 #include <random>
 #include <list>
-#include "cellularautomaton.h"
-#include "swarm.h"
+#include <array>
+#include <memory>
+#include "capsobase.h"
 #include "capsosettings.h"
 
-class LocalCaPso final : public CellularAutomaton
+// Predators follow the best position known in their neighborhood
+class LocalCaPso final : public CaPsoBase<LocalCaPso>
 {
 public:
-    enum State { EMPTY, PREY, PREDATOR, PREY_PREDATOR };
-    enum Stage { COMPETITION, MIGRATION, REPRODUCTION_OF_PREDATORS,
-                 DEATH_OF_PREDATORS, DEATH_OF_PREYS, REPRODUCTION_OF_PREYS };
-
     LocalCaPso(int width, int height);
 
-    void initialize() override;
-    virtual void clear() override;
-    void nextGen() override;
-
     void setPredatorMigrationTime(int value);
 
+    // How predators find their neighbors during migration, the grid unless
+    // set otherwise
+    void setNeighborSearch(Swarm::NeighborSearch search);
+
+    // Create an independent copy of the current state of the model. The copy
+    // draws its random numbers from a generator derived from this one and
+    // the given stream, thus different streams yield different replicates.
+    std::unique_ptr<LocalCaPso> clone(uint64_t stream) const;
+
     void setSettings(const CaPsoSettings& settings);
     CaPsoSettings settings() const;
 
-    int   numberOfPreys() const;
-    int   numberOfPredators() const;
-    float preyBirthRate() const;
-    float predatorBirthRate() const;
-    float preyDeathProbability() const;
-    float predatorDeathProbability() const;
-    int   currentStage() const;
-
 private:
+    friend class CaPsoBase<LocalCaPso>;
+
     LocalCaPso(const LocalCaPso&);
     LocalCaPso& operator=(const LocalCaPso&);
 
-private:
-    // Model stages
-    void competitionOfPreys();
-    void migration();
-    void reproductionOfPredators();
-    void predatorsDeath();
-    void predation();
-    void reproductionOfPreys();
-
-    // Misc methods
-    void notifyNeighbors(const int& row, const int& col,
-                         const bool& death_birth);
-    bool checkState(int address, State state);
-    void setState(int address, State state);
-    void clearState(int address, State state);
-
-    // Containers
-    std::vector<unsigned char> mPreyDensities;
-    std::vector<unsigned char> mTemp;
-
-    Swarm mPredatorSwarm;
-
-    // Metrics
-    int mNumberOfPreys              { 0 };
-    int mNumberOfPredators          { 0 };
-    float mPreyBirthRate            { 0.0f };
-    float mPredatorBirthRate        { 0.0f };
-    float mPreyDeathProbability     { 0.0f };
-    float mPredatorDeathProbability { 0.0f };
-    int mCurrentStage               { COMPETITION };
-
-    RandomNumber mRandom;
-
-    // A function pointer that handles transitions
-    void (LocalCaPso::*mNextStage)();
-
-    // Model parameters
-    double mPreyInitialDensity        { 0.0 };
-    double mPreyCompetitionFactor     { 0.3 };
-    int mPreyReproductiveCapacity     { 10 };
-    int mPreyReproductionRadius       { 2 };
-    int mPredatorReproductiveCapacity { 10 };
-    int mPredatorReproductionRadius   { 2 };
-    int mFitnessRadius                { 3 };
-    int NEIGHBORHOOD_SIZE             { (2 * mFitnessRadius + 1) * (2 * mFitnessRadius + 1) - 1 };
+    LocalCaPso(const LocalCaPso& other, uint64_t stream);
 
-    // PSO parameters
-    int mPredatorInitialSwarmSize       { 3 };
-    int mPredatorMigrationTime          { 5 };
-    int mPredatorMigrationCount         { 0 };
-    float mPredatorInitialInertiaWeight { 0.9f };
-    float mPredatorFinalInertiaWeight   { 0.2f };
-    const float INERTIA_STEP            { (mPredatorInitialInertiaWeight - mPredatorFinalInertiaWeight) /
-                                            mPredatorMigrationTime };
+    // Model hooks
+    void moveParticles();
+    void wrapOffspring(int& row, int& col);
 };
 
 #endif // CAPSO_H
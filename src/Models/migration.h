@@ -0,0 +1,218 @@
+#ifndef MIGRATION_H
+#define MIGRATION_H
+
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// The particles of a swarm as contiguous arrays for the arithmetic of a
+// migration step: velocity blend, speed clamp and toroidal wrap. The loops of
+// move() have neither branches nor calls, so the compiler turns them into SIMD
+// code, while drawing the random factors and resolving the occupancy of the
+// destinations stay serial in the callers. Real is the type of the random
+// factors, which fixes the precision of the blend.
+template<class Real>
+class MigrationBatch
+{
+public:
+    void resize(size_t size);
+    size_t size() const { return mSize; }
+
+    // Particle i, its best known position and the best position known by
+    // the others, with the random factors of its step
+    void set(size_t i, int row, int col, int velocityRow, int velocityCol,
+             int cognitiveRow, int cognitiveCol, int socialRow, int socialCol,
+             Real r1, Real r2);
+
+    // Velocities at or above the squared speed threshold stop the particle,
+    // as the speed clamp of the original models, see speedThreshold()
+    void move(int width, int height, float inertiaWeight, float cognitiveFactor,
+              float socialFactor, int maxSpeed, int squaredSpeedThreshold);
+
+    // Results of move()
+    int velocityRow(size_t i) const { return mVelocityRow[i]; }
+    int velocityCol(size_t i) const { return mVelocityCol[i]; }
+    int row(size_t i) const { return mNextRow[i]; }
+    int col(size_t i) const { return mNextCol[i]; }
+
+private:
+    size_t mSize { 0 };
+
+    std::vector<int> mRow, mCol;
+    std::vector<int> mVelocityRow, mVelocityCol;
+    std::vector<int> mCognitiveRow, mCognitiveCol;
+    std::vector<int> mSocialRow, mSocialCol;
+    std::vector<Real> mR1, mR2;
+
+    std::vector<int> mNextRow, mNextCol;
+
+    static void blend(size_t size, const int* row, const int* col,
+                      const int* cognitiveRow, const int* cognitiveCol,
+                      const int* socialRow, const int* socialCol,
+                      const Real* r1, const Real* r2,
+                      int* velocityRow, int* velocityCol, int* nextRow, int* nextCol,
+                      int width, int height, float inertiaWeight, float cognitiveFactor,
+                      float socialFactor, int squaredSpeedThreshold);
+};
+
+// Smallest squared speed, a sum of two squared integers, for which the given
+// comparison of the speed with the maximum holds. The comparison is passed
+// in, so that the threshold reproduces the exact rounding of the speed a
+// model computes, and must be monotonic in the squared speed.
+template<class Exceeds>
+int speedThreshold(int maxSpeed, Exceeds exceeds)
+{
+    if(maxSpeed < 0)
+    {
+        return 0;
+    }
+
+    // The threshold is about maxSpeed^2 + 1, bisect around it
+    int64_t low = 0;
+    int64_t high = (static_cast<int64_t>(maxSpeed) + 1) * (maxSpeed + 1);
+
+    if(high >= INT_MAX)
+    {
+        return INT_MAX;
+    }
+
+    while(low < high)
+    {
+        int64_t middle = low + (high - low) / 2;
+
+        if(exceeds(static_cast<int>(middle)))
+        {
+            high = middle;
+        }
+        else
+        {
+            low = middle + 1;
+        }
+    }
+
+    return static_cast<int>(low);
+}
+
+template<class Real>
+void MigrationBatch<Real>::resize(size_t size)
+{
+    mSize = size;
+
+    for(std::vector<int>* array : { &mRow, &mCol, &mVelocityRow, &mVelocityCol,
+                                    &mCognitiveRow, &mCognitiveCol, &mSocialRow,
+                                    &mSocialCol, &mNextRow, &mNextCol })
+    {
+        array->resize(size);
+    }
+
+    mR1.resize(size);
+    mR2.resize(size);
+}
+
+template<class Real>
+void MigrationBatch<Real>::set(size_t i, int row, int col, int velocityRow, int velocityCol,
+                               int cognitiveRow, int cognitiveCol, int socialRow, int socialCol,
+                               Real r1, Real r2)
+{
+    mRow[i] = row;
+    mCol[i] = col;
+    mVelocityRow[i] = velocityRow;
+    mVelocityCol[i] = velocityCol;
+    mCognitiveRow[i] = cognitiveRow;
+    mCognitiveCol[i] = cognitiveCol;
+    mSocialRow[i] = socialRow;
+    mSocialCol[i] = socialCol;
+    mR1[i] = r1;
+    mR2[i] = r2;
+}
+
+template<class Real>
+void MigrationBatch<Real>::move(int width, int height, float inertiaWeight,
+                                float cognitiveFactor, float socialFactor,
+                                int maxSpeed, int squaredSpeedThreshold)
+{
+    // The arrays never overlap, which the compiler can only be told through
+    // the parameters of a function
+    blend(mSize, mRow.data(), mCol.data(), mCognitiveRow.data(), mCognitiveCol.data(),
+          mSocialRow.data(), mSocialCol.data(), mR1.data(), mR2.data(),
+          mVelocityRow.data(), mVelocityCol.data(), mNextRow.data(), mNextCol.data(),
+          width, height, inertiaWeight, cognitiveFactor, socialFactor, squaredSpeedThreshold);
+
+    int* nextRow = mNextRow.data();
+    int* nextCol = mNextCol.data();
+
+    // A step shorter than the lattice leaves it by less than its size, the
+    // modulo is only needed otherwise
+    if(maxSpeed < width && maxSpeed < height)
+    {
+        for(size_t i = 0; i < mSize; i++)
+        {
+            int r = nextRow[i];
+            int c = nextCol[i];
+
+            nextRow[i] = r < 0 ? r + height : (r >= height ? r - height : r);
+            nextCol[i] = c < 0 ? c + width : (c >= width ? c - width : c);
+        }
+    }
+    else
+    {
+        for(size_t i = 0; i < mSize; i++)
+        {
+            nextRow[i] = (height + nextRow[i]) % height;
+            nextCol[i] = (width + nextCol[i]) % width;
+        }
+    }
+}
+
+template<class Real>
+void MigrationBatch<Real>::blend(size_t size,
+                                 const int* __restrict row, const int* __restrict col,
+                                 const int* __restrict cognitiveRow, const int* __restrict cognitiveCol,
+                                 const int* __restrict socialRow, const int* __restrict socialCol,
+                                 const Real* __restrict r1, const Real* __restrict r2,
+                                 int* __restrict velocityRow, int* __restrict velocityCol,
+                                 int* __restrict nextRow, int* __restrict nextCol,
+                                 int width, int height, float inertiaWeight, float cognitiveFactor,
+                                 float socialFactor, int squaredSpeedThreshold)
+{
+    const int halfWidth = width / 2;
+    const int halfHeight = height / 2;
+
+    // Shortest vector on the torus, the branches of validateVector() as
+    // selects
+    auto shortest = [](int d, int size, int half)
+    {
+        return d > half ? d - size : (d < -half ? d + size : d);
+    };
+
+    for(size_t i = 0; i < size; i++)
+    {
+        int currentVelRow = shortest(velocityRow[i], height, halfHeight);
+        int currentVelCol = shortest(velocityCol[i], width, halfWidth);
+        int cognitiveVelRow = shortest(cognitiveRow[i] - row[i], height, halfHeight);
+        int cognitiveVelCol = shortest(cognitiveCol[i] - col[i], width, halfWidth);
+        int socialVelRow = shortest(socialRow[i] - row[i], height, halfHeight);
+        int socialVelCol = shortest(socialCol[i] - col[i], width, halfWidth);
+
+        // Same operations in the same order as the scalar code
+        int velRow = (int)(inertiaWeight * currentVelRow +
+            cognitiveFactor * r1[i] * cognitiveVelRow +
+            socialFactor * r2[i] * socialVelRow);
+        int velCol = (int)(inertiaWeight * currentVelCol +
+            cognitiveFactor * r1[i] * cognitiveVelCol +
+            socialFactor * r2[i] * socialVelCol);
+
+        // Too fast a particle stops
+        bool tooFast = velRow * velRow + velCol * velCol >= squaredSpeedThreshold;
+        velRow = tooFast ? 0 : velRow;
+        velCol = tooFast ? 0 : velCol;
+
+        velocityRow[i] = velRow;
+        velocityCol[i] = velCol;
+        nextRow[i] = row[i] + velRow;
+        nextCol[i] = col[i] + velCol;
+    }
+}
+
+#endif // MIGRATION_H
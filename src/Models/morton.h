@@ -0,0 +1,42 @@
+#ifndef MORTON_H
+#define MORTON_H
+
+#include <cstdint>
+
+// Z-order (Morton) indices, the bits of the row and the column interleaved
+// with the row on the odd bits, thus nearby cells get nearby indices
+
+// Spreads the bits of value over the even bits of the result
+inline uint64_t spreadBits(uint32_t value)
+{
+    uint64_t x = value;
+
+    x = (x | (x << 16)) & 0x0000ffff0000ffffULL;
+    x = (x | (x << 8))  & 0x00ff00ff00ff00ffULL;
+    x = (x | (x << 4))  & 0x0f0f0f0f0f0f0f0fULL;
+    x = (x | (x << 2))  & 0x3333333333333333ULL;
+    x = (x | (x << 1))  & 0x5555555555555555ULL;
+
+    return x;
+}
+
+// Gathers the even bits of value, the inverse of spreadBits()
+inline uint32_t compactBits(uint64_t value)
+{
+    uint64_t x = value & 0x5555555555555555ULL;
+
+    x = (x | (x >> 1))  & 0x3333333333333333ULL;
+    x = (x | (x >> 2))  & 0x0f0f0f0f0f0f0f0fULL;
+    x = (x | (x >> 4))  & 0x00ff00ff00ff00ffULL;
+    x = (x | (x >> 8))  & 0x0000ffff0000ffffULL;
+    x = (x | (x >> 16)) & 0x00000000ffffffffULL;
+
+    return static_cast<uint32_t>(x);
+}
+
+inline uint64_t mortonIndex(uint32_t row, uint32_t col)
+{
+    return (spreadBits(row) << 1) | spreadBits(col);
+}
+
+#endif // MORTON_H
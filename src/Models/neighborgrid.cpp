@@ -0,0 +1,38 @@
+#include "neighborgrid.h"
+
+void NeighborGrid::reset(int width, int height, int bucketSize)
+{
+    mWidth = width;
+    mHeight = height;
+    mBucketSize = std::max(bucketSize, 1);
+    mRows = (height + mBucketSize - 1) / mBucketSize;
+    mColumns = (width + mBucketSize - 1) / mBucketSize;
+
+    mStart.assign(mRows * mColumns + 1, 0);
+    mPoints.clear();
+}
+
+void NeighborGrid::build(const std::vector<LatticePoint>& points)
+{
+    // Counting sort of the points by bucket
+    std::fill(mStart.begin(), mStart.end(), 0);
+
+    for(const LatticePoint& point : points)
+    {
+        mStart[bucket(point.row, point.col) + 1]++;
+    }
+
+    for(size_t b = 1; b < mStart.size(); b++)
+    {
+        mStart[b] += mStart[b - 1];
+    }
+
+    mPoints.resize(points.size());
+
+    mNext.assign(mStart.begin(), mStart.end() - 1);
+
+    for(const LatticePoint& point : points)
+    {
+        mPoints[mNext[bucket(point.row, point.col)]++] = point;
+    }
+}
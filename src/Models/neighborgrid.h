@@ -0,0 +1,81 @@
+#ifndef NEIGHBORGRID_H
+#define NEIGHBORGRID_H
+
+#include <algorithm>
+#include <vector>
+#include "latticepoint.h"
+
+// Uniform grid of buckets over a toroidal lattice holding a set of points.
+// A query visits the points of the buckets that overlap a square window,
+// so its cost follows the number of points around rather than the area of
+// the window. The buckets may hold points outside of the window, callers
+// filter them.
+class NeighborGrid
+{
+public:
+    // Buckets of bucketSize x bucketSize cells, the last row and column of
+    // buckets are smaller when the size does not divide the lattice
+    void reset(int width, int height, int bucketSize);
+
+    // Replaces the points of the grid
+    void build(const std::vector<LatticePoint>& points);
+
+    // Calls visit(point) for every point in the buckets overlapping the
+    // window of the given radius around (row, col)
+    template<class Visit>
+    void forEachNear(int row, int col, int radius, Visit visit) const;
+
+    // 0 until the first reset
+    int bucketSize() const { return mBucketSize; }
+
+private:
+    int bucket(int row, int col) const
+    {
+        return mColumns * (row / mBucketSize) + col / mBucketSize;
+    }
+
+    int mWidth { 0 };
+    int mHeight { 0 };
+    int mBucketSize { 0 };
+    int mRows { 0 };
+    int mColumns { 0 };
+
+    // Points sorted by bucket, the points of bucket b are in
+    // [mStart[b], mStart[b + 1])
+    std::vector<int> mStart;
+    std::vector<LatticePoint> mPoints;
+
+    // Next free position of every bucket while building
+    std::vector<int> mNext;
+};
+
+template<class Visit>
+void NeighborGrid::forEachNear(int row, int col, int radius, Visit visit) const
+{
+    // Walk the window one bucket at a time, the first and last buckets of
+    // each direction are only partly inside
+    for(int r = row - radius; r <= row + radius;)
+    {
+        int absRow = (mHeight + r % mHeight) % mHeight;
+        int rowSpan = std::min((absRow / mBucketSize + 1) * mBucketSize, mHeight) - absRow;
+
+        for(int c = col - radius; c <= col + radius;)
+        {
+            int absCol = (mWidth + c % mWidth) % mWidth;
+            int colSpan = std::min((absCol / mBucketSize + 1) * mBucketSize, mWidth) - absCol;
+
+            int b = bucket(absRow, absCol);
+
+            for(int i = mStart[b]; i < mStart[b + 1]; i++)
+            {
+                visit(mPoints[i]);
+            }
+
+            c += colSpan;
+        }
+
+        r += rowSpan;
+    }
+}
+
+#endif // NEIGHBORGRID_H
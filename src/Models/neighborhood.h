@@ -0,0 +1,46 @@
+#ifndef NEIGHBORHOOD_H
+#define NEIGHBORHOOD_H
+
+#include <vector>
+#include "latticelayout.h"
+#include "torus.h"
+
+// Update the prey density of every neighbor of the cell (row, col) within
+// the given radius after a prey was born (death = false) or died in it. The
+// lattice is a torus, so the neighborhood wraps around the edges as wrap
+// tells, see torus.h.
+template<class Wrap>
+void notifyNeighborhood(std::vector<unsigned char>& densities,
+                        const LatticeLayout& layout, const Wrap& wrap,
+                        int row, int col, int radius, bool death)
+{
+    int finalRow, finalCol;
+
+    for(int nRow = row - radius; nRow <= row + radius; nRow++)
+    {
+        finalRow = wrap.row(nRow);
+
+        unsigned char* densityRow = densities.data() + layout.rowOffset(finalRow);
+
+        for(int nCol = col - radius; nCol <= col + radius; nCol++)
+        {
+            if(nRow == row && nCol == col)
+            {
+                continue;
+            }
+
+            finalCol = wrap.col(nCol);
+
+            if(death)
+            {
+                densityRow[layout.colOffset(finalCol)]--;
+            }
+            else
+            {
+                densityRow[layout.colOffset(finalCol)]++;
+            }
+        }
+    }
+}
+
+#endif // NEIGHBORHOOD_H
@@ -9,6 +9,9 @@ struct Particle
     LatticePoint bestPosition;
     LatticePoint velocity;
     unsigned int timeSinceLastMeal;
+
+    // Index of the particle in the global best tracking of GlobalCaPso
+    int slot = { -1 };
 };
 
 #endif // PARTICLE_H
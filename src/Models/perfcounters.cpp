@@ -0,0 +1,167 @@
+#include "perfcounters.h"
+
+#ifdef __linux__
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+namespace
+{
+    int openEvent(uint32_t type, uint64_t config)
+    {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        // Only count user space so an unprivileged process can use them
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+
+        return static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+
+    uint64_t cacheMisses(uint64_t cache)
+    {
+        return cache |
+               (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+               (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    }
+}
+#endif
+
+PerfCounters::PerfCounters()
+{
+    mDescriptors.fill(-1);
+    mStart.fill(Reading());
+
+#ifdef __linux__
+    mDescriptors[CYCLES] = openEvent(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+    mDescriptors[INSTRUCTIONS] = openEvent(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+    mDescriptors[L1D_MISSES] = openEvent(PERF_TYPE_HW_CACHE, cacheMisses(PERF_COUNT_HW_CACHE_L1D));
+    mDescriptors[LLC_MISSES] = openEvent(PERF_TYPE_HW_CACHE, cacheMisses(PERF_COUNT_HW_CACHE_LL));
+    mDescriptors[BRANCH_MISSES] = openEvent(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+#endif
+}
+
+PerfCounters::~PerfCounters()
+{
+#ifdef __linux__
+    for(int descriptor : mDescriptors)
+    {
+        if(descriptor != -1)
+        {
+            close(descriptor);
+        }
+    }
+#endif
+}
+
+bool PerfCounters::available() const
+{
+    for(int event = 0; event < NUMBER_OF_EVENTS; event++)
+    {
+        if(available(static_cast<Event>(event)))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool PerfCounters::available(Event event) const
+{
+    return mDescriptors[event] != -1;
+}
+
+PerfCounters::Readings PerfCounters::readRaw() const
+{
+    Readings readings;
+    readings.fill(Reading());
+
+#ifdef __linux__
+    for(int event = 0; event < NUMBER_OF_EVENTS; event++)
+    {
+        // The value, the time enabled and the time running
+        uint64_t data[3];
+
+        if(mDescriptors[event] == -1 ||
+           ::read(mDescriptors[event], data, sizeof(data)) != sizeof(data))
+        {
+            continue;
+        }
+
+        readings[event] = { data[0], data[1], data[2] };
+    }
+#endif
+
+    return readings;
+}
+
+PerfCounters::Values PerfCounters::read() const
+{
+    Readings readings = readRaw();
+    Values values;
+
+    for(int event = 0; event < NUMBER_OF_EVENTS; event++)
+    {
+        values[event] = scale(Reading(), readings[event]);
+    }
+
+    return values;
+}
+
+void PerfCounters::start()
+{
+    mStart = readRaw();
+}
+
+PerfCounters::Values PerfCounters::stop() const
+{
+    Readings readings = readRaw();
+    Values values;
+
+    // Scaling each total on its own would use a different share of running
+    // time at start and stop, whose difference can turn negative
+    for(int event = 0; event < NUMBER_OF_EVENTS; event++)
+    {
+        values[event] = scale(mStart[event], readings[event]);
+    }
+
+    return values;
+}
+
+uint64_t PerfCounters::scale(const Reading& begin, const Reading& end)
+{
+    if(end.value <= begin.value || end.running <= begin.running)
+    {
+        return 0;
+    }
+
+    uint64_t value = end.value - begin.value;
+    uint64_t running = end.running - begin.running;
+    uint64_t enabled = end.enabled > begin.enabled ? end.enabled - begin.enabled : 0;
+
+    if(enabled <= running)
+    {
+        return value;
+    }
+
+    return static_cast<uint64_t>(static_cast<double>(value) * enabled / running);
+}
+
+const char* PerfCounters::eventName(Event event)
+{
+    static const char* names[] = { "cycles", "instructions", "L1dMisses",
+                                   "LLCMisses", "branchMisses" };
+
+    return names[event];
+}
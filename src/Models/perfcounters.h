@@ -0,0 +1,61 @@
+#ifndef PERFCOUNTERS_H
+#define PERFCOUNTERS_H
+
+#include <array>
+#include <cstdint>
+
+// Hardware performance counters of the calling thread, read through
+// perf_event_open on Linux. The events that the kernel or the hardware do not
+// allow (e.g., inside virtual machines or with a strict perf_event_paranoid)
+// are left out, and on other systems no event is available at all.
+class PerfCounters
+{
+public:
+    enum Event { CYCLES, INSTRUCTIONS, L1D_MISSES, LLC_MISSES, BRANCH_MISSES,
+                 NUMBER_OF_EVENTS };
+
+    typedef std::array<uint64_t, NUMBER_OF_EVENTS> Values;
+
+    // Raw count of an event, and the times it was enabled and actually
+    // counting, which differ when the kernel multiplexes the counters
+    struct Reading
+    {
+        uint64_t value;
+        uint64_t enabled;
+        uint64_t running;
+    };
+
+    typedef std::array<Reading, NUMBER_OF_EVENTS> Readings;
+
+    // Counting starts right away for the thread that creates the object
+    PerfCounters();
+    ~PerfCounters();
+
+    bool available() const;
+    bool available(Event event) const;
+
+    // Current value of every event, scaled when the kernel had to multiplex
+    // the counters. Unavailable events read as zero.
+    Values read() const;
+
+    // Remember the current readings, stop() then returns the events since then
+    void start();
+    Values stop() const;
+
+    // Events between two readings, the raw difference scaled by the share of
+    // that interval in which the counter ran, never negative
+    static uint64_t scale(const Reading& begin, const Reading& end);
+
+    static const char* eventName(Event event);
+
+private:
+    PerfCounters(const PerfCounters&);
+    PerfCounters& operator=(const PerfCounters&);
+
+    Readings readRaw() const;
+
+    std::array<int, NUMBER_OF_EVENTS> mDescriptors;
+    Readings mStart;
+};
+
+#endif // PERFCOUNTERS_H
@@ -25,12 +25,53 @@ RandomNumber::RandomNumber()
     }
 }
 
+void RandomNumber::seed(uint64_t seed, uint64_t stream)
+{
+    mRNG = std::make_unique<pcg32>(seed, stream);
+    mRealDistribution.reset();
+}
+
 float RandomNumber::GetRandomFloat()
 {
+    CAPSO_PROFILE(mDraws++);
+
     return mRealDistribution(*mRNG);
 }
 
+void RandomNumber::fill(float* values, size_t count)
+{
+    CAPSO_PROFILE(mDraws += count);
+
+    for(size_t i = 0; i < count; i++)
+    {
+        values[i] = mRealDistribution(*mRNG);
+    }
+}
+
 int RandomNumber::GetRandomInt(int min, int max)
 {
+    CAPSO_PROFILE(mDraws++);
+
     return std::uniform_int_distribution<int>{min, max}(*mRNG);
 }
+
+RandomNumber::RandomNumber(const RandomNumber& other, uint64_t stream)
+    : mRealDistribution(0.0, 1.0)
+{
+    // Derive the seed of the new generator from the current state of the
+    // other one without advancing it, then mix in the stream number so that
+    // generators forked with different streams neither share their state nor
+    // their increment.
+    pcg32 parent(*other.mRNG);
+
+    uint64_t seed = static_cast<uint64_t>(parent()) << 32;
+    seed |= parent();
+    seed += stream * 0x9e3779b97f4a7c15ULL;
+
+    // splitmix64 finalizer
+    seed = (seed ^ (seed >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    seed = (seed ^ (seed >> 27)) * 0x94d049bb133111ebULL;
+    seed = seed ^ (seed >> 31);
+
+    mRNG = std::make_unique<pcg32>(seed, stream);
+}
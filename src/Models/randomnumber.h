@@ -4,18 +4,30 @@
 #include <memory>
 #include <random>
 #include "pcg_random.hpp"
+#include "stageprofile.h"
 
 class RandomNumber
 {
 public:
     RandomNumber();
+    RandomNumber(const RandomNumber& other, uint64_t stream);
+
+    // Restart the sequence from a fixed seed, so that runs can be reproduced
+    void seed(uint64_t seed, uint64_t stream = 0);
 
     float GetRandomFloat();
+
+    // The next count values of GetRandomFloat() at once
+    void fill(float* values, size_t count);
     int GetRandomInt(int min, int max);
 
+    // Number of values drawn, only counted when profiling is enabled
+    uint64_t draws() const { return mDraws; }
+
 private:
     std::unique_ptr<pcg32> mRNG;
     std::uniform_real_distribution<float> mRealDistribution;
+    uint64_t mDraws { 0 };
 };
 
 #endif // RANDOMNUMBER_H
@@ -0,0 +1,221 @@
+#include <algorithm>
+#include <cmath>
+#include "runningstatistics.h"
+
+void RunningStatistics::add(double value)
+{
+    mCount++;
+
+    double delta = value - mMean;
+    mMean += delta / mCount;
+    mM2 += delta * (value - mMean);
+
+    mMin = mCount == 1 ? value : std::min(mMin, value);
+    mMax = mCount == 1 ? value : std::max(mMax, value);
+}
+
+void RunningStatistics::merge(const RunningStatistics& other)
+{
+    if(other.mCount == 0)
+    {
+        return;
+    }
+
+    if(mCount == 0)
+    {
+        *this = other;
+        return;
+    }
+
+    // Chan et al. update of the combined sum of squared differences
+    int64_t count = mCount + other.mCount;
+    double delta = other.mMean - mMean;
+
+    mMean += delta * other.mCount / count;
+    mM2 += other.mM2 + delta * delta * mCount * other.mCount / count;
+    mCount = count;
+
+    mMin = std::min(mMin, other.mMin);
+    mMax = std::max(mMax, other.mMax);
+}
+
+int64_t RunningStatistics::count() const
+{
+    return mCount;
+}
+
+double RunningStatistics::mean() const
+{
+    return mMean;
+}
+
+double RunningStatistics::variance() const
+{
+    return mCount > 1 ? mM2 / (mCount - 1) : 0.0;
+}
+
+double RunningStatistics::standardDeviation() const
+{
+    return std::sqrt(variance());
+}
+
+double RunningStatistics::min() const
+{
+    return mMin;
+}
+
+double RunningStatistics::max() const
+{
+    return mMax;
+}
+
+P2Quantile::P2Quantile(double probability)
+    : mProbability(probability)
+{
+    for(int i = 0; i < 5; i++)
+    {
+        mHeights[i] = 0.0;
+        mPositions[i] = i;
+        mDesired[i] = 0.0;
+    }
+
+    mIncrements[0] = 0.0;
+    mIncrements[1] = probability / 2.0;
+    mIncrements[2] = probability;
+    mIncrements[3] = (1.0 + probability) / 2.0;
+    mIncrements[4] = 1.0;
+}
+
+void P2Quantile::add(double value)
+{
+    if(mCount < EXACT_COUNT)
+    {
+        mValues.insert(std::upper_bound(mValues.begin(), mValues.end(), value), value);
+        mCount++;
+        return;
+    }
+
+    if(mCount == EXACT_COUNT)
+    {
+        startMarkers();
+    }
+
+    mCount++;
+    moveMarkers(value);
+}
+
+void P2Quantile::startMarkers()
+{
+    // Markers at the sample quantiles of the kept values, at least a
+    // position apart
+    int last = static_cast<int>(mValues.size()) - 1;
+
+    for(int i = 0; i < 5; i++)
+    {
+        mDesired[i] = mIncrements[i] * last;
+
+        int position = static_cast<int>(std::lround(mDesired[i]));
+        position = std::max(position, i == 0 ? 0 : static_cast<int>(mPositions[i - 1]) + 1);
+        position = std::min(position, last - (4 - i));
+
+        mPositions[i] = position;
+        mHeights[i] = mValues[position];
+    }
+
+    std::vector<double>().swap(mValues);
+}
+
+void P2Quantile::moveMarkers(double value)
+{
+    // Cell of the new value, extending the extreme markers if needed
+    int k;
+
+    if(value < mHeights[0])
+    {
+        mHeights[0] = value;
+        k = 0;
+    }
+    else if(value >= mHeights[4])
+    {
+        mHeights[4] = value;
+        k = 3;
+    }
+    else
+    {
+        k = std::upper_bound(mHeights, mHeights + 5, value) - mHeights - 1;
+    }
+
+    for(int i = k + 1; i < 5; i++)
+    {
+        mPositions[i] += 1.0;
+    }
+
+    for(int i = 0; i < 5; i++)
+    {
+        mDesired[i] += mIncrements[i];
+    }
+
+    // Move the middle markers towards their desired positions
+    for(int i = 1; i < 4; i++)
+    {
+        double d = mDesired[i] - mPositions[i];
+
+        if((d >= 1.0 && mPositions[i + 1] - mPositions[i] > 1.0) ||
+           (d <= -1.0 && mPositions[i - 1] - mPositions[i] < -1.0))
+        {
+            int step = d > 0.0 ? 1 : -1;
+            double height = parabolic(i, step);
+
+            if(mHeights[i - 1] < height && height < mHeights[i + 1])
+            {
+                mHeights[i] = height;
+            }
+            else
+            {
+                mHeights[i] = linear(i, step);
+            }
+
+            mPositions[i] += step;
+        }
+    }
+}
+
+int64_t P2Quantile::count() const
+{
+    return mCount;
+}
+
+double P2Quantile::value() const
+{
+    if(mCount == 0)
+    {
+        return 0.0;
+    }
+
+    if(mCount > EXACT_COUNT)
+    {
+        return mHeights[2];
+    }
+
+    // Interpolated quantile of the sorted values
+    double position = mProbability * (mCount - 1);
+    int below = static_cast<int>(position);
+    int above = std::min<int>(below + 1, mCount - 1);
+
+    return mValues[below] + (position - below) * (mValues[above] - mValues[below]);
+}
+
+double P2Quantile::parabolic(int i, int d) const
+{
+    const double* q = mHeights;
+    const double* n = mPositions;
+
+    return q[i] + d / (n[i + 1] - n[i - 1]) *
+           ((n[i] - n[i - 1] + d) * (q[i + 1] - q[i]) / (n[i + 1] - n[i]) +
+            (n[i + 1] - n[i] - d) * (q[i] - q[i - 1]) / (n[i] - n[i - 1]));
+}
+
+double P2Quantile::linear(int i, int d) const
+{
+    return mHeights[i] + d * (mHeights[i + d] - mHeights[i]) / (mPositions[i + d] - mPositions[i]);
+}
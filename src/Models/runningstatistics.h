@@ -0,0 +1,68 @@
+#ifndef RUNNINGSTATISTICS_H
+#define RUNNINGSTATISTICS_H
+
+#include <cstdint>
+#include <vector>
+
+// Mean and variance of a stream of values in constant memory (Welford's
+// algorithm). Two instances can be merged, e.g., one per thread.
+class RunningStatistics
+{
+public:
+    void add(double value);
+    void merge(const RunningStatistics& other);
+
+    int64_t count() const;
+    double mean() const;
+
+    // Unbiased sample variance, 0 for less than two values
+    double variance() const;
+    double standardDeviation() const;
+
+    double min() const;
+    double max() const;
+
+private:
+    int64_t mCount { 0 };
+    double mMean   { 0.0 };
+    double mM2     { 0.0 };
+    double mMin    { 0.0 };
+    double mMax    { 0.0 };
+};
+
+// Quantile of a stream of values. The first EXACT_COUNT values are kept and
+// interpolated exactly, beyond them the quantile is estimated in constant
+// memory by the P² algorithm of Jain and Chlamtac (1985), with the markers
+// starting at the sample quantiles of the kept values.
+class P2Quantile
+{
+public:
+    static const int EXACT_COUNT = 100;
+
+    explicit P2Quantile(double probability = 0.5);
+
+    void add(double value);
+
+    int64_t count() const;
+    double value() const;
+
+private:
+    void startMarkers();
+    void moveMarkers(double value);
+    double parabolic(int i, int d) const;
+    double linear(int i, int d) const;
+
+    double mProbability;
+    int64_t mCount { 0 };
+
+    // Sorted values while there are at most EXACT_COUNT of them
+    std::vector<double> mValues;
+
+    // Heights and positions of the five markers, and the desired positions
+    double mHeights[5];
+    double mPositions[5];
+    double mDesired[5];
+    double mIncrements[5];
+};
+
+#endif // RUNNINGSTATISTICS_H
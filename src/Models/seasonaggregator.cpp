@@ -0,0 +1,123 @@
+#include <algorithm>
+#include "seasonaggregator.h"
+
+SeasonAggregator::SeasonAggregator(int numberOfSeasons)
+{
+    mSeasons.resize(numberOfSeasons);
+
+    for(Season& season : mSeasons)
+    {
+        for(auto& quantiles : season.quantiles)
+        {
+            for(int quantile = 0; quantile < NUMBER_OF_QUANTILES; quantile++)
+            {
+                quantiles[quantile] = P2Quantile(quantileProbability(quantile));
+            }
+        }
+    }
+}
+
+int SeasonAggregator::add(const std::vector<SeasonRecord>& replicate)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    for(const SeasonRecord& record : replicate)
+    {
+        if(record.season < 0 || record.season >= static_cast<int>(mSeasons.size()))
+        {
+            continue;
+        }
+
+        add(mSeasons[record.season], record);
+    }
+
+    // Carry the state of a replicate that stopped into the remaining seasons
+    if(!replicate.empty())
+    {
+        SeasonRecord last = replicate.back();
+
+        for(int season = std::max(last.season + 1, 0); season < static_cast<int>(mSeasons.size());
+            season++)
+        {
+            last.season = season;
+            add(mSeasons[season], last);
+        }
+    }
+
+    return ++mNumberOfReplicates;
+}
+
+void SeasonAggregator::add(Season& season, const SeasonRecord& record)
+{
+    double values[NUMBER_OF_METRICS];
+    values[PREYS]                      = record.preys;
+    values[PREDATORS]                  = record.predators;
+    values[PREY_BIRTH_RATE]            = record.preyBirthRate;
+    values[PREDATOR_BIRTH_RATE]        = record.predatorBirthRate;
+    values[PREDATOR_DEATH_PROBABILITY] = record.predatorDeathProbability;
+    values[PREY_DEATH_PROBABILITY]     = record.preyDeathProbability;
+
+    for(int metric = 0; metric < NUMBER_OF_METRICS; metric++)
+    {
+        season.statistics[metric].add(values[metric]);
+
+        for(P2Quantile& quantile : season.quantiles[metric])
+        {
+            quantile.add(values[metric]);
+        }
+    }
+
+    season.preyExtinctions += record.preys == 0 ? 1 : 0;
+    season.predatorExtinctions += record.predators == 0 ? 1 : 0;
+}
+
+int SeasonAggregator::numberOfSeasons() const
+{
+    return mSeasons.size();
+}
+
+int SeasonAggregator::numberOfReplicates() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    return mNumberOfReplicates;
+}
+
+const RunningStatistics& SeasonAggregator::statistics(int season, Metric metric) const
+{
+    return mSeasons[season].statistics[metric];
+}
+
+double SeasonAggregator::quantile(int season, Metric metric, Quantile quantile) const
+{
+    return mSeasons[season].quantiles[metric][quantile].value();
+}
+
+double SeasonAggregator::preyExtinction(int season) const
+{
+    int64_t count = mSeasons[season].statistics[PREYS].count();
+
+    return count > 0 ? static_cast<double>(mSeasons[season].preyExtinctions) / count : 0.0;
+}
+
+double SeasonAggregator::predatorExtinction(int season) const
+{
+    int64_t count = mSeasons[season].statistics[PREYS].count();
+
+    return count > 0 ? static_cast<double>(mSeasons[season].predatorExtinctions) / count : 0.0;
+}
+
+const char* SeasonAggregator::metricName(int metric)
+{
+    static const char* names[] = { "Preys", "Predators", "PreyBirthRate", "PredatorBirthRate",
+                                   "PredatorDeathProbability", "PreyDeathProbability" };
+
+    return names[metric];
+}
+
+double SeasonAggregator::quantileProbability(int quantile)
+{
+    static const double probabilities[] = { 0.05, 0.5, 0.95 };
+
+    return probabilities[quantile];
+}
@@ -0,0 +1,67 @@
+#ifndef SEASONAGGREGATOR_H
+#define SEASONAGGREGATOR_H
+
+#include <array>
+#include <mutex>
+#include <vector>
+#include "runningstatistics.h"
+#include "seasonrecord.h"
+
+// Merges the seasons of many replicates as they finish: mean, variance and
+// quantiles of every metric per season, and the fraction of replicates in
+// which each species is extinct. A replicate that stopped early counts in
+// every later season with its last state, so that every season has all the
+// replicates. add() may be called from several threads.
+class SeasonAggregator
+{
+public:
+    enum Metric
+    {
+        PREYS,
+        PREDATORS,
+        PREY_BIRTH_RATE,
+        PREDATOR_BIRTH_RATE,
+        PREDATOR_DEATH_PROBABILITY,
+        PREY_DEATH_PROBABILITY,
+        NUMBER_OF_METRICS
+    };
+
+    // Quantiles estimated for every metric
+    enum Quantile { Q05, MEDIAN, Q95, NUMBER_OF_QUANTILES };
+
+    explicit SeasonAggregator(int numberOfSeasons);
+
+    // Returns the number of replicates added so far, this one included
+    int add(const std::vector<SeasonRecord>& replicate);
+
+    int numberOfSeasons() const;
+    int numberOfReplicates() const;
+
+    const RunningStatistics& statistics(int season, Metric metric) const;
+    double quantile(int season, Metric metric, Quantile quantile) const;
+
+    // Fraction of the replicates without preys (predators) at a season
+    double preyExtinction(int season) const;
+    double predatorExtinction(int season) const;
+
+    static const char* metricName(int metric);
+    static double quantileProbability(int quantile);
+
+private:
+    struct Season
+    {
+        std::array<RunningStatistics, NUMBER_OF_METRICS> statistics;
+        std::array<std::array<P2Quantile, NUMBER_OF_QUANTILES>, NUMBER_OF_METRICS> quantiles;
+        int preyExtinctions { 0 };
+        int predatorExtinctions { 0 };
+    };
+
+    void add(Season& season, const SeasonRecord& record);
+
+    std::vector<Season> mSeasons;
+    int mNumberOfReplicates { 0 };
+
+    mutable std::mutex mMutex;
+};
+
+#endif // SEASONAGGREGATOR_H
@@ -0,0 +1,21 @@
+#ifndef SEASONRECORD_H
+#define SEASONRECORD_H
+
+// Populations and rates at the start of a season, a row of the results
+// files of a batch
+struct SeasonRecord
+{
+    int   season;
+    int   preys;
+    int   predators;
+    int   preyCountBeforeReproduction;
+    float preyBirthRate;
+    int   predatorCountBeforeReproduction;
+    float predatorBirthRate;
+    int   preyCountBeforePredatorDeath;
+    float predatorDeathProbability;
+    int   predatorCountBeforePreyDeath;
+    float preyDeathProbability;
+};
+
+#endif // SEASONRECORD_H
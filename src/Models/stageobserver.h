@@ -0,0 +1,63 @@
+#ifndef STAGEOBSERVER_H
+#define STAGEOBSERVER_H
+
+// The stages of the CA-PSO models in the order they run
+struct CaPsoStage
+{
+    enum Stage { COMPETITION, MIGRATION, REPRODUCTION_OF_PREDATORS,
+                 DEATH_OF_PREDATORS, DEATH_OF_PREYS, REPRODUCTION_OF_PREYS };
+};
+
+// Populations when a stage begins or ends, taken by the stage itself
+struct StageCounts
+{
+    int stage;
+    int preys;
+    int predators;
+};
+
+// Observers are given to nextGen() and advanceSeasons() as a template
+// parameter and called directly by the stages, an observer only needs the
+// two methods below. NullObserver compiles to nothing and is the default.
+struct NullObserver
+{
+    void stageBegin(const StageCounts&) {}
+    void stageEnd(const StageCounts&) {}
+};
+
+// Keeps the populations before the stages the results of a season report
+class SeasonCounter : public NullObserver
+{
+public:
+    void stageBegin(const StageCounts& counts)
+    {
+        switch(counts.stage)
+        {
+        case CaPsoStage::REPRODUCTION_OF_PREDATORS:
+            mPredatorCountBeforeReproduction = counts.predators;
+            break;
+        case CaPsoStage::DEATH_OF_PREDATORS:
+            mPreyCountBeforePredatorDeath = counts.preys;
+            break;
+        case CaPsoStage::DEATH_OF_PREYS:
+            mPredatorCountBeforePreyDeath = counts.predators;
+            break;
+        case CaPsoStage::REPRODUCTION_OF_PREYS:
+            mPreyCountBeforeReproduction = counts.preys;
+            break;
+        }
+    }
+
+    int preyCountBeforeReproduction() const { return mPreyCountBeforeReproduction; }
+    int predatorCountBeforeReproduction() const { return mPredatorCountBeforeReproduction; }
+    int preyCountBeforePredatorDeath() const { return mPreyCountBeforePredatorDeath; }
+    int predatorCountBeforePreyDeath() const { return mPredatorCountBeforePreyDeath; }
+
+private:
+    int mPreyCountBeforeReproduction     { 0 };
+    int mPredatorCountBeforeReproduction { 0 };
+    int mPreyCountBeforePredatorDeath    { 0 };
+    int mPredatorCountBeforePreyDeath    { 0 };
+};
+
+#endif // STAGEOBSERVER_H
@@ -0,0 +1,37 @@
+#ifndef STAGEPROFILE_H
+#define STAGEPROFILE_H
+
+#include <cstdint>
+
+// Built-in instrumentation of the model stages. It is compiled in only when
+// CAPSO_PROFILING is defined (cmake -DENABLE_PROFILING=ON), otherwise the
+// statements wrapped by CAPSO_PROFILE vanish and the profiles stay empty.
+#ifdef CAPSO_PROFILING
+#define CAPSO_PROFILE(statement) statement
+#else
+#define CAPSO_PROFILE(statement)
+#endif
+
+// Accumulated cost of one stage of the model
+struct StageProfile
+{
+    uint64_t calls         { 0 };
+    double   seconds       { 0.0 };
+    uint64_t cellsVisited  { 0 };
+    uint64_t randomDraws   { 0 };
+    uint64_t notifyCalls   { 0 };
+    uint64_t births        { 0 };
+    uint64_t deaths        { 0 };
+    uint64_t particleMoves { 0 };
+};
+
+inline constexpr bool profilingEnabled()
+{
+#ifdef CAPSO_PROFILING
+    return true;
+#else
+    return false;
+#endif
+}
+
+#endif // STAGEPROFILE_H
@@ -0,0 +1,103 @@
+#include <algorithm>
+#include "stoprule.h"
+
+namespace
+{
+    // Range of the values relative to their mean
+    double relativeChange(const std::deque<int>& values)
+    {
+        auto range = std::minmax_element(values.begin(), values.end());
+
+        double mean = 0.0;
+
+        for(int value : values)
+        {
+            mean += value;
+        }
+
+        mean /= values.size();
+
+        return (*range.second - *range.first) / std::max(mean, 1.0);
+    }
+}
+
+StopRule::StopRule(bool predatorExtinction, bool preyExtinction,
+                   int steadyStateWindow, double steadyStateThreshold)
+    : mPredatorExtinction(predatorExtinction),
+      mPreyExtinction(preyExtinction),
+      mSteadyStateWindow(std::max(0, steadyStateWindow)),
+      mSteadyStateThreshold(steadyStateThreshold)
+{
+}
+
+StopRule::Reason StopRule::update(int season, int preys, int predators)
+{
+    if(mReason != NONE)
+    {
+        return mReason;
+    }
+
+    if(mPredatorExtinction && predators == 0)
+    {
+        mReason = PREDATOR_EXTINCTION;
+    }
+    else if(mPreyExtinction && preys == 0)
+    {
+        mReason = PREY_EXTINCTION;
+    }
+    else if(mSteadyStateWindow > 0)
+    {
+        mPreys.push_back(preys);
+        mPredators.push_back(predators);
+
+        if(static_cast<int>(mPreys.size()) > mSteadyStateWindow)
+        {
+            mPreys.pop_front();
+            mPredators.pop_front();
+        }
+
+        if(static_cast<int>(mPreys.size()) == mSteadyStateWindow &&
+           relativeChange(mPreys) < mSteadyStateThreshold &&
+           relativeChange(mPredators) < mSteadyStateThreshold)
+        {
+            mReason = STEADY_STATE;
+        }
+    }
+
+    if(mReason != NONE)
+    {
+        mStopSeason = season;
+    }
+
+    return mReason;
+}
+
+void StopRule::reset()
+{
+    mReason = NONE;
+    mStopSeason = -1;
+    mPreys.clear();
+    mPredators.clear();
+}
+
+bool StopRule::enabled() const
+{
+    return mPredatorExtinction || mPreyExtinction || mSteadyStateWindow > 0;
+}
+
+StopRule::Reason StopRule::reason() const
+{
+    return mReason;
+}
+
+int StopRule::stopSeason() const
+{
+    return mStopSeason;
+}
+
+const char* StopRule::reasonName(Reason reason)
+{
+    static const char* names[] = { "None", "PredatorExtinction", "PreyExtinction", "SteadyState" };
+
+    return names[reason];
+}
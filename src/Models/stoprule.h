@@ -0,0 +1,44 @@
+#ifndef STOPRULE_H
+#define STOPRULE_H
+
+#include <deque>
+
+// Decides when a simulation can stop before its last season: when predators
+// or preys die out, or when both populations change less than a relative
+// threshold over a window of seasons. update() is called with the
+// populations at the start of every season.
+class StopRule
+{
+public:
+    enum Reason { NONE, PREDATOR_EXTINCTION, PREY_EXTINCTION, STEADY_STATE };
+
+    // A window of 0 seasons disables the steady state rule
+    StopRule(bool predatorExtinction = false, bool preyExtinction = false,
+             int steadyStateWindow = 0, double steadyStateThreshold = 0.0);
+
+    // Returns the reason to stop at this season, NONE to go on
+    Reason update(int season, int preys, int predators);
+
+    void reset();
+
+    bool enabled() const;
+    Reason reason() const;
+    int stopSeason() const;
+
+    static const char* reasonName(Reason reason);
+
+private:
+    bool mPredatorExtinction;
+    bool mPreyExtinction;
+    int mSteadyStateWindow;
+    double mSteadyStateThreshold;
+
+    Reason mReason { NONE };
+    int mStopSeason { -1 };
+
+    // Populations of the last seasons of the window
+    std::deque<int> mPreys;
+    std::deque<int> mPredators;
+};
+
+#endif // STOPRULE_H
@@ -1,5 +1,7 @@
 #include <algorithm>
+#include <cstdint>
 #include <memory>
+#include "morton.h"
 #include "swarm.h"
 
 using std::for_each;
@@ -13,7 +15,7 @@ Swarm::Swarm(float cognitiveFactor, float socialFactor, float inertiaWeight,
              std::vector<unsigned char> &lattice,
              std::vector<unsigned char> &densities,
              std::vector<unsigned char> &temp,
-             int width, int height, int particleState, RandomNumber &random)
+             const LatticeLayout& layout, int particleState, RandomNumber &random)
     : mCognitiveFactor(cognitiveFactor),
       mSocialFactor(socialFactor),
       mInertiaWeight(inertiaWeight),
@@ -22,19 +24,55 @@ Swarm::Swarm(float cognitiveFactor, float socialFactor, float inertiaWeight,
       mLattice(lattice),
       mDensities(densities),
       mTemp(temp),
-      mWidth(width),
-      mHeight(height),
+      mLayout(layout),
+      mWidth(layout.width()),
+      mHeight(layout.height()),
       mParticleState(particleState),
-      mRandom(random)
+      mRandom(random),
+      mMaskWrap(isPowerOfTwo(mWidth) && isPowerOfTwo(mHeight))
 {
 
 }
 
+Swarm::Swarm(const Swarm& other,
+             std::vector<unsigned char>& lattice,
+             std::vector<unsigned char>& densities,
+             std::vector<unsigned char>& temp,
+             const LatticeLayout& layout,
+             RandomNumber& random)
+    : mCognitiveFactor(other.mCognitiveFactor),
+      mSocialFactor(other.mSocialFactor),
+      mInertiaWeight(other.mInertiaWeight),
+      mMaxSpeed(other.mMaxSpeed),
+      mSocialRadius(other.mSocialRadius),
+      mLattice(lattice),
+      mDensities(densities),
+      mTemp(temp),
+      mLayout(layout),
+      mWidth(other.mWidth),
+      mHeight(other.mHeight),
+      mParticleState(other.mParticleState),
+      mRandom(random),
+      mNeighborSearch(other.mNeighborSearch),
+      mMaskWrap(other.mMaskWrap)
+{
+    // Particles are shared pointers, copy the pointees so that both swarms
+    // can evolve independently
+    for(const auto& p : other.mParticles)
+    {
+        mParticles.push_back(make_shared<Particle>(*p));
+    }
+}
 
 Swarm::~Swarm()
 {
 }
 
+void Swarm::setGenericWrap(bool generic)
+{
+    mMaskWrap = !generic && isPowerOfTwo(mWidth) && isPowerOfTwo(mHeight);
+}
+
 list<shared_ptr<Particle>>::iterator Swarm::begin()
 {
     return mParticles.begin();
@@ -96,34 +134,40 @@ void Swarm::initialize(unsigned int size)
 
 void Swarm::nextGen()
 {
-    auto validateVector = [this] (int& row, int& col)
+    copy(mLattice.begin(), mLattice.end(), mTemp.begin());
+
+    mBatch.resize(mParticles.size());
+
+    // The grid finds each neighbor once, the same as the scan as long as the
+    // neighborhood does not wrap onto itself
+    int side = 2 * mSocialRadius + 1;
+    bool useGrid = mNeighborSearch == GRID && side <= mWidth && side <= mHeight;
+
+    if(useGrid)
     {
-        if(abs(row) > mHeight / 2)
+        // Cells marked in the copy of the lattice, which is what the scan
+        // reads. Particles sharing a cell may have lost their mark.
+        mOccupied.clear();
+
+        for(const auto& p : mParticles)
         {
-            if(row < 0)
+            if(mTemp[mLayout.address(p->position.row, p->position.col)] & mParticleState)
             {
-                row = row + mHeight;
-            }
-            else
-            {
-                row = row - mHeight;
+                mOccupied.push_back(p->position);
             }
         }
 
-        if(abs(col) > mWidth / 2)
+        if(mGrid.bucketSize() != mSocialRadius + 1)
         {
-            if(col < 0)
-            {
-                col = col + mWidth;
-            }
-            else
-            {
-                col = col - mWidth;
-            }
+            mGrid.reset(mWidth, mHeight, mSocialRadius + 1);
         }
-    };
 
-    copy(mLattice.begin(), mLattice.end(), mTemp.begin());
+        mGrid.build(mOccupied);
+    }
+
+    // Gather the particles and the best position among their neighbors,
+    // drawing the random factors in the order of the swarm
+    size_t i = 0;
 
     for_each(mParticles.begin(), mParticles.end(),
              [&, this](weak_ptr<Particle> wp)
@@ -133,109 +177,77 @@ void Swarm::nextGen()
             int pRow = p->position.row;
             int pCol = p->position.col;
 
-            int bestRow = pRow;
-            int bestCol = pCol;
-
-            int bestAddress = mWidth * bestRow + bestCol;
+            LatticePoint best;
 
-            // Clear the previous position of the predator
-            mLattice[bestAddress] &= ~mParticleState;
-
-            // Get the best position among the neighbors of the particle
-            for(int nRow = pRow - mSocialRadius; nRow <= pRow + mSocialRadius; nRow++)
+            if(useGrid)
             {
-                for(int nCol = pCol - mSocialRadius; nCol <= pCol + mSocialRadius; nCol++)
-                {
-                    // Ignore the particle at the center of the neighborhood
-                    if(nRow == pRow && nCol == pCol)
-                    {
-                        continue;
-                    }
-
-                    // Obtain the absolute position of the neighbour
-                    int absRow = (mHeight + nRow) % mHeight;
-                    int absCol = (mWidth + nCol) % mWidth;
-
-                    int neighbourAddress = mWidth * absRow + absCol;
-
-                    // Is the neighbor a particle?
-                    if(mTemp[neighbourAddress] & mParticleState)
-                    {
-                        // Yes, then compare its fitness with the fitness of our
-                        // current position. Is it better?
-                        if(mDensities[bestAddress] < mDensities[neighbourAddress])
-                        {
-                            // Yes, update the best known position
-                            bestRow = absRow;
-                            bestCol = absCol;
-
-                            bestAddress = neighbourAddress;
-                        }
-                    }
-                }
+                best = gridSocialBest(pRow, pCol);
+            }
+            else if(mMaskWrap)
+            {
+                best = scanSocialBest(pRow, pCol, MaskWrap(mWidth, mHeight));
+            }
+            else
+            {
+                best = scanSocialBest(pRow, pCol, ModuloWrap(mWidth, mHeight));
             }
 
             float r1 = mRandom.GetRandomFloat();
             float r2 = mRandom.GetRandomFloat();
 
-            int currentVelRow = p->velocity.row;
-            int currentVelCol = p->velocity.col;
-
-            validateVector(currentVelRow, currentVelCol);
-
-            int cognitiveVelRow = p->bestPosition.row - pRow;
-            int cognitiveVelCol = p->bestPosition.col - pCol;
-
-            validateVector(cognitiveVelRow, cognitiveVelCol);
-
-            int socialVelRow = bestRow - pRow;
-            int socialVelCol = bestCol - pCol;
+            mBatch.set(i++, pRow, pCol, p->velocity.row, p->velocity.col,
+                       p->bestPosition.row, p->bestPosition.col, best.row, best.col,
+                       r1, r2);
+        }
+    });
 
-            validateVector(socialVelRow, socialVelCol);
+    mBatch.resize(i);
 
-            // Get the new velocity
-            int velRow = (int)(mInertiaWeight * currentVelRow +
-                mCognitiveFactor * r1 * cognitiveVelRow +
-                mSocialFactor * r2 * socialVelRow);
+    // Get the new velocities and positions of the whole swarm at once
+    int threshold = speedThreshold(mMaxSpeed, [this](int squaredSpeed)
+    {
+        float speed = sqrt((float)squaredSpeed);
 
-            int velCol = (int)(mInertiaWeight * currentVelCol +
-                mCognitiveFactor * r1 * cognitiveVelCol +
-                mSocialFactor * r2 * socialVelCol);
+        return speed > mMaxSpeed;
+    });
 
-            // Adjust speed
-            float speed = sqrt((float)(velRow * velRow + velCol * velCol));
+    mBatch.move(mWidth, mHeight, mInertiaWeight, mCognitiveFactor, mSocialFactor,
+                mMaxSpeed, threshold);
 
-            while(speed > mMaxSpeed)
-            {
-                velRow *= (int)(0.9);
-                velCol *= (int)(0.9);
+    // Resolve the destinations in the order of the swarm
+    i = 0;
 
-                speed = sqrt((float)(velRow * velRow + velCol * velCol));
-            }
+    for_each(mParticles.begin(), mParticles.end(),
+             [&, this](weak_ptr<Particle> wp)
+    {
+        if(auto p = wp.lock())
+        {
+            int pRow = p->position.row;
+            int pCol = p->position.col;
 
-            // Move the particle
-            int posRow = pRow + velRow;
-            int posCol = pCol + velCol;
+            int posRow = mBatch.row(i);
+            int posCol = mBatch.col(i);
 
-            // Adjust position
-            posRow = (mHeight + posRow) % mHeight;
-            posCol = (mWidth + posCol) % mWidth;
+            // Clear the previous position of the predator
+            mLattice[mLayout.address(pRow, pCol)] &= ~mParticleState;
 
             // Is the destination already occupied?
-            if(!(mLattice[mWidth * posRow + posCol] & mParticleState))
+            if(!(mLattice[mLayout.address(posRow, posCol)] & mParticleState))
             {
                 // No, then update the particle's position
                 p->position.row = posRow;
                 p->position.col = posCol;
-                p->velocity.row = velRow;
-                p->velocity.col = velCol;
+                p->velocity.row = mBatch.velocityRow(i);
+                p->velocity.col = mBatch.velocityCol(i);
+
+                CAPSO_PROFILE(mMoves++);
 
                 // Render the particle at its new position
-                mLattice[mWidth * posRow + posCol] |= mParticleState;
+                mLattice[mLayout.address(posRow, posCol)] |= mParticleState;
 
                 // If necessary, update the particle's best known position
-                if(mDensities[mWidth * p->bestPosition.row + p->bestPosition.col] <
-                    mDensities[mWidth * posRow + posCol])
+                if(mDensities[mLayout.address(p->bestPosition.row, p->bestPosition.col)] <
+                    mDensities[mLayout.address(posRow, posCol)])
                 {
                     p->bestPosition.row = posRow;
                     p->bestPosition.col = posCol;
@@ -244,17 +256,146 @@ void Swarm::nextGen()
             else
             {
                 // Restore the particle's previous position
-                mLattice[mWidth * pRow + pCol] |= mParticleState;
+                mLattice[mLayout.address(pRow, pCol)] |= mParticleState;
             }
+
+            i++;
         }
     });
 }
 
+template<class Wrap>
+LatticePoint Swarm::scanSocialBest(int pRow, int pCol, const Wrap& wrap)
+{
+    LatticePoint best;
+    best.row = pRow;
+    best.col = pCol;
+
+    int bestAddress = mLayout.address(pRow, pCol);
+
+    CAPSO_PROFILE(mCellsVisited += (2 * mSocialRadius + 1) * (2 * mSocialRadius + 1));
+
+    // Get the best position among the neighbors of the particle
+    for(int nRow = pRow - mSocialRadius; nRow <= pRow + mSocialRadius; nRow++)
+    {
+        for(int nCol = pCol - mSocialRadius; nCol <= pCol + mSocialRadius; nCol++)
+        {
+            // Ignore the particle at the center of the neighborhood
+            if(nRow == pRow && nCol == pCol)
+            {
+                continue;
+            }
+
+            // Obtain the absolute position of the neighbour
+            int absRow = wrap.row(nRow);
+            int absCol = wrap.col(nCol);
+
+            int neighbourAddress = mLayout.address(absRow, absCol);
+
+            // Is the neighbor a particle?
+            if(mTemp[neighbourAddress] & mParticleState)
+            {
+                // Yes, then compare its fitness with the fitness of our
+                // current position. Is it better?
+                if(mDensities[bestAddress] < mDensities[neighbourAddress])
+                {
+                    // Yes, update the best known position
+                    best.row = absRow;
+                    best.col = absCol;
+
+                    bestAddress = neighbourAddress;
+                }
+            }
+        }
+    }
+
+    return best;
+}
+
+LatticePoint Swarm::gridSocialBest(int pRow, int pCol)
+{
+    LatticePoint best;
+    best.row = pRow;
+    best.col = pCol;
+
+    int bestAddress = mLayout.address(pRow, pCol);
+
+    // Position of the best neighbor in the order of the scan, -1 while no
+    // neighbor beats the particle itself
+    int bestRank = -1;
+
+    const int side = 2 * mSocialRadius + 1;
+
+    // Offset of a coordinate from the center, below -radius for a cell out
+    // of the neighborhood
+    auto offset = [this](int d, int size)
+    {
+        d = d < 0 ? d + size : d;
+        return d > mSocialRadius ? d - size : d;
+    };
+
+    mGrid.forEachNear(pRow, pCol, mSocialRadius, [&](const LatticePoint& neighbor)
+    {
+        CAPSO_PROFILE(mCellsVisited++);
+
+        int dRow = offset(neighbor.row - pRow, mHeight);
+        int dCol = offset(neighbor.col - pCol, mWidth);
+
+        if(dRow < -mSocialRadius || dCol < -mSocialRadius || (dRow == 0 && dCol == 0))
+        {
+            return;
+        }
+
+        int neighbourAddress = mLayout.address(neighbor.row, neighbor.col);
+        int rank = side * (dRow + mSocialRadius) + dCol + mSocialRadius;
+
+        // The scan keeps the first of the densest neighbors, provided it is
+        // better than the particle's own position
+        if(mDensities[bestAddress] < mDensities[neighbourAddress] ||
+           (bestRank >= 0 && mDensities[bestAddress] == mDensities[neighbourAddress] &&
+            rank < bestRank))
+        {
+            best = neighbor;
+            bestAddress = neighbourAddress;
+            bestRank = rank;
+        }
+    });
+
+    return best;
+}
+
 void Swarm::add(list<shared_ptr<Particle>>& newParticles)
 {
     mParticles.insert(mParticles.end(), newParticles.begin(), newParticles.end());
 }
 
+void Swarm::sortByPosition()
+{
+    std::vector<std::pair<uint64_t, shared_ptr<Particle>>> sorted;
+    sorted.reserve(mParticles.size());
+
+    for(const auto& p : mParticles)
+    {
+        sorted.push_back({ mortonIndex(p->position.row, p->position.col), p });
+    }
+
+    std::stable_sort(sorted.begin(), sorted.end(),
+                     [](const std::pair<uint64_t, shared_ptr<Particle>>& a,
+                        const std::pair<uint64_t, shared_ptr<Particle>>& b)
+    {
+        return a.first < b.first;
+    });
+
+    // Allocate the particles again in their new order, so that walking the
+    // swarm also walks memory forward
+    mParticles.clear();
+
+    for(const auto& entry : sorted)
+    {
+        mParticles.push_back(make_shared<Particle>(*entry.second));
+    }
+}
+
 list<shared_ptr<Particle>, std::allocator<shared_ptr<Particle>>>::iterator Swarm::erase(list<shared_ptr<Particle>,
         std::allocator<shared_ptr<Particle>>>::iterator it)
 {
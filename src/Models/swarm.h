@@ -4,18 +4,36 @@
 #include <list>
 #include <random>
 #include <memory>
+#include "latticelayout.h"
+#include "migration.h"
+#include "neighborgrid.h"
 #include "particle.h"
 #include "randomnumber.h"
+#include "torus.h"
 
 class Swarm
 {
 public:
+    // How a migration finds the particles around each particle: scanning
+    // the whole social neighborhood, or through a grid of buckets holding
+    // the particles. Both find the same best neighbor, the grid is used
+    // whenever the neighborhood does not wrap onto itself.
+    enum NeighborSearch { SCAN, GRID };
+
     Swarm(float cognitiveFactor, float socialFactor, float inertiaWeight,
           int maxSpeed, int socialRadius,
           std::vector<unsigned char>& lattice,
           std::vector<unsigned char>& densities,
           std::vector<unsigned char> &temp,
-          int width, int height, int particleState, RandomNumber& random);
+          const LatticeLayout& layout, int particleState, RandomNumber& random);
+
+    // Deep copy of another swarm bound to a new set of containers
+    Swarm(const Swarm& other,
+          std::vector<unsigned char>& lattice,
+          std::vector<unsigned char>& densities,
+          std::vector<unsigned char>& temp,
+          const LatticeLayout& layout,
+          RandomNumber& random);
 
     ~Swarm();
 
@@ -31,6 +49,14 @@ public:
     void setMaxSpeed(int speed) { mMaxSpeed = speed; }
     void setSocialRadius(int radius) { mSocialRadius = radius; }
 
+    NeighborSearch neighborSearch() const { return mNeighborSearch; }
+    void setNeighborSearch(NeighborSearch search) { mNeighborSearch = search; }
+
+    // Wrap with bit masks on lattices whose sides are powers of two, see
+    // CellularAutomaton::setGenericWrap()
+    bool maskWrap() const { return mMaskWrap; }
+    void setGenericWrap(bool generic);
+
     std::list<std::shared_ptr<Particle>>::iterator begin();
     std::list<std::shared_ptr<Particle>>::iterator end();
 
@@ -39,12 +65,30 @@ public:
 
     void add(std::list<std::shared_ptr<Particle>>& newParticles);
 
+    // Reorder the particles by the Morton index of their positions, keeping
+    // the order of particles sharing a cell. The particles are copied into
+    // new storage, so iterators and pointers to them are invalidated.
+    void sortByPosition();
+
     std::list<std::shared_ptr<Particle>, std::allocator<std::shared_ptr<Particle>>>::iterator erase(std::list<std::shared_ptr<Particle>,
         std::allocator<std::shared_ptr<Particle>>>::iterator it);
 
     bool empty() const;
 
+    // Number of successful moves, only counted when profiling is enabled
+    uint64_t moves() const { return mMoves; }
+
+    // Number of cells read by the neighbor searches, only counted when
+    // profiling is enabled
+    uint64_t cellsVisited() const { return mCellsVisited; }
+
 private:
+    // Best position among the particles around (row, col), the position
+    // itself if none is better
+    template<class Wrap>
+    LatticePoint scanSocialBest(int row, int col, const Wrap& wrap);
+    LatticePoint gridSocialBest(int row, int col);
+
     std::list<std::shared_ptr<Particle>> mParticles;
 
     float mCognitiveFactor;
@@ -57,10 +101,22 @@ private:
     std::vector<unsigned char>& mDensities;
     std::vector<unsigned char>& mTemp;
 
+    const LatticeLayout& mLayout;
     int mWidth;
     int mHeight;
     int mParticleState;
     RandomNumber& mRandom;
+
+    NeighborSearch mNeighborSearch { GRID };
+    bool mMaskWrap;
+
+    // Scratch arrays of a migration step
+    MigrationBatch<float> mBatch;
+    NeighborGrid mGrid;
+    std::vector<LatticePoint> mOccupied;
+
+    uint64_t mMoves { 0 };
+    uint64_t mCellsVisited { 0 };
 };
 
 #endif // SWARM_H
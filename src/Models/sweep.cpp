@@ -0,0 +1,161 @@
+#include <cmath>
+#include "sweep.h"
+
+bool Sweep::addValues(const std::string& field, const std::vector<double>& values)
+{
+    if(!isField(field) || values.empty())
+    {
+        return false;
+    }
+
+    mParameters.push_back({ field, values });
+
+    return true;
+}
+
+bool Sweep::addRange(const std::string& field, double first, double last, double step)
+{
+    if(step <= 0.0 || last < first)
+    {
+        return false;
+    }
+
+    std::vector<double> values;
+
+    // Computed from the index rather than accumulated so that the last value
+    // is not lost to rounding, e.g., 0.1 to 0.3 by 0.1
+    int count = static_cast<int>(std::floor((last - first) / step + 1e-9)) + 1;
+
+    for(int i = 0; i < count; i++)
+    {
+        values.push_back(first + i * step);
+    }
+
+    return addValues(field, values);
+}
+
+int Sweep::numberOfParameters() const
+{
+    return mParameters.size();
+}
+
+const std::string& Sweep::parameterName(int parameter) const
+{
+    return mParameters[parameter].field;
+}
+
+int Sweep::numberOfPoints() const
+{
+    int points = 1;
+
+    for(const Parameter& parameter : mParameters)
+    {
+        points *= parameter.values.size();
+    }
+
+    return points;
+}
+
+std::vector<double> Sweep::pointValues(int point) const
+{
+    std::vector<double> values(mParameters.size());
+
+    for(int i = mParameters.size() - 1; i >= 0; i--)
+    {
+        int count = mParameters[i].values.size();
+
+        values[i] = mParameters[i].values[point % count];
+        point /= count;
+    }
+
+    return values;
+}
+
+CaPsoSettings Sweep::settings(const CaPsoSettings& base, int point) const
+{
+    CaPsoSettings settings = base;
+    std::vector<double> values = pointValues(point);
+
+    for(size_t i = 0; i < mParameters.size(); i++)
+    {
+        setField(settings, mParameters[i].field, values[i]);
+    }
+
+    return settings;
+}
+
+bool Sweep::isField(const std::string& field)
+{
+    CaPsoSettings settings;
+
+    return setField(settings, field, 0.0);
+}
+
+bool Sweep::setField(CaPsoSettings& settings, const std::string& field, double value)
+{
+    // Integer fields are rounded, ranges of doubles may land just below them
+    int integer = static_cast<int>(std::lround(value));
+
+    if(field == "initialNumberOfPreys")
+    {
+        settings.initialPreyDensity = value;
+    }
+    else if(field == "competitionFactor")
+    {
+        settings.competitionFactor = value;
+    }
+    else if(field == "preyReproductionRadius")
+    {
+        settings.preyReproductionRadius = integer;
+    }
+    else if(field == "preyReproductiveCapacity")
+    {
+        settings.preyReproductiveCapacity = integer;
+    }
+    else if(field == "fitnessRadius")
+    {
+        settings.fitnessRadius = integer;
+    }
+    else if(field == "initialNumberOfPredators")
+    {
+        settings.predatorInitialSwarmSize = integer;
+    }
+    else if(field == "predatorCognitiveFactor")
+    {
+        settings.predatorCognitiveFactor = value;
+    }
+    else if(field == "predatorSocialFactor")
+    {
+        settings.predatorSocialFactor = value;
+    }
+    else if(field == "predatorMaximumSpeed")
+    {
+        settings.predatorMaxSpeed = integer;
+    }
+    else if(field == "predatorReproductiveCapacity")
+    {
+        settings.predatorReproductiveCapacity = integer;
+    }
+    else if(field == "predatorReproductionRadius")
+    {
+        settings.predatorReproductionRadius = integer;
+    }
+    else if(field == "predatorSocialRadius")
+    {
+        settings.predatorSocialRadius = integer;
+    }
+    else if(field == "initialInertiaWeight")
+    {
+        settings.initialInertiaWeight = value;
+    }
+    else if(field == "finalInertiaWeight")
+    {
+        settings.finalInertiaWeight = value;
+    }
+    else
+    {
+        return false;
+    }
+
+    return true;
+}
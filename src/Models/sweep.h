@@ -0,0 +1,43 @@
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#include <string>
+#include <vector>
+#include "capsosettings.h"
+
+// Cartesian product of values of CaPsoSettings fields. Fields are named with
+// the keys of the settings files, e.g., "competitionFactor". Points are never
+// expanded in memory, point i is decoded from its index with the last
+// parameter varying fastest.
+class Sweep
+{
+public:
+    // Both return false if the field does not exist or there are no values
+    bool addValues(const std::string& field, const std::vector<double>& values);
+    bool addRange(const std::string& field, double first, double last, double step);
+
+    int numberOfParameters() const;
+    const std::string& parameterName(int parameter) const;
+
+    int numberOfPoints() const;
+
+    // Value of every parameter at the given point
+    std::vector<double> pointValues(int point) const;
+
+    // The base settings with the fields of the given point replaced
+    CaPsoSettings settings(const CaPsoSettings& base, int point) const;
+
+    static bool isField(const std::string& field);
+    static bool setField(CaPsoSettings& settings, const std::string& field, double value);
+
+private:
+    struct Parameter
+    {
+        std::string field;
+        std::vector<double> values;
+    };
+
+    std::vector<Parameter> mParameters;
+};
+
+#endif // SWEEP_H
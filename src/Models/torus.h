@@ -0,0 +1,39 @@
+#ifndef TORUS_H
+#define TORUS_H
+
+// Wrap of coordinates around the torus, for coordinates less than one side
+// off the lattice. The neighborhood loops take the wrap as template
+// parameter, thus the remainder is compiled into them.
+
+// Any side, a remainder
+class ModuloWrap
+{
+public:
+    ModuloWrap(int width, int height) : mWidth(width), mHeight(height) {}
+
+    int row(int row) const { return (mHeight + row) % mHeight; }
+    int col(int col) const { return (mWidth + col) % mWidth; }
+
+private:
+    int mWidth, mHeight;
+};
+
+// Sides that are powers of two, a bitwise and
+class MaskWrap
+{
+public:
+    MaskWrap(int width, int height) : mColMask(width - 1), mRowMask(height - 1) {}
+
+    int row(int row) const { return row & mRowMask; }
+    int col(int col) const { return col & mColMask; }
+
+private:
+    int mColMask, mRowMask;
+};
+
+inline bool isPowerOfTwo(int value)
+{
+    return value > 0 && !(value & (value - 1));
+}
+
+#endif // TORUS_H
@@ -0,0 +1,178 @@
+#include <cstdio>
+#include <fstream>
+#include "tracer.h"
+
+namespace
+{
+    std::string escape(const std::string& text)
+    {
+        std::string escaped;
+
+        for(char c : text)
+        {
+            if(c == '"' || c == '\\')
+            {
+                escaped += '\\';
+                escaped += c;
+            }
+            else if(static_cast<unsigned char>(c) < 0x20)
+            {
+                char code[8];
+                std::snprintf(code, sizeof(code), "\\u%04x", c);
+                escaped += code;
+            }
+            else
+            {
+                escaped += c;
+            }
+        }
+
+        return escaped;
+    }
+}
+
+Tracer::Tracer()
+    : mEnabled(false),
+      mGeneration(0),
+      mStart(std::chrono::steady_clock::now())
+{
+}
+
+Tracer& Tracer::instance()
+{
+    static Tracer tracer;
+
+    return tracer;
+}
+
+void Tracer::start()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    // Threads notice the new generation and register a new buffer
+    mBuffers.clear();
+    mStart = std::chrono::steady_clock::now();
+    mGeneration++;
+
+    mEnabled = true;
+}
+
+void Tracer::stop()
+{
+    mEnabled = false;
+}
+
+void Tracer::begin(const char* name, const char* category, int64_t index,
+                   const std::string& label)
+{
+    buffer().events.push_back({ name, category, 'B', now(), index, label });
+}
+
+void Tracer::end(const char* name, const char* category)
+{
+    buffer().events.push_back({ name, category, 'E', now(), -1, std::string() });
+}
+
+bool Tracer::write(const std::string& filename) const
+{
+    std::ofstream file(filename);
+
+    if(!file)
+    {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+    bool first = true;
+    char time[32];
+
+    for(const auto& buffer : mBuffers)
+    {
+        file << (first ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+             << buffer->thread << ",\"args\":{\"name\":\"Worker " << buffer->thread << "\"}}";
+        first = false;
+
+        for(const Event& event : buffer->events)
+        {
+            // Timestamps are in microseconds
+            std::snprintf(time, sizeof(time), "%.3f", event.time / 1000.0);
+
+            file << ",\n{\"name\":\"" << event.name << "\",\"cat\":\"" << event.category
+                 << "\",\"ph\":\"" << event.phase << "\",\"ts\":" << time
+                 << ",\"pid\":1,\"tid\":" << buffer->thread;
+
+            if(event.index >= 0 || !event.label.empty())
+            {
+                file << ",\"args\":{";
+
+                if(event.index >= 0)
+                {
+                    file << "\"index\":" << event.index << (event.label.empty() ? "" : ",");
+                }
+
+                if(!event.label.empty())
+                {
+                    file << "\"label\":\"" << escape(event.label) << "\"";
+                }
+
+                file << "}";
+            }
+
+            file << "}";
+        }
+    }
+
+    file << "\n]}\n";
+
+    return static_cast<bool>(file);
+}
+
+Tracer::Buffer& Tracer::buffer()
+{
+    thread_local Buffer* threadBuffer = nullptr;
+    thread_local int threadGeneration = -1;
+
+    int generation = mGeneration.load();
+
+    if(threadGeneration != generation)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        mBuffers.emplace_back(new Buffer());
+        mBuffers.back()->thread = static_cast<int>(mBuffers.size());
+
+        threadBuffer = mBuffers.back().get();
+        threadGeneration = generation;
+    }
+
+    return *threadBuffer;
+}
+
+int64_t Tracer::now() const
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - mStart).count();
+}
+
+Tracer::Scope::Scope(const char* name, const char* category, int64_t index,
+                     const std::string& label)
+    : mName(name),
+      mCategory(category),
+      mEnabled(Tracer::instance().enabled())
+{
+    if(mEnabled)
+    {
+        Tracer::instance().begin(name, category, index, label);
+    }
+}
+
+Tracer::Scope::~Scope()
+{
+    if(mEnabled)
+    {
+        Tracer::instance().end(mName, mCategory);
+    }
+}
@@ -0,0 +1,86 @@
+#ifndef TRACER_H
+#define TRACER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Records begin and end events of every thread into a timeline that can be
+// written as Chrome Trace Event JSON and opened in chrome://tracing or
+// Perfetto. Every thread appends to its own buffer, so recording takes no
+// lock, and nothing is recorded unless the tracer was started.
+class Tracer
+{
+public:
+    static Tracer& instance();
+
+    // Discard the previous timeline and start recording a new one. Neither
+    // start() nor write() may run while other threads are recording.
+    void start();
+    void stop();
+
+    bool enabled() const
+    {
+        return mEnabled.load(std::memory_order_relaxed);
+    }
+
+    // A negative index is left out of the event
+    void begin(const char* name, const char* category, int64_t index = -1,
+               const std::string& label = std::string());
+    void end(const char* name, const char* category);
+
+    bool write(const std::string& filename) const;
+
+    // Records a begin event when created and the end event when destroyed
+    class Scope
+    {
+    public:
+        Scope(const char* name, const char* category, int64_t index = -1,
+              const std::string& label = std::string());
+        ~Scope();
+
+    private:
+        Scope(const Scope&);
+        Scope& operator=(const Scope&);
+
+        const char* mName;
+        const char* mCategory;
+        bool mEnabled;
+    };
+
+private:
+    Tracer();
+
+    struct Event
+    {
+        const char* name;
+        const char* category;
+        char phase;
+        int64_t time;
+        int64_t index;
+        std::string label;
+    };
+
+    struct Buffer
+    {
+        int thread;
+        std::vector<Event> events;
+    };
+
+    Buffer& buffer();
+    int64_t now() const;
+
+    std::atomic<bool> mEnabled;
+    std::atomic<int> mGeneration;
+    std::chrono::steady_clock::time_point mStart;
+
+    // Only taken when a thread records its first event
+    mutable std::mutex mMutex;
+    std::vector<std::unique_ptr<Buffer>> mBuffers;
+};
+
+#endif // TRACER_H
@@ -0,0 +1,146 @@
+#ifndef TRAJECTORYFORMAT_H
+#define TRAJECTORYFORMAT_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Helpers shared by TrajectoryWriter and TrajectoryReader
+namespace trajectory
+{
+    const unsigned char MAGIC[8]     = { 'C', 'A', 'P', 'S', 'O', 'T', 'R', 'J' };
+    const unsigned char END_MAGIC[8] = { 'C', 'A', 'P', 'S', 'O', 'E', 'N', 'D' };
+
+    const uint32_t VERSION     = 1;
+    const size_t   HEADER_SIZE = 8 + 6 * 4;
+    const size_t   FOOTER_SIZE = 8 + 8;
+
+    enum FrameType : unsigned char { KEYFRAME, DELTA };
+
+    inline void putUint32(std::vector<unsigned char>& out, uint32_t value)
+    {
+        for(int i = 0; i < 4; i++)
+        {
+            out.push_back(static_cast<unsigned char>(value >> (8 * i)));
+        }
+    }
+
+    inline void putUint64(std::vector<unsigned char>& out, uint64_t value)
+    {
+        for(int i = 0; i < 8; i++)
+        {
+            out.push_back(static_cast<unsigned char>(value >> (8 * i)));
+        }
+    }
+
+    inline uint32_t getUint32(const unsigned char* in)
+    {
+        uint32_t value = 0;
+
+        for(int i = 0; i < 4; i++)
+        {
+            value |= static_cast<uint32_t>(in[i]) << (8 * i);
+        }
+
+        return value;
+    }
+
+    inline uint64_t getUint64(const unsigned char* in)
+    {
+        uint64_t value = 0;
+
+        for(int i = 0; i < 8; i++)
+        {
+            value |= static_cast<uint64_t>(in[i]) << (8 * i);
+        }
+
+        return value;
+    }
+
+    // Run length encoding, every run is stored as its length (LEB128 varint)
+    // followed by the repeated byte.
+    inline void encodeRuns(const unsigned char* data, size_t size,
+                           std::vector<unsigned char>& out)
+    {
+        size_t i = 0;
+
+        while(i < size)
+        {
+            unsigned char value = data[i];
+            size_t run = 1;
+
+            while(i + run < size && data[i + run] == value)
+            {
+                run++;
+            }
+
+            i += run;
+
+            while(run >= 0x80)
+            {
+                out.push_back(static_cast<unsigned char>(run | 0x80));
+                run >>= 7;
+            }
+
+            out.push_back(static_cast<unsigned char>(run));
+            out.push_back(value);
+        }
+    }
+
+    // Decode runs into out. If xorInto is set the decoded bytes are XORed
+    // with the contents of out, otherwise they replace them. Returns false if
+    // the payload is malformed.
+    inline bool decodeRuns(const unsigned char* data, size_t size,
+                           unsigned char* out, size_t outSize, bool xorInto)
+    {
+        size_t i = 0, position = 0;
+
+        while(i < size)
+        {
+            size_t run = 0;
+            int shift = 0;
+
+            while(i < size && (data[i] & 0x80))
+            {
+                run |= static_cast<size_t>(data[i++] & 0x7F) << shift;
+                shift += 7;
+            }
+
+            if(i + 1 >= size)
+            {
+                return false;
+            }
+
+            run |= static_cast<size_t>(data[i++]) << shift;
+            unsigned char value = data[i++];
+
+            if(position + run > outSize)
+            {
+                return false;
+            }
+
+            if(xorInto)
+            {
+                // Runs of zeros leave the previous frame untouched
+                if(value != 0)
+                {
+                    for(size_t k = 0; k < run; k++)
+                    {
+                        out[position + k] ^= value;
+                    }
+                }
+            }
+            else
+            {
+                std::fill(out + position, out + position + run, value);
+            }
+
+            position += run;
+        }
+
+        return position == outSize;
+    }
+}
+
+#endif // TRAJECTORYFORMAT_H
@@ -0,0 +1,203 @@
+#include <algorithm>
+#include "trajectoryplayer.h"
+
+using std::lock_guard;
+using std::mutex;
+using std::unique_lock;
+using std::vector;
+
+TrajectoryPlayer::TrajectoryPlayer(int readAhead)
+    : mReadAhead(std::max(1, readAhead))
+{
+}
+
+TrajectoryPlayer::~TrajectoryPlayer()
+{
+    close();
+}
+
+bool TrajectoryPlayer::open(const std::string& filename)
+{
+    close();
+
+    if(!mReader.open(filename))
+    {
+        return false;
+    }
+
+    mNextFrame = 0;
+    mDecoding = -1;
+    mRestarts = 0;
+    mFailed = false;
+    mStop = false;
+
+    mWorker = std::thread(&TrajectoryPlayer::run, this);
+
+    return true;
+}
+
+void TrajectoryPlayer::close()
+{
+    if(mWorker.joinable())
+    {
+        {
+            lock_guard<mutex> lock(mMutex);
+            mStop = true;
+        }
+
+        mWorkAvailable.notify_one();
+        mWorker.join();
+    }
+
+    mReader.close();
+    mFrames.clear();
+    mFreeBuffers.clear();
+}
+
+int TrajectoryPlayer::width() const
+{
+    return mReader.width();
+}
+
+int TrajectoryPlayer::height() const
+{
+    return mReader.height();
+}
+
+int TrajectoryPlayer::frameCount() const
+{
+    return mReader.frameCount();
+}
+
+int TrajectoryPlayer::generation(int frame) const
+{
+    return mReader.generation(frame);
+}
+
+bool TrajectoryPlayer::readFrame(int frame, unsigned char* lattice)
+{
+    if(!mWorker.joinable() || frame < 0 || frame >= frameCount())
+    {
+        return false;
+    }
+
+    unique_lock<mutex> lock(mMutex);
+
+    // The lowest frame decoded or being decoded, frames are decoded in order
+    int firstAvailable = !mFrames.empty() ? mFrames.front().index :
+                         mDecoding >= 0 ? mDecoding : mNextFrame;
+
+    // Restart decoding if the frame will not be reached by reading ahead
+    if(frame < firstAvailable || frame >= mNextFrame + mReadAhead)
+    {
+        while(!mFrames.empty())
+        {
+            recycleFront();
+        }
+
+        // The frame being decoded, if any, is discarded when it is done
+        mNextFrame = frame;
+        mDecoding = -1;
+        mRestarts++;
+        mFailed = false;
+    }
+
+    while(true)
+    {
+        // Frames preceding the requested one are not needed anymore
+        while(!mFrames.empty() && mFrames.front().index < frame)
+        {
+            recycleFront();
+        }
+
+        mWorkAvailable.notify_one();
+
+        if(!mFrames.empty() && mFrames.front().index == frame)
+        {
+            std::copy(mFrames.front().cells.begin(), mFrames.front().cells.end(),
+                      lattice);
+
+            recycleFront();
+
+            return true;
+        }
+
+        if(mFailed)
+        {
+            return false;
+        }
+
+        mFrameDecoded.wait(lock);
+    }
+}
+
+int TrajectoryPlayer::restarts() const
+{
+    lock_guard<mutex> lock(mMutex);
+
+    return mRestarts;
+}
+
+void TrajectoryPlayer::run()
+{
+    unique_lock<mutex> lock(mMutex);
+
+    while(true)
+    {
+        mWorkAvailable.wait(lock, [this]
+        {
+            return mStop || (!mFailed && mNextFrame < mReader.frameCount() &&
+                             static_cast<int>(mFrames.size()) < mReadAhead);
+        });
+
+        if(mStop)
+        {
+            break;
+        }
+
+        int frame = mNextFrame++;
+        int restarts = mRestarts;
+
+        vector<unsigned char> buffer;
+
+        if(!mFreeBuffers.empty())
+        {
+            buffer.swap(mFreeBuffers.back());
+            mFreeBuffers.pop_back();
+        }
+
+        buffer.resize(mReader.width() * mReader.height());
+
+        // Decode without holding the lock
+        mDecoding = frame;
+        lock.unlock();
+        bool decoded = mReader.readFrame(frame, buffer.data());
+        lock.lock();
+        mDecoding = -1;
+
+        if(restarts != mRestarts)
+        {
+            // The consumer jumped elsewhere while this frame was decoded
+            mFreeBuffers.push_back(std::move(buffer));
+            continue;
+        }
+
+        if(decoded)
+        {
+            mFrames.push_back(Frame { frame, std::move(buffer) });
+        }
+        else
+        {
+            mFreeBuffers.push_back(std::move(buffer));
+            mFailed = true;
+        }
+
+        mFrameDecoded.notify_one();
+    }
+}
+
+void TrajectoryPlayer::recycleFront()
+{
+    mFreeBuffers.push_back(std::move(mFrames.front().cells));
+    mFrames.pop_front();
+}
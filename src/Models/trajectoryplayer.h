@@ -0,0 +1,73 @@
+#ifndef TRAJECTORYPLAYER_H
+#define TRAJECTORYPLAYER_H
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "trajectoryreader.h"
+
+// Streams the frames of a trajectory file. A background thread decodes the
+// frames that follow the last one requested, so that playing forward at any
+// speed only copies frames that are already decoded. Requesting a frame
+// outside of the read-ahead window restarts decoding from that frame.
+class TrajectoryPlayer
+{
+public:
+    explicit TrajectoryPlayer(int readAhead = 32);
+
+    ~TrajectoryPlayer();
+
+    bool open(const std::string& filename);
+    void close();
+
+    int width() const;
+    int height() const;
+    int frameCount() const;
+    int generation(int frame) const;
+
+    // Copy the given frame into lattice, blocks until it has been decoded
+    bool readFrame(int frame, unsigned char* lattice);
+
+    // Times decoding was restarted since the file was opened
+    int restarts() const;
+
+private:
+    TrajectoryPlayer(const TrajectoryPlayer&);
+    TrajectoryPlayer& operator=(const TrajectoryPlayer&);
+
+private:
+    struct Frame
+    {
+        int index;
+        std::vector<unsigned char> cells;
+    };
+
+    void run();
+    void recycleFront();
+
+    // Only the worker thread accesses the reader once it has started
+    TrajectoryReader mReader;
+    int mReadAhead;
+
+    std::deque<Frame> mFrames;
+    std::vector<std::vector<unsigned char>> mFreeBuffers;
+
+    // Next frame to be decoded by the worker, the one it is decoding (-1
+    // when idle), and a counter that is increased on every restart to
+    // discard frames decoded before it
+    int mNextFrame { 0 };
+    int mDecoding  { -1 };
+    int mRestarts  { 0 };
+    bool mFailed   { false };
+    bool mStop     { false };
+
+    mutable std::mutex mMutex;
+    std::condition_variable mWorkAvailable;
+    std::condition_variable mFrameDecoded;
+    std::thread mWorker;
+};
+
+#endif // TRAJECTORYPLAYER_H
@@ -0,0 +1,178 @@
+#include <algorithm>
+#include <cstring>
+#include "trajectoryformat.h"
+#include "trajectoryreader.h"
+
+TrajectoryReader::TrajectoryReader()
+{
+}
+
+bool TrajectoryReader::open(const std::string& filename)
+{
+    close();
+
+    mFile.open(filename, std::ios::binary);
+
+    if(!mFile)
+    {
+        return false;
+    }
+
+    unsigned char header[trajectory::HEADER_SIZE];
+
+    if(!mFile.read(reinterpret_cast<char*>(header), sizeof(header)) ||
+        std::memcmp(header, trajectory::MAGIC, 8) != 0 ||
+        trajectory::getUint32(header + 8) != trajectory::VERSION)
+    {
+        close();
+        return false;
+    }
+
+    mWidth            = trajectory::getUint32(header + 12);
+    mHeight           = trajectory::getUint32(header + 16);
+    mKeyframeInterval = std::max<int>(1, trajectory::getUint32(header + 20));
+    mFirstGeneration  = trajectory::getUint32(header + 24);
+    mGenerationStep   = trajectory::getUint32(header + 28);
+
+    // Locate the frame index through the footer
+    unsigned char footer[trajectory::FOOTER_SIZE];
+
+    mFile.seekg(-static_cast<std::streamoff>(sizeof(footer)), std::ios::end);
+
+    if(!mFile.read(reinterpret_cast<char*>(footer), sizeof(footer)) ||
+        std::memcmp(footer + 8, trajectory::END_MAGIC, 8) != 0)
+    {
+        // The file was not closed properly
+        close();
+        return false;
+    }
+
+    mFile.seekg(trajectory::getUint64(footer));
+
+    unsigned char buffer[8];
+    mFile.read(reinterpret_cast<char*>(buffer), 8);
+    uint64_t count = trajectory::getUint64(buffer);
+
+    mOffsets.resize(count);
+
+    for(uint64_t i = 0; i < count && mFile; i++)
+    {
+        mFile.read(reinterpret_cast<char*>(buffer), 8);
+        mOffsets[i] = trajectory::getUint64(buffer);
+    }
+
+    if(!mFile)
+    {
+        close();
+        return false;
+    }
+
+    mCurrent.assign(mWidth * mHeight, 0);
+    mCurrentFrame = -1;
+
+    return true;
+}
+
+void TrajectoryReader::close()
+{
+    mFile.close();
+    mFile.clear();
+    mOffsets.clear();
+    mCurrentFrame = -1;
+}
+
+bool TrajectoryReader::isOpen() const
+{
+    return mFile.is_open();
+}
+
+int TrajectoryReader::width() const
+{
+    return mWidth;
+}
+
+int TrajectoryReader::height() const
+{
+    return mHeight;
+}
+
+int TrajectoryReader::frameCount() const
+{
+    return static_cast<int>(mOffsets.size());
+}
+
+int TrajectoryReader::keyframeInterval() const
+{
+    return mKeyframeInterval;
+}
+
+int TrajectoryReader::generation(int frame) const
+{
+    return mFirstGeneration + frame * mGenerationStep;
+}
+
+bool TrajectoryReader::readFrame(int frame, unsigned char* lattice)
+{
+    if(frame < 0 || frame >= frameCount())
+    {
+        return false;
+    }
+
+    int keyframe = frame - frame % mKeyframeInterval;
+
+    // Decode forward from the closest keyframe unless the frame already
+    // decoded lies between that keyframe and the requested one
+    int start = (mCurrentFrame >= keyframe && mCurrentFrame <= frame) ?
+                mCurrentFrame + 1 : keyframe;
+
+    for(int i = start; i <= frame; i++)
+    {
+        if(!decodeFrame(i))
+        {
+            mCurrentFrame = -1;
+            return false;
+        }
+    }
+
+    std::copy(mCurrent.begin(), mCurrent.end(), lattice);
+
+    return true;
+}
+
+bool TrajectoryReader::decodeFrame(int frame)
+{
+    unsigned char header[5];
+
+    mFile.clear();
+    mFile.seekg(mOffsets[frame]);
+
+    if(!mFile.read(reinterpret_cast<char*>(header), sizeof(header)))
+    {
+        return false;
+    }
+
+    bool keyframe = header[0] == trajectory::KEYFRAME;
+
+    // A delta needs its predecessor
+    if(!keyframe && mCurrentFrame != frame - 1)
+    {
+        return false;
+    }
+
+    mPayload.resize(trajectory::getUint32(header + 1));
+
+    if(!mFile.read(reinterpret_cast<char*>(mPayload.data()), mPayload.size()))
+    {
+        return false;
+    }
+
+    if(!trajectory::decodeRuns(mPayload.data(), mPayload.size(),
+                               mCurrent.data(), mCurrent.size(), !keyframe))
+    {
+        return false;
+    }
+
+    mCurrentFrame = frame;
+
+    return true;
+}
@@ -0,0 +1,52 @@
+#ifndef TRAJECTORYREADER_H
+#define TRAJECTORYREADER_H
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Reads the trajectory files written by TrajectoryWriter. Any frame can be
+// obtained by decoding forward from the keyframe preceding it, consecutive
+// frames only require applying one delta each.
+class TrajectoryReader
+{
+public:
+    TrajectoryReader();
+
+    bool open(const std::string& filename);
+    void close();
+
+    bool isOpen() const;
+
+    int width() const;
+    int height() const;
+    int frameCount() const;
+    int keyframeInterval() const;
+
+    // Generation of the simulation that corresponds to a frame
+    int generation(int frame) const;
+
+    // Decode the given frame into lattice, which must hold width * height
+    // cells.
+    bool readFrame(int frame, unsigned char* lattice);
+
+private:
+    bool decodeFrame(int frame);
+
+    std::ifstream mFile;
+    std::vector<uint64_t> mOffsets;
+
+    int mWidth            { 0 };
+    int mHeight           { 0 };
+    int mKeyframeInterval { 1 };
+    int mFirstGeneration  { 0 };
+    int mGenerationStep   { 1 };
+
+    // The last decoded frame, needed to apply the following deltas
+    std::vector<unsigned char> mCurrent;
+    std::vector<unsigned char> mPayload;
+    int mCurrentFrame { -1 };
+};
+
+#endif // TRAJECTORYREADER_H
@@ -0,0 +1,196 @@
+#include <algorithm>
+#include "trajectoryformat.h"
+#include "trajectorywriter.h"
+
+using std::lock_guard;
+using std::mutex;
+using std::unique_lock;
+using std::vector;
+
+TrajectoryWriter::TrajectoryWriter(int width, int height, int keyframeInterval,
+                                   int maxPendingFrames)
+    : mWidth(width),
+      mHeight(height),
+      mKeyframeInterval(std::max(1, keyframeInterval)),
+      mMaxPendingFrames(std::max(1, maxPendingFrames))
+{
+}
+
+TrajectoryWriter::~TrajectoryWriter()
+{
+    close();
+}
+
+bool TrajectoryWriter::open(const std::string& filename, int firstGeneration,
+                            int generationStep)
+{
+    close();
+
+    mFile.open(filename, std::ios::binary | std::ios::trunc);
+
+    if(!mFile)
+    {
+        return false;
+    }
+
+    vector<unsigned char> header(trajectory::MAGIC, trajectory::MAGIC + 8);
+    trajectory::putUint32(header, trajectory::VERSION);
+    trajectory::putUint32(header, mWidth);
+    trajectory::putUint32(header, mHeight);
+    trajectory::putUint32(header, mKeyframeInterval);
+    trajectory::putUint32(header, firstGeneration);
+    trajectory::putUint32(header, generationStep);
+
+    mFile.write(reinterpret_cast<const char*>(header.data()), header.size());
+
+    mFrameCount = 0;
+    mOffsets.clear();
+    mPrevious.assign(mWidth * mHeight, 0);
+    mStop = false;
+
+    mWorker = std::thread(&TrajectoryWriter::run, this);
+
+    return true;
+}
+
+void TrajectoryWriter::write(const unsigned char* lattice)
+{
+    if(!isOpen())
+    {
+        return;
+    }
+
+    unique_lock<mutex> lock(mMutex);
+
+    // Apply back pressure instead of growing the queue without bounds
+    mSpaceAvailable.wait(lock, [this]
+    {
+        return static_cast<int>(mPending.size()) < mMaxPendingFrames;
+    });
+
+    vector<unsigned char> buffer;
+
+    if(!mFreeBuffers.empty())
+    {
+        buffer.swap(mFreeBuffers.back());
+        mFreeBuffers.pop_back();
+    }
+
+    buffer.assign(lattice, lattice + mWidth * mHeight);
+
+    mPending.push_back(std::move(buffer));
+    mFrameCount++;
+
+    lock.unlock();
+    mFrameAvailable.notify_one();
+}
+
+void TrajectoryWriter::close()
+{
+    if(!mWorker.joinable())
+    {
+        return;
+    }
+
+    {
+        lock_guard<mutex> lock(mMutex);
+        mStop = true;
+    }
+
+    mFrameAvailable.notify_one();
+    mWorker.join();
+
+    // Write the frame index and the footer
+    uint64_t indexOffset = static_cast<uint64_t>(mFile.tellp());
+
+    vector<unsigned char> index;
+    trajectory::putUint64(index, mOffsets.size());
+
+    for(auto offset : mOffsets)
+    {
+        trajectory::putUint64(index, offset);
+    }
+
+    trajectory::putUint64(index, indexOffset);
+    index.insert(index.end(), trajectory::END_MAGIC, trajectory::END_MAGIC + 8);
+
+    mFile.write(reinterpret_cast<const char*>(index.data()), index.size());
+    mFile.close();
+
+    mPending.clear();
+    mFreeBuffers.clear();
+}
+
+bool TrajectoryWriter::isOpen() const
+{
+    return mWorker.joinable();
+}
+
+int TrajectoryWriter::frameCount() const
+{
+    return mFrameCount;
+}
+
+void TrajectoryWriter::run()
+{
+    unique_lock<mutex> lock(mMutex);
+
+    while(true)
+    {
+        mFrameAvailable.wait(lock, [this]
+        {
+            return mStop || !mPending.empty();
+        });
+
+        if(mPending.empty())
+        {
+            // mStop is set and every frame has been written
+            break;
+        }
+
+        vector<unsigned char> frame = std::move(mPending.front());
+        mPending.pop_front();
+
+        lock.unlock();
+        mSpaceAvailable.notify_one();
+
+        encode(frame);
+
+        lock.lock();
+        mFreeBuffers.push_back(std::move(frame));
+    }
+}
+
+void TrajectoryWriter::encode(const vector<unsigned char>& frame)
+{
+    bool keyframe = mOffsets.size() % mKeyframeInterval == 0;
+
+    mOffsets.push_back(static_cast<uint64_t>(mFile.tellp()));
+
+    const vector<unsigned char>* source = &frame;
+
+    if(!keyframe)
+    {
+        mDelta.resize(frame.size());
+
+        std::transform(frame.begin(), frame.end(), mPrevious.begin(),
+                       mDelta.begin(), [](unsigned char a, unsigned char b)
+        {
+            return static_cast<unsigned char>(a ^ b);
+        });
+
+        source = &mDelta;
+    }
+
+    mPayload.clear();
+    trajectory::encodeRuns(source->data(), source->size(), mPayload);
+
+    vector<unsigned char> frameHeader;
+    frameHeader.push_back(keyframe ? trajectory::KEYFRAME : trajectory::DELTA);
+    trajectory::putUint32(frameHeader, mPayload.size());
+
+    mFile.write(reinterpret_cast<const char*>(frameHeader.data()), frameHeader.size());
+    mFile.write(reinterpret_cast<const char*>(mPayload.data()), mPayload.size());
+
+    std::copy(frame.begin(), frame.end(), mPrevious.begin());
+}
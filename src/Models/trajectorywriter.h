@@ -0,0 +1,79 @@
+#ifndef TRAJECTORYWRITER_H
+#define TRAJECTORYWRITER_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Records a sequence of lattices into a trajectory file. Every
+// keyframeInterval frames a full frame (keyframe) is stored, the frames in
+// between are stored as the XOR with the previous frame. Both kinds of frame
+// are run length encoded. Encoding and disk access happen on a background
+// thread, write() only copies the lattice into a queue.
+//
+// File layout (all integers are little endian):
+//   header  "CAPSOTRJ", version, width, height, keyframe interval,
+//           first generation, generation step (uint32 each)
+//   frames  type (uint8, 0 = keyframe, 1 = delta), payload size (uint32),
+//           payload (runs of varint length + byte value)
+//   index   frame count (uint64), offset of every frame (uint64 each)
+//   footer  offset of the index (uint64), "CAPSOEND"
+class TrajectoryWriter
+{
+public:
+    TrajectoryWriter(int width, int height, int keyframeInterval = 100,
+                     int maxPendingFrames = 32);
+
+    ~TrajectoryWriter();
+
+    // firstGeneration and generationStep map frame indices to generations,
+    // e.g. a step of 10 when only the end of every season is recorded.
+    bool open(const std::string& filename, int firstGeneration = 0,
+              int generationStep = 1);
+
+    void write(const unsigned char* lattice);
+
+    void close();
+
+    bool isOpen() const;
+    int  frameCount() const;
+
+private:
+    TrajectoryWriter(const TrajectoryWriter&);
+    TrajectoryWriter& operator=(const TrajectoryWriter&);
+
+private:
+    void run();
+    void encode(const std::vector<unsigned char>& frame);
+
+    int mWidth;
+    int mHeight;
+    int mKeyframeInterval;
+    int mMaxPendingFrames;
+    int mFrameCount { 0 };
+
+    std::ofstream mFile;
+    std::vector<uint64_t> mOffsets;
+
+    // Last frame written to the file and scratch buffers of the encoder
+    std::vector<unsigned char> mPrevious;
+    std::vector<unsigned char> mDelta;
+    std::vector<unsigned char> mPayload;
+
+    // Frames waiting to be encoded and buffers ready to be reused
+    std::deque<std::vector<unsigned char>> mPending;
+    std::vector<std::vector<unsigned char>> mFreeBuffers;
+
+    std::mutex mMutex;
+    std::condition_variable mFrameAvailable;
+    std::condition_variable mSpaceAvailable;
+    bool mStop { false };
+    std::thread mWorker;
+};
+
+#endif // TRAJECTORYWRITER_H
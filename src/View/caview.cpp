@@ -10,17 +10,7 @@ CaView::CaView(unsigned char* latticeData, const int& width,
       mHeight(height)
 
 {
-    mLatticeImage = new QImage(latticeData, width, height, QImage::Format_Indexed8);
-
-    // Initialize the state table
-    mLatticeImage->setColor(0, qRgb(0, 0, 0));		// Empty
-    mLatticeImage->setColor(1, qRgb(38, 127, 0));	// Prey
-    mLatticeImage->setColor(2, qRgb(255, 0, 0));	// Predator
-    mLatticeImage->setColor(3, qRgb(255, 216, 0));	// Prey and predator
-    mLatticeImage->setColor(4, qRgb(255, 255, 255));	// Global Best
-    mLatticeImage->setColor(5, qRgb(255, 255, 255));	// Global Best
-    mLatticeImage->setColor(6, qRgb(255, 255, 255));	// Global Best
-    mLatticeImage->setColor(7, qRgb(255, 255, 255));	// Global Best
+    createImage(latticeData);
 
     // Do not allow this widget to resize
     setSizePolicy(QSizePolicy::Minimum, QSizePolicy::Minimum);
@@ -41,6 +31,41 @@ const QImage& CaView::latticeImage() const
 	return *mLatticeImage;
 }
 
+void CaView::setLatticeData(unsigned char* latticeData, int width, int height)
+{
+    delete mLatticeImage;
+
+    mWidth = width;
+    mHeight = height;
+
+    createImage(latticeData);
+
+    update();
+}
+
+void CaView::createImage(unsigned char* latticeData)
+{
+    mLatticeImage = new QImage(latticeData, mWidth, mHeight, QImage::Format_Indexed8);
+
+    // Initialize the state table
+    mLatticeImage->setColorTable(colorTable());
+}
+
+QVector<QRgb> CaView::colorTable()
+{
+    return QVector<QRgb>
+    {
+        qRgb(0, 0, 0),          // Empty
+        qRgb(38, 127, 0),       // Prey
+        qRgb(255, 0, 0),        // Predator
+        qRgb(255, 216, 0),      // Prey and predator
+        qRgb(255, 255, 255),    // Global Best
+        qRgb(255, 255, 255),    // Global Best
+        qRgb(255, 255, 255),    // Global Best
+        qRgb(255, 255, 255)     // Global Best
+    };
+}
+
 void CaView::paintEvent(QPaintEvent*)
 {
 	QPainter painter(this);
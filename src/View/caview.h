@@ -3,6 +3,7 @@
 
 #include <QWidget>
 #include <QImage>
+#include <QVector>
 
 class CaView : public QWidget
 {
@@ -18,12 +19,20 @@ public:
 
 	const QImage& latticeImage() const;
 
+    // Colors used to render every state of a cell
+    static QVector<QRgb> colorTable();
+
+    // Display a different lattice, e.g., a frame of a recorded trajectory
+    void setLatticeData(unsigned char* latticeData, int width, int height);
+
 protected:
 	void paintEvent(QPaintEvent*);
 
 private:
+    void createImage(unsigned char* latticeData);
+
 	QImage* mLatticeImage;
-    const int mWidth, mHeight;
+    int mWidth, mHeight;
 };
 
 #endif // CAVIEW_H
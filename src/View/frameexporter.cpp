@@ -0,0 +1,229 @@
+#include <algorithm>
+#include <vector>
+#include <QFileInfo>
+#include <QDir>
+#include <QImage>
+#include <QMutexLocker>
+#include <QRunnable>
+#include "frameexporter.h"
+#include "caview.h"
+#include "trajectoryreader.h"
+
+namespace
+{
+    // Wraps the encoding of a frame to be run by the thread pool
+    class EncodeTask : public QRunnable
+    {
+    public:
+        explicit EncodeTask(std::function<void()> function)
+            : mFunction(function)
+        {
+        }
+
+        void run() override
+        {
+            mFunction();
+        }
+
+    private:
+        std::function<void()> mFunction;
+    };
+}
+
+FrameExporter::FrameExporter(int width, int height, Format format,
+                             int threads, int maxPendingFrames)
+    : mWidth(width),
+      mHeight(height),
+      mFormat(format),
+      mMaxPendingFrames(maxPendingFrames > 0 ? maxPendingFrames : 2 * std::max(1, threads)),
+      mColorTable(CaView::colorTable())
+{
+    mPool.setMaxThreadCount(std::max(1, threads));
+    mFreeSlots.release(mMaxPendingFrames);
+
+    // BT.601 conversion to limited range YUV
+    for(QRgb color : mColorTable)
+    {
+        double r = qRed(color), g = qGreen(color), b = qBlue(color);
+
+        mLuma.append(static_cast<char>(qRound( 16.0 + ( 65.481 * r + 128.553 * g +  24.966 * b) / 255.0)));
+        mBlueChroma.append(static_cast<char>(qRound(128.0 + (-37.797 * r -  74.203 * g + 112.000 * b) / 255.0)));
+        mRedChroma.append(static_cast<char>(qRound(128.0 + (112.000 * r -  93.786 * g -  18.214 * b) / 255.0)));
+    }
+}
+
+FrameExporter::~FrameExporter()
+{
+    close();
+}
+
+bool FrameExporter::open(const QString& filename, int framesPerSecond)
+{
+    mFilename = filename;
+    mFrameCount = 0;
+    mNextFrameToWrite = 0;
+    mFailed = false;
+
+    if(mFormat == Y4M)
+    {
+        mFile.setFileName(filename);
+
+        if(!mFile.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        {
+            return false;
+        }
+
+        // Full resolution chroma (4:4:4) avoids any constraint on the size
+        // of the lattice
+        QByteArray header = QString("YUV4MPEG2 W%1 H%2 F%3:1 Ip A1:1 C444\n")
+                .arg(mWidth).arg(mHeight).arg(framesPerSecond).toLatin1();
+
+        mFile.write(header);
+    }
+
+    return true;
+}
+
+void FrameExporter::write(const unsigned char* lattice)
+{
+    // Wait for a free slot to bound the memory used by pending frames
+    mFreeSlots.acquire();
+
+    QByteArray frame(reinterpret_cast<const char*>(lattice), mWidth * mHeight);
+    int index = mFrameCount++;
+
+    mPool.start(new EncodeTask([this, index, frame]()
+    {
+        encode(index, frame);
+    }));
+}
+
+bool FrameExporter::close()
+{
+    mPool.waitForDone();
+
+    if(mFile.isOpen())
+    {
+        mFile.close();
+    }
+
+    return !mFailed;
+}
+
+bool FrameExporter::exportTrajectory(const QString& trajectory, const QString& output,
+                                     int framesPerSecond,
+                                     std::function<bool(int, int)> progress)
+{
+    TrajectoryReader reader;
+
+    if(!reader.open(QFile::encodeName(trajectory).toStdString()))
+    {
+        return false;
+    }
+
+    Format format = QFileInfo(output).suffix().compare("y4m", Qt::CaseInsensitive) == 0 ?
+                    Y4M : PNG_SEQUENCE;
+
+    FrameExporter exporter(reader.width(), reader.height(), format);
+
+    if(!exporter.open(output, framesPerSecond))
+    {
+        return false;
+    }
+
+    std::vector<unsigned char> lattice(reader.width() * reader.height());
+    bool canceled = false;
+
+    for(int frame = 0; frame < reader.frameCount(); frame++)
+    {
+        if(progress && !progress(frame, reader.frameCount()))
+        {
+            canceled = true;
+            break;
+        }
+
+        if(!reader.readFrame(frame, lattice.data()))
+        {
+            exporter.close();
+            return false;
+        }
+
+        exporter.write(lattice.data());
+    }
+
+    bool saved = exporter.close();
+
+    if(progress && !canceled)
+    {
+        progress(reader.frameCount(), reader.frameCount());
+    }
+
+    return saved && !canceled;
+}
+
+void FrameExporter::encode(int index, QByteArray frame)
+{
+    const unsigned char* cells = reinterpret_cast<const unsigned char*>(frame.constData());
+
+    if(mFormat == PNG_SEQUENCE)
+    {
+        QImage image(mWidth, mHeight, QImage::Format_Indexed8);
+        image.setColorTable(mColorTable);
+
+        for(int row = 0; row < mHeight; row++)
+        {
+            std::copy(cells + row * mWidth, cells + (row + 1) * mWidth,
+                      image.scanLine(row));
+        }
+
+        bool saved = image.save(frameFilename(index), "PNG");
+
+        QMutexLocker locker(&mMutex);
+        mFailed = mFailed || !saved;
+        mFreeSlots.release();
+
+        return;
+    }
+
+    // Map every cell to its Y, U and V values, one plane after the other
+    int size = mWidth * mHeight;
+    QByteArray yuv = QByteArray("FRAME\n");
+    int offset = yuv.size();
+    yuv.resize(offset + 3 * size);
+
+    char* y = yuv.data() + offset;
+    char* u = y + size;
+    char* v = u + size;
+
+    for(int i = 0; i < size; i++)
+    {
+        int state = cells[i] < mColorTable.size() ? cells[i] : 0;
+
+        y[i] = mLuma[state];
+        u[i] = mBlueChroma[state];
+        v[i] = mRedChroma[state];
+    }
+
+    QMutexLocker locker(&mMutex);
+    mEncodedFrames.insert(index, yuv);
+
+    // Write every frame that is now contiguous with those already written
+    while(!mEncodedFrames.isEmpty() && mEncodedFrames.firstKey() == mNextFrameToWrite)
+    {
+        QByteArray next = mEncodedFrames.take(mNextFrameToWrite);
+
+        mFailed = mFailed || mFile.write(next) != next.size();
+
+        mNextFrameToWrite++;
+        mFreeSlots.release();
+    }
+}
+
+QString FrameExporter::frameFilename(int index) const
+{
+    QFileInfo info(mFilename);
+
+    return info.dir().filePath(QString("%1_%2.png")
+                               .arg(info.completeBaseName())
+                               .arg(index, 6, 10, QChar('0')));
+}
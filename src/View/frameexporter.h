@@ -0,0 +1,80 @@
+#ifndef FRAMEEXPORTER_H
+#define FRAMEEXPORTER_H
+
+#include <functional>
+#include <QByteArray>
+#include <QFile>
+#include <QMap>
+#include <QMutex>
+#include <QSemaphore>
+#include <QString>
+#include <QThread>
+#include <QThreadPool>
+#include <QVector>
+#include <QRgb>
+
+// Converts lattices into images with the colors of CaView and encodes them
+// on a pool of threads, either as a sequence of PNG files or as an
+// uncompressed YUV4MPEG2 (Y4M) video. At most maxPendingFrames frames are
+// held in memory, write() blocks once that limit is reached.
+class FrameExporter
+{
+public:
+    enum Format { PNG_SEQUENCE, Y4M };
+
+    FrameExporter(int width, int height, Format format,
+                  int threads = QThread::idealThreadCount(),
+                  int maxPendingFrames = 0);
+
+    ~FrameExporter();
+
+    // For PNG sequences the frame number is appended to the base name of
+    // filename, e.g. lattice.png becomes lattice_000000.png, lattice_000001.png...
+    bool open(const QString& filename, int framesPerSecond = 30);
+
+    void write(const unsigned char* lattice);
+
+    // Wait for every frame to be encoded, returns false if any of them
+    // could not be saved.
+    bool close();
+
+    // Export every frame of a trajectory file. The format is chosen from the
+    // extension of output. progress receives the number of frames submitted
+    // and the total, returning false from it cancels the export.
+    static bool exportTrajectory(const QString& trajectory, const QString& output,
+                                 int framesPerSecond = 30,
+                                 std::function<bool(int, int)> progress = nullptr);
+
+private:
+    FrameExporter(const FrameExporter&);
+    FrameExporter& operator=(const FrameExporter&);
+
+private:
+    void encode(int index, QByteArray frame);
+    QString frameFilename(int index) const;
+
+    int mWidth;
+    int mHeight;
+    Format mFormat;
+    int mFrameCount { 0 };
+    bool mFailed    { false };
+
+    QThreadPool mPool;
+    QSemaphore  mFreeSlots;
+    int         mMaxPendingFrames;
+
+    QVector<QRgb> mColorTable;
+
+    // Y, U and V values of every color
+    QByteArray mLuma, mBlueChroma, mRedChroma;
+
+    QString mFilename;
+
+    // Y4M frames are encoded in any order but must be written in order
+    QFile mFile;
+    QMutex mMutex;
+    QMap<int, QByteArray> mEncodedFrames;
+    int mNextFrameToWrite { 0 };
+};
+
+#endif // FRAMEEXPORTER_H
@@ -1,8 +1,56 @@
 #include <QApplication>
+#include <QCommandLineParser>
+#include <QTextStream>
 #include "controller.h"
+#include "frameexporter.h"
+
+// Export a recorded trajectory as an animation without opening any window:
+//   QtCaPso --export <trajectory> <output (.y4m or .png)> [--fps <n>]
+static int exportTrajectory(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    parser.addOption({ "export", "Export a trajectory file as an animation." });
+    parser.addOption({ "fps", "Frames per second of Y4M videos.", "n", "30" });
+    parser.addPositionalArgument("trajectory", "Recorded trajectory file.");
+    parser.addPositionalArgument("output", "Y4M video (*.y4m) or base name of a PNG sequence (*.png).");
+    parser.process(a);
+
+    QStringList arguments = parser.positionalArguments();
+
+    if(arguments.size() != 2)
+    {
+        parser.showHelp(1);
+    }
+
+    QTextStream out(stdout);
+
+    bool exported = FrameExporter::exportTrajectory(arguments.at(0), arguments.at(1),
+                                                    parser.value("fps").toInt(),
+                                                    [&out](int frame, int total)
+    {
+        out << "\rExporting frame " << frame << " of " << total << Qt::flush;
+
+        return true;
+    });
+
+    out << Qt::endl;
+
+    return exported ? 0 : 1;
+}
 
 int main(int argc, char *argv[])
 {
+    for(int i = 1; i < argc; i++)
+    {
+        if(QString(argv[i]) == "--export")
+        {
+            return exportTrajectory(argc, argv);
+        }
+    }
+
     QApplication a(argc, argv);
 
     Controller w;
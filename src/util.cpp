@@ -2,6 +2,7 @@
 #include <QFileDialog>
 #include <QFile>
 #include <QDir>
+#include <QJsonArray>
 #include <QJsonObject>
 #include <QJsonDocument>
 #include "util.h"
@@ -111,6 +112,64 @@ namespace util
         return true;
     }
 
+    bool loadSweep(Sweep& sweep, int& replicates, QString settingsFilename)
+    {
+        QFile settingsFile(settingsFilename);
+
+        if(!settingsFile.open(QIODevice::ReadOnly))
+        {
+            return false;
+        }
+
+        QJsonObject json = QJsonDocument::fromJson(settingsFile.readAll()).object();
+
+        if(!json.value("parameters").isObject())
+        {
+            return false;
+        }
+
+        QJsonObject parameters = json.value("parameters").toObject();
+
+        for(auto parameter = parameters.begin(); parameter != parameters.end(); ++parameter)
+        {
+            std::string field = parameter.key().toStdString();
+            bool added = false;
+
+            // Either a list of values or a range {"from", "to", "step"}
+            if(parameter.value().isArray())
+            {
+                std::vector<double> values;
+
+                for(const QJsonValue& value : parameter.value().toArray())
+                {
+                    values.push_back(value.toDouble());
+                }
+
+                added = sweep.addValues(field, values);
+            }
+            else if(parameter.value().isObject())
+            {
+                QJsonObject range = parameter.value().toObject();
+
+                added = sweep.addRange(field, range.value("from").toDouble(),
+                                       range.value("to").toDouble(),
+                                       range.value("step").toDouble(1.0));
+            }
+
+            if(!added)
+            {
+                return false;
+            }
+        }
+
+        if(json.value("replicates").isDouble())
+        {
+            replicates = json.value("replicates").toInt();
+        }
+
+        return true;
+    }
+
 
     bool writeSettings(CaPsoSettings& settings, CaType type)
     {
@@ -3,11 +3,17 @@
 #include <QString>
 #include "capsosettings.h"
 #include "cellularautomaton.h"
+#include "sweep.h"
 
 namespace util
 {
     bool loadSettings(CaPsoSettings& settings, QString settingsFilename);
 
+    // Reads the "parameters" of a sweep file, whose other keys are the base
+    // settings read by loadSettings. replicates is only changed when the
+    // file sets it. Returns false if the file is not a valid sweep.
+    bool loadSweep(Sweep& sweep, int& replicates, QString settingsFilename);
+
     bool writeSettings(CaPsoSettings& settings, CaType type=LOCAL);
 
     bool getPathFromDialog(QString& path);
@@ -1,3 +1,5 @@
+#include <algorithm>
+#include <vector>
 #include <gtest/gtest.h>
 #include "Models/localcapso.h"
 
@@ -42,3 +44,124 @@ TEST(LocalCaPso, test_setSettings)
     EXPECT_NEAR(caSettings.initialInertiaWeight      ,0.13, 0.0000001F);
     EXPECT_NEAR(caSettings.finalInertiaWeight        ,0.14, 0.0000001F);
 }
+
+TEST(LocalCaPso, test_clone)
+{
+    LocalCaPso ca(128, 128);
+    ca.setSettings(CaPsoSettings());
+    ca.initialize();
+
+    for(int i = 0; i < 50; i++)
+    {
+        ca.nextGen();
+    }
+
+    auto copy = ca.clone(1);
+
+    EXPECT_EQ(copy->numberOfPreys(), ca.numberOfPreys());
+    EXPECT_EQ(copy->numberOfPredators(), ca.numberOfPredators());
+    EXPECT_EQ(copy->currentStage(), ca.currentStage());
+    EXPECT_TRUE(std::equal(ca.latticeData(), ca.latticeData() + 128 * 128,
+                           copy->latticeData()));
+
+    // The copy must evolve without touching the original
+    int preys = ca.numberOfPreys();
+    std::vector<unsigned char> lattice(ca.latticeData(),
+                                       ca.latticeData() + 128 * 128);
+
+    for(int i = 0; i < 20; i++)
+    {
+        copy->nextGen();
+    }
+
+    EXPECT_EQ(ca.numberOfPreys(), preys);
+    EXPECT_TRUE(std::equal(lattice.begin(), lattice.end(), ca.latticeData()));
+
+    // Copies forked with different streams must not reproduce each other
+    auto other = ca.clone(2);
+
+    for(int i = 0; i < 20; i++)
+    {
+        other->nextGen();
+    }
+
+    EXPECT_FALSE(std::equal(copy->latticeData(), copy->latticeData() + 128 * 128,
+                            other->latticeData()));
+}
+
+TEST(LocalCaPso, test_stageProfile)
+{
+    LocalCaPso ca(128, 128);
+    ca.setSettings(CaPsoSettings());
+    ca.initialize();
+
+    for(int i = 0; i < 20; i++)
+    {
+        ca.nextGen();
+    }
+
+    // Migration takes five of the ten generations of a season
+    const int calls[] = { 2, 10, 2, 2, 2, 2 };
+
+    for(int stage = 0; stage < 6; stage++)
+    {
+        const StageProfile& profile = ca.stageProfile(stage);
+
+        if(profilingEnabled())
+        {
+            EXPECT_EQ(profile.calls, static_cast<uint64_t>(calls[stage]));
+            EXPECT_GT(profile.cellsVisited, 0u);
+        }
+        else
+        {
+            EXPECT_EQ(profile.calls, 0u);
+            EXPECT_EQ(profile.seconds, 0.0);
+        }
+    }
+
+    if(profilingEnabled())
+    {
+        EXPECT_GT(ca.stageProfile(LocalCaPso::MIGRATION).particleMoves, 0u);
+        EXPECT_GT(ca.stageProfile(LocalCaPso::REPRODUCTION_OF_PREYS).births, 0u);
+        EXPECT_GT(ca.stageProfile(LocalCaPso::COMPETITION).randomDraws, 0u);
+    }
+
+    ca.resetProfile();
+
+    EXPECT_EQ(ca.stageProfile(LocalCaPso::MIGRATION).calls, 0u);
+}
+
+TEST(Swarm, test_sortByPosition)
+{
+    std::vector<unsigned char> lattice(16), densities(16), temp(16);
+    LatticeLayout layout(4, 4);
+    RandomNumber random;
+
+    Swarm swarm(1.0F, 2.0F, 0.9F, 10, 3, lattice, densities, temp,
+                layout, LocalCaPso::PREDATOR, random);
+    swarm.initialize(5);
+
+    // Z-order visits 2x2 blocks before moving on
+    const std::vector<std::pair<int, int>> positions = { {1, 0}, {0, 2}, {0, 0}, {1, 1}, {0, 1} };
+    const std::vector<std::pair<int, int>> sorted = { {0, 0}, {0, 1}, {1, 0}, {1, 1}, {0, 2} };
+
+    auto position = positions.begin();
+
+    for(auto& p : swarm)
+    {
+        p->position.row = position->first;
+        p->position.col = position->second;
+        position++;
+    }
+
+    swarm.sortByPosition();
+
+    std::vector<std::pair<int, int>> actual;
+
+    for(auto& p : swarm)
+    {
+        actual.push_back({ p->position.row, p->position.col });
+    }
+
+    EXPECT_EQ(sorted, actual);
+}
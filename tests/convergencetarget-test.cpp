@@ -0,0 +1,118 @@
+#include <cmath>
+#include <random>
+#include <gtest/gtest.h>
+#include "Models/convergencetarget.h"
+
+TEST(ConvergenceTarget, test_replicate_value)
+{
+    std::vector<SeasonRecord> records(2, SeasonRecord());
+    records[0].preys = 40;
+    records[0].predators = 5;
+    records[1].preys = 60;
+    records[1].predators = 0;
+
+    EXPECT_DOUBLE_EQ(0.5, ConvergenceTarget::replicateValue(
+                         ConvergenceTarget::MEAN_PREY_DENSITY, records, 100, 2));
+    EXPECT_DOUBLE_EQ(0.025, ConvergenceTarget::replicateValue(
+                         ConvergenceTarget::MEAN_PREDATOR_DENSITY, records, 100, 2));
+    EXPECT_DOUBLE_EQ(1.0, ConvergenceTarget::replicateValue(
+                         ConvergenceTarget::PREDATOR_EXTINCTION, records, 100, 2));
+
+    // Stopped after two of four seasons, the last state fills the rest
+    EXPECT_DOUBLE_EQ(0.55, ConvergenceTarget::replicateValue(
+                         ConvergenceTarget::MEAN_PREY_DENSITY, records, 100, 4));
+    EXPECT_DOUBLE_EQ(0.0125, ConvergenceTarget::replicateValue(
+                         ConvergenceTarget::MEAN_PREDATOR_DENSITY, records, 100, 4));
+}
+
+TEST(ConvergenceTarget, test_waves)
+{
+    EXPECT_FALSE(ConvergenceTarget().enabled());
+
+    ConvergenceTarget target(ConvergenceTarget::MEAN_PREY_DENSITY, 0.01, 1000);
+    ASSERT_TRUE(target.enabled());
+
+    std::mt19937 engine(3);
+    std::normal_distribution<double> normal(0.4, 0.05);
+
+    // Waves grow at most twofold until the interval is narrow enough, the
+    // spread needs about (1.96 * 0.05 / 0.01)^2 = 96 replicates
+    int launched = 0;
+    int more = 8;
+    int waves = 0;
+
+    while(more > 0)
+    {
+        EXPECT_LE(more, std::max(launched, 8));
+
+        for(int i = 0; i < more; i++)
+        {
+            target.add(normal(engine));
+        }
+
+        launched += more;
+        more = target.additionalReplicates(launched);
+        waves++;
+    }
+
+    EXPECT_TRUE(target.converged());
+    EXPECT_LE(target.halfWidth(), 0.01);
+    EXPECT_GT(launched, 60);
+    EXPECT_LT(launched, 160);
+    EXPECT_NEAR(0.4, target.estimate(), 0.02);
+    EXPECT_GT(waves, 2);
+}
+
+TEST(ConvergenceTarget, test_extinction)
+{
+    // Wilson's interval stays open when every replicate survives
+    ConvergenceTarget target(ConvergenceTarget::PREDATOR_EXTINCTION, 0.05, 40);
+
+    for(int i = 0; i < 10; i++)
+    {
+        target.add(0.0);
+    }
+
+    EXPECT_FALSE(target.converged());
+    EXPECT_EQ(10, target.additionalReplicates(10));
+    EXPECT_EQ(10, target.additionalReplicates(30));
+    EXPECT_EQ(0, target.additionalReplicates(40));
+}
+
+TEST(ConvergenceTarget, test_small_waves)
+{
+    EXPECT_NEAR(12.706, ConvergenceTarget::studentQuantile(1), 1e-3);
+    EXPECT_NEAR(2.776, ConvergenceTarget::studentQuantile(4), 1e-3);
+    EXPECT_NEAR(2.040, ConvergenceTarget::studentQuantile(31), 1e-3);
+    EXPECT_NEAR(1.984, ConvergenceTarget::studentQuantile(100), 1e-3);
+
+    // Few replicates use the t quantile, not the normal one
+    ConvergenceTarget target(ConvergenceTarget::MEAN_PREY_DENSITY, 0.01, 1000);
+
+    for(double value : { 0.40, 0.41, 0.39, 0.42, 0.38 })
+    {
+        target.add(value);
+    }
+
+    EXPECT_NEAR(2.776 * 0.0158114 / std::sqrt(5.0), target.halfWidth(), 1e-4);
+
+    // Identical replicates do not converge before the minimum, a first wave
+    // below it goes straight to it
+    ConvergenceTarget flat(ConvergenceTarget::MEAN_PREY_DENSITY, 0.01, 1000);
+
+    for(int i = 0; i < 3; i++)
+    {
+        flat.add(0.4);
+    }
+
+    EXPECT_FALSE(flat.converged());
+    EXPECT_EQ(ConvergenceTarget::MINIMUM_REPLICATES - 3, flat.additionalReplicates(3));
+
+    for(int i = 3; i < ConvergenceTarget::MINIMUM_REPLICATES; i++)
+    {
+        flat.add(0.4);
+    }
+
+    EXPECT_TRUE(flat.converged());
+    EXPECT_EQ(0, flat.additionalReplicates(ConvergenceTarget::MINIMUM_REPLICATES));
+}
@@ -0,0 +1,91 @@
+#include "engines.h"
+#include "Models/localcapso.h"
+
+namespace
+{
+    // Adapts any model with the interface of LocalCaPso to an Engine
+    template<class Model>
+    class ModelEngine : public Engine
+    {
+    public:
+        ModelEngine(int width, int height, const CaPsoSettings& settings, uint64_t seed,
+                    std::function<void(Model&)> configure = nullptr)
+            : mModel(width, height)
+        {
+            if(configure)
+            {
+                configure(mModel);
+            }
+
+            mModel.setSettings(settings);
+            mModel.seed(seed);
+            mModel.initialize();
+        }
+
+        void nextGen() override { mModel.nextGen(); }
+        int currentStage() const override { return mModel.currentStage(); }
+        int numberOfPreys() const override { return mModel.numberOfPreys(); }
+        int numberOfPredators() const override { return mModel.numberOfPredators(); }
+        float preyBirthRate() const override { return mModel.preyBirthRate(); }
+        float predatorBirthRate() const override { return mModel.predatorBirthRate(); }
+
+        std::vector<unsigned char> lattice() const override
+        {
+            std::vector<unsigned char> lattice(mModel.width() * mModel.height());
+            mModel.layout().toRowMajor(mModel.latticeData(), lattice.data());
+
+            return lattice;
+        }
+
+    private:
+        Model mModel;
+    };
+
+    template<class Model, void (*Configure)(Model&) = nullptr>
+    std::unique_ptr<Engine> create(int width, int height,
+                                   const CaPsoSettings& settings, uint64_t seed)
+    {
+        return std::unique_ptr<Engine>(new ModelEngine<Model>(width, height, settings, seed,
+                                                              Configure));
+    }
+
+    // The original search of the whole social neighborhood
+    void scanNeighborhoods(LocalCaPso& model)
+    {
+        model.setNeighborSearch(Swarm::SCAN);
+    }
+
+    void sortEverySeason(LocalCaPso& model)
+    {
+        model.setParticleSortInterval(1);
+    }
+
+    void storeInTiles(LocalCaPso& model)
+    {
+        model.setLayout(8);
+    }
+
+    void runScalarKernels(LocalCaPso& model)
+    {
+        model.setKernels(scalarKernels());
+    }
+}
+
+std::unique_ptr<Engine> createReference(int width, int height,
+                                        const CaPsoSettings& settings, uint64_t seed)
+{
+    return create<LocalCaPso, scanNeighborhoods>(width, height, settings, seed);
+}
+
+const std::vector<EngineFactory>& engines()
+{
+    static const std::vector<EngineFactory> factories =
+    {
+        { "LocalCaPso grid", true, create<LocalCaPso> },
+        { "LocalCaPso tiled", true, create<LocalCaPso, storeInTiles> },
+        { "LocalCaPso scalar kernels", true, create<LocalCaPso, runScalarKernels> },
+        { "LocalCaPso sorted", false, create<LocalCaPso, sortEverySeason> },
+    };
+
+    return factories;
+}
@@ -0,0 +1,50 @@
+#ifndef ENGINES_H
+#define ENGINES_H
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Models/capsosettings.h"
+
+// A model implementation driven by the regression harnesses. Optimised
+// engines are registered next to the reference LocalCaPso and compared with
+// it stage by stage.
+class Engine
+{
+public:
+    virtual ~Engine() {}
+
+    virtual void nextGen() = 0;
+    virtual int currentStage() const = 0;
+    virtual int numberOfPreys() const = 0;
+    virtual int numberOfPredators() const = 0;
+    virtual float preyBirthRate() const = 0;
+    virtual float predatorBirthRate() const = 0;
+
+    // Row major copy of the lattice, whatever the internal layout
+    virtual std::vector<unsigned char> lattice() const = 0;
+};
+
+struct EngineFactory
+{
+    std::string name;
+
+    // Exact engines claim to reproduce the reference bit for bit from the
+    // same seed, the others only statistically
+    bool exact;
+
+    std::function<std::unique_ptr<Engine>(int width, int height,
+                                          const CaPsoSettings& settings,
+                                          uint64_t seed)> create;
+};
+
+// The reference implementation of the local model
+std::unique_ptr<Engine> createReference(int width, int height,
+                                        const CaPsoSettings& settings, uint64_t seed);
+
+// Every engine to compare with the reference
+const std::vector<EngineFactory>& engines();
+
+#endif // ENGINES_H
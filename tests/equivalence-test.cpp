@@ -0,0 +1,264 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+#include "engines.h"
+#include "settingsfile.h"
+
+// Engines that cannot reproduce the random stream of the reference are
+// compared with it statistically: ensembles of both are run from different
+// seeds and the distributions of season level observables are compared with
+// two sample Kolmogorov-Smirnov tests. Set CAPSO_ENSEMBLE_SIZE to run larger
+// ensembles than the default, e.g., before merging a new fast path.
+
+namespace
+{
+    const int SIZE = 64;
+    const int SEASONS = 15;
+    const int DEFAULT_ENSEMBLE_SIZE = 16;
+
+    // Family wise significance of the comparisons of one setting
+    const double ALPHA = 0.01;
+
+    // Observables of a single run, every run contributes one value of each
+    enum Observable
+    {
+        MEAN_PREYS,
+        MEAN_PREDATORS,
+        PREY_BIRTH_RATE,
+        PREDATOR_BIRTH_RATE,
+        FINAL_PREYS,
+        EXTINCTION_SEASON,
+        NUMBER_OF_OBSERVABLES
+    };
+
+    const char* observableName(int observable)
+    {
+        static const char* names[] = { "mean preys", "mean predators", "prey birth rate",
+                                       "predator birth rate", "final preys",
+                                       "extinction season" };
+
+        return names[observable];
+    }
+
+    typedef std::vector<std::vector<double>> Ensemble;
+
+    int ensembleSize()
+    {
+        const char* size = std::getenv("CAPSO_ENSEMBLE_SIZE");
+
+        return size && std::atoi(size) > 1 ? std::atoi(size) : DEFAULT_ENSEMBLE_SIZE;
+    }
+
+    // Runs whole seasons and samples the populations at the end of every
+    // season, the first one is left out as a transient. The extinction
+    // season is censored at SEASONS when both species survive.
+    std::vector<double> observe(Engine& engine)
+    {
+        std::vector<double> values(NUMBER_OF_OBSERVABLES, 0.0);
+        values[EXTINCTION_SEASON] = SEASONS;
+
+        int samples = 0;
+
+        for(int season = 0; season < SEASONS; season++)
+        {
+            for(int i = 0; i < 10; i++)
+            {
+                engine.nextGen();
+            }
+
+            if(engine.numberOfPreys() == 0 || engine.numberOfPredators() == 0)
+            {
+                values[EXTINCTION_SEASON] = std::min(values[EXTINCTION_SEASON],
+                                                     static_cast<double>(season));
+            }
+
+            if(season > 0)
+            {
+                values[MEAN_PREYS] += engine.numberOfPreys();
+                values[MEAN_PREDATORS] += engine.numberOfPredators();
+                values[PREY_BIRTH_RATE] += engine.preyBirthRate();
+                values[PREDATOR_BIRTH_RATE] += engine.predatorBirthRate();
+                samples++;
+            }
+        }
+
+        for(int observable : { MEAN_PREYS, MEAN_PREDATORS, PREY_BIRTH_RATE, PREDATOR_BIRTH_RATE })
+        {
+            values[observable] /= samples;
+        }
+
+        values[FINAL_PREYS] = engine.numberOfPreys();
+
+        return values;
+    }
+
+    // One vector of values per observable
+    template<class Create>
+    Ensemble runEnsemble(Create create, const CaPsoSettings& settings, uint64_t firstSeed)
+    {
+        Ensemble ensemble(NUMBER_OF_OBSERVABLES);
+
+        for(int run = 0; run < ensembleSize(); run++)
+        {
+            std::unique_ptr<Engine> engine = create(SIZE, SIZE, settings, firstSeed + run);
+            std::vector<double> values = observe(*engine);
+
+            for(int observable = 0; observable < NUMBER_OF_OBSERVABLES; observable++)
+            {
+                ensemble[observable].push_back(values[observable]);
+            }
+        }
+
+        return ensemble;
+    }
+
+    // Asymptotic distribution of the Kolmogorov-Smirnov statistic
+    double kolmogorovQ(double lambda)
+    {
+        if(lambda < 0.2)
+        {
+            return 1.0;
+        }
+
+        double sum = 0.0;
+        double sign = 1.0;
+
+        for(int j = 1; j <= 100; j++)
+        {
+            double term = sign * 2.0 * std::exp(-2.0 * j * j * lambda * lambda);
+            sum += term;
+
+            if(std::fabs(term) < 1e-10 * std::fabs(sum))
+            {
+                return std::min(1.0, std::max(0.0, sum));
+            }
+
+            sign = -sign;
+        }
+
+        return 1.0;
+    }
+
+    // p-value of the two sample Kolmogorov-Smirnov test
+    double kolmogorovSmirnov(std::vector<double> a, std::vector<double> b)
+    {
+        std::sort(a.begin(), a.end());
+        std::sort(b.begin(), b.end());
+
+        double distance = 0.0;
+        size_t i = 0;
+        size_t j = 0;
+
+        while(i < a.size() && j < b.size())
+        {
+            // Step over every tied value at once
+            double value = std::min(a[i], b[j]);
+
+            while(i < a.size() && a[i] == value)
+            {
+                i++;
+            }
+
+            while(j < b.size() && b[j] == value)
+            {
+                j++;
+            }
+
+            distance = std::max(distance, std::fabs(static_cast<double>(i) / a.size() -
+                                                    static_cast<double>(j) / b.size()));
+        }
+
+        double n = static_cast<double>(a.size()) * b.size() / (a.size() + b.size());
+        double sqrtN = std::sqrt(n);
+
+        return kolmogorovQ((sqrtN + 0.12 + 0.11 / sqrtN) * distance);
+    }
+
+    // Compares every observable of both ensembles, with a Bonferroni
+    // correction so the setting as a whole is tested at ALPHA
+    ::testing::AssertionResult equivalent(const Ensemble& reference, const Ensemble& candidate)
+    {
+        ::testing::AssertionResult result = ::testing::AssertionSuccess();
+        bool diverged = false;
+
+        for(int observable = 0; observable < NUMBER_OF_OBSERVABLES; observable++)
+        {
+            double p = kolmogorovSmirnov(reference[observable], candidate[observable]);
+
+            if(p < ALPHA / NUMBER_OF_OBSERVABLES)
+            {
+                if(!diverged)
+                {
+                    result = ::testing::AssertionFailure();
+                    diverged = true;
+                }
+
+                result << observableName(observable) << " diverges (p = " << p << ") ";
+            }
+        }
+
+        return result;
+    }
+
+    const char* SETTINGS[] = { "fig_6_12_a.json", "fig_6_9_b.json", "fig_6_13_b.json" };
+}
+
+TEST(Equivalence, test_kolmogorovSmirnov)
+{
+    std::vector<double> a;
+    std::vector<double> b;
+
+    for(int i = 0; i < 50; i++)
+    {
+        a.push_back(i);
+        b.push_back(i + 0.5);
+    }
+
+    EXPECT_DOUBLE_EQ(1.0, kolmogorovSmirnov(a, a));
+    EXPECT_GT(kolmogorovSmirnov(a, b), 0.5);
+
+    for(double& value : b)
+    {
+        value += 40;
+    }
+
+    EXPECT_LT(kolmogorovSmirnov(a, b), 1e-6);
+}
+
+// The test must be able to tell different dynamics apart, otherwise passing
+// it would mean nothing
+TEST(Equivalence, test_sensitivity)
+{
+    CaPsoSettings settings;
+    CaPsoSettings faster;
+    ASSERT_TRUE(loadSettingsFile(settings, testingExample("fig_6_12_a.json")));
+    ASSERT_TRUE(loadSettingsFile(faster, testingExample("fig_6_12_c.json")));
+
+    Ensemble reference = runEnsemble(createReference, settings, 1);
+    Ensemble candidate = runEnsemble(createReference, faster, 1001);
+
+    EXPECT_FALSE(equivalent(reference, candidate));
+}
+
+TEST(Equivalence, test_engines)
+{
+    for(const char* name : SETTINGS)
+    {
+        CaPsoSettings settings;
+        ASSERT_TRUE(loadSettingsFile(settings, testingExample(name))) << name;
+
+        Ensemble reference = runEnsemble(createReference, settings, 1);
+
+        // Exact engines are included too, from other seeds they are just
+        // another sample of the reference
+        for(const EngineFactory& factory : engines())
+        {
+            Ensemble candidate = runEnsemble(factory.create, settings, 1001);
+
+            EXPECT_TRUE(equivalent(reference, candidate)) << factory.name << " with " << name;
+        }
+    }
+}
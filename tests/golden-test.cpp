@@ -0,0 +1,545 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include "gtest/gtest.h"
+#include "engines.h"
+#include "Models/globalcapso.h"
+#include "Models/localcapso.h"
+
+namespace
+{
+    // Lattice hash and population after every stage of a run
+    struct StageRecord
+    {
+        int stage;
+        int preys;
+        int predators;
+        uint64_t hash;
+
+        bool operator==(const StageRecord& other) const
+        {
+            return stage == other.stage && preys == other.preys &&
+                   predators == other.predators && hash == other.hash;
+        }
+    };
+
+    const int WIDTH = 96;
+    const int HEIGHT = 64;
+    const int GENERATIONS = 30;
+    const uint64_t SEED = 20130901;
+
+    // FNV-1a, 64 bits
+    uint64_t hash(const unsigned char* data, size_t size)
+    {
+        uint64_t h = 0xcbf29ce484222325ULL;
+
+        for(size_t i = 0; i < size; i++)
+        {
+            h = (h ^ data[i]) * 0x100000001b3ULL;
+        }
+
+        return h;
+    }
+
+    template<class Model>
+    StageRecord stageRecord(int stage, const Model& model, const std::vector<unsigned char>& lattice)
+    {
+        return { stage, model.numberOfPreys(), model.numberOfPredators(),
+                 hash(lattice.data(), lattice.size()) };
+    }
+
+    std::vector<StageRecord> record(Engine& engine, int generations)
+    {
+        std::vector<StageRecord> records;
+
+        for(int i = 0; i < generations; i++)
+        {
+            int stage = engine.currentStage();
+            engine.nextGen();
+
+            records.push_back(stageRecord(stage, engine, engine.lattice()));
+        }
+
+        return records;
+    }
+
+    template<class Model>
+    std::vector<StageRecord> record(Model& ca, int generations)
+    {
+        std::vector<StageRecord> records;
+
+        for(int i = 0; i < generations; i++)
+        {
+            int stage = ca.currentStage();
+            ca.nextGen();
+
+            unsigned char* linear = ca.linearLattice();
+            std::vector<unsigned char> lattice(linear, linear + ca.width() * ca.height());
+            records.push_back(stageRecord(stage, ca, lattice));
+        }
+
+        return records;
+    }
+
+    // Set CAPSO_PRINT_GOLDEN to print the records in the format of the
+    // tables below, e.g., after an intended change of the model
+    void print(const char* name, const std::vector<StageRecord>& records)
+    {
+        if(!std::getenv("CAPSO_PRINT_GOLDEN"))
+        {
+            return;
+        }
+
+        std::printf("%s\n", name);
+
+        for(const StageRecord& r : records)
+        {
+            std::printf("    { %d, %d, %d, 0x%016llxULL },\n", r.stage, r.preys, r.predators,
+                        static_cast<unsigned long long>(r.hash));
+        }
+    }
+
+    void expectEqual(const std::vector<StageRecord>& expected,
+                     const std::vector<StageRecord>& actual, const std::string& name)
+    {
+        ASSERT_EQ(expected.size(), actual.size()) << name;
+
+        for(size_t i = 0; i < expected.size(); i++)
+        {
+            // Report only the first generation that diverges
+            ASSERT_TRUE(expected[i] == actual[i])
+                    << name << " diverges at generation " << i << " (stage "
+                    << expected[i].stage << "): expected " << expected[i].preys << " preys, "
+                    << expected[i].predators << " predators, hash " << std::hex << expected[i].hash
+                    << ", got " << std::dec << actual[i].preys << " preys, "
+                    << actual[i].predators << " predators, hash " << std::hex << actual[i].hash;
+        }
+    }
+
+    // Steps a model one stage at a time and snapshots the counts the way
+    // the batch did before advanceSeasons()
+    template<class Model>
+    std::vector<SeasonRecord> stepSeasons(Model& model, int numberOfSeasons)
+    {
+        std::vector<SeasonRecord> records;
+        SeasonRecord record = SeasonRecord();
+
+        for(int season = 0; season < numberOfSeasons; season++)
+        {
+            record.season = season;
+            record.preys = model.numberOfPreys();
+            record.predators = model.numberOfPredators();
+            record.preyBirthRate = model.preyBirthRate();
+            record.predatorBirthRate = model.predatorBirthRate();
+            record.predatorDeathProbability = model.predatorDeathProbability();
+            record.preyDeathProbability = model.preyDeathProbability();
+            records.push_back(record);
+
+            do
+            {
+                switch(model.currentStage())
+                {
+                case Model::REPRODUCTION_OF_PREDATORS:
+                    record.predatorCountBeforeReproduction = model.numberOfPredators();
+                    break;
+                case Model::DEATH_OF_PREDATORS:
+                    record.preyCountBeforePredatorDeath = model.numberOfPreys();
+                    break;
+                case Model::DEATH_OF_PREYS:
+                    record.predatorCountBeforePreyDeath = model.numberOfPredators();
+                    break;
+                case Model::REPRODUCTION_OF_PREYS:
+                    record.preyCountBeforeReproduction = model.numberOfPreys();
+                    break;
+                }
+
+                model.nextGen();
+            }
+            while(model.currentStage() != Model::COMPETITION);
+        }
+
+        return records;
+    }
+
+    void expectEqual(const std::vector<SeasonRecord>& expected,
+                     const std::vector<SeasonRecord>& actual, const std::string& name)
+    {
+        ASSERT_EQ(expected.size(), actual.size()) << name;
+
+        for(size_t i = 0; i < expected.size(); i++)
+        {
+            ASSERT_EQ(0, std::memcmp(&expected[i], &actual[i], sizeof(SeasonRecord)))
+                    << name << " diverges at season " << i;
+        }
+    }
+
+    template<class Model>
+    void expectSameSeasons(Model& stepped, Model& advanced, int numberOfSeasons,
+                           const std::string& name)
+    {
+        std::vector<SeasonRecord> expected = stepSeasons(stepped, numberOfSeasons);
+        std::vector<SeasonRecord> actual;
+
+        EXPECT_EQ(numberOfSeasons, advanced.advanceSeasons(numberOfSeasons,
+                                                           [&](const SeasonRecord& record)
+        {
+            actual.push_back(record);
+            return true;
+        }));
+
+        expectEqual(expected, actual, name);
+
+        EXPECT_EQ(stepped.currentStage(), advanced.currentStage()) << name;
+        EXPECT_EQ(0, std::memcmp(stepped.latticeData(), advanced.latticeData(),
+                                 stepped.width() * stepped.height())) << name;
+    }
+
+    // Keeps every event of the stages
+    struct EventRecorder
+    {
+        std::vector<std::vector<int>> events;
+
+        void stageBegin(const StageCounts& counts)
+        {
+            events.push_back({ 0, counts.stage, counts.preys, counts.predators });
+        }
+
+        void stageEnd(const StageCounts& counts)
+        {
+            events.push_back({ 1, counts.stage, counts.preys, counts.predators });
+        }
+    };
+
+    // The settings every engine is compared with
+    std::vector<CaPsoSettings> settingsToCompare()
+    {
+        CaPsoSettings defaults;
+
+        CaPsoSettings large;
+        large.fitnessRadius = 6;
+        large.preyReproductionRadius = 4;
+        large.predatorReproductionRadius = 5;
+        large.predatorSocialRadius = 5;
+        large.predatorInitialSwarmSize = 40;
+
+        CaPsoSettings dense;
+        dense.initialPreyDensity = 0.8F;
+        dense.competitionFactor = 0.9F;
+        dense.fitnessRadius = 1;
+        dense.predatorInitialSwarmSize = 200;
+
+        // A social neighborhood wider than the buckets of the neighbor grid
+        CaPsoSettings social;
+        social.predatorSocialRadius = 12;
+        social.predatorInitialSwarmSize = 100;
+
+        return { defaults, large, dense, social };
+    }
+}
+
+TEST(Golden, test_determinism)
+{
+    auto first = createReference(WIDTH, HEIGHT, CaPsoSettings(), SEED);
+    auto second = createReference(WIDTH, HEIGHT, CaPsoSettings(), SEED);
+    auto other = createReference(WIDTH, HEIGHT, CaPsoSettings(), SEED + 1);
+
+    std::vector<StageRecord> records = record(*first, GENERATIONS);
+
+    expectEqual(records, record(*second, GENERATIONS), "LocalCaPso");
+    EXPECT_FALSE(records == record(*other, GENERATIONS));
+}
+
+// The stored values depend on the distributions of libstdc++ and on IEEE
+// single precision arithmetic without contractions, so they are only checked
+// where they were recorded
+#if defined(__GLIBCXX__) && defined(__x86_64__) && _GLIBCXX_RELEASE >= 11
+TEST(Golden, test_reference)
+{
+    const std::vector<StageRecord> expected =
+    {
+        { 0, 1707, 3, 0x3390220bf5f0b100ULL },
+        { 1, 1707, 3, 0xda631985d2d2a304ULL },
+        { 1, 1707, 3, 0xe7897f2e2273ecb8ULL },
+        { 1, 1707, 3, 0xa990df725a54fb14ULL },
+        { 1, 1707, 3, 0xe0f2bfc08bd293e4ULL },
+        { 1, 1707, 3, 0xc3e1461a396cf8b0ULL },
+        { 2, 1707, 25, 0xd21187cdee2a1fa4ULL },
+        { 3, 1707, 7, 0x7b22b79dd3ad370cULL },
+        { 4, 1700, 7, 0x4e576958de014de1ULL },
+        { 5, 5791, 7, 0x9275afbf6cd681e8ULL },
+        { 0, 4104, 7, 0x8475f7898e2c5373ULL },
+        { 1, 4104, 7, 0x0e651e9dfbe417a3ULL },
+        { 1, 4104, 7, 0x877915cb3d6548fbULL },
+        { 1, 4104, 7, 0x66623d6bb3a1e5f3ULL },
+        { 1, 4104, 7, 0xa7c6722500e4e5f3ULL },
+        { 1, 4104, 7, 0xeefe304f02978023ULL },
+        { 2, 4104, 60, 0x8ade4a043e650f69ULL },
+        { 3, 4104, 41, 0x082d7ee91dc40eefULL },
+        { 4, 4063, 41, 0x0687c4d618fce44aULL },
+        { 5, 6140, 41, 0x48e33f9cd74fdc69ULL },
+        { 0, 4315, 41, 0xa728a7003b2053c6ULL },
+        { 1, 4315, 41, 0x5170881acefebe52ULL },
+        { 1, 4315, 41, 0xfca56121bbae2756ULL },
+        { 1, 4315, 41, 0x2d16f851beeed07eULL },
+        { 1, 4315, 41, 0xe48e0cb9f68ba272ULL },
+        { 1, 4315, 41, 0x2fb8de565baec912ULL },
+        { 2, 4315, 220, 0xbf522ea02970a33cULL },
+        { 3, 4315, 157, 0xb82c4de082c9b47eULL },
+        { 4, 4158, 157, 0xc506f0a6467e5dbdULL },
+        { 5, 6118, 157, 0xcd5c79c2d139251dULL },
+    };
+
+    auto reference = createReference(WIDTH, HEIGHT, CaPsoSettings(), SEED);
+    std::vector<StageRecord> records = record(*reference, GENERATIONS);
+
+    print("LocalCaPso", records);
+    expectEqual(expected, records, "LocalCaPso");
+}
+
+TEST(Golden, test_global)
+{
+    const std::vector<StageRecord> expected =
+    {
+        { 0, 2613, 3, 0xf8ae9fe356779402ULL },
+        { 1, 2613, 3, 0xf8ae9fe356779402ULL },
+        { 1, 2613, 3, 0xf8ae9fe356779402ULL },
+        { 1, 2613, 3, 0xeae1f605bf1bf3a2ULL },
+        { 1, 2613, 3, 0xeae1f605bf1bf3a2ULL },
+        { 1, 2613, 3, 0x2e997efb22259e9aULL },
+        { 2, 2613, 18, 0xf7f14b468f5fd538ULL },
+        { 3, 2613, 7, 0x998a6e76199109aaULL },
+        { 4, 2606, 7, 0x7af05b455dbcf41bULL },
+        { 5, 4617, 7, 0xf171bb75437ed5c2ULL },
+        { 0, 3557, 7, 0xf738ad7215019776ULL },
+        { 1, 3557, 7, 0xdc9f70d3ebf33222ULL },
+        { 1, 3557, 7, 0xcefa4024fb8cccd2ULL },
+        { 1, 3557, 7, 0xef63a6dac8a07a26ULL },
+        { 1, 3557, 7, 0xbd9495a85e8bc6baULL },
+        { 1, 3557, 7, 0x304d425f03eb9256ULL },
+        { 2, 3557, 38, 0x950c3456ae873310ULL },
+        { 3, 3557, 18, 0xf6c097747eb32cb4ULL },
+        { 4, 3539, 18, 0x5d0c014e0ffa314eULL },
+        { 5, 5263, 18, 0xfd5d8e1f987778b4ULL },
+        { 0, 3871, 18, 0x1e4be9d9df4e5fd0ULL },
+        { 1, 3871, 18, 0x75461f3d224dea9eULL },
+        { 1, 3871, 18, 0x3fd65a13496ad452ULL },
+        { 1, 3871, 18, 0x2341122020a716b2ULL },
+        { 1, 3871, 18, 0x934016c305e34d7cULL },
+        { 1, 3871, 18, 0x499c61257404f8e0ULL },
+        { 2, 3871, 90, 0x066fdf1a76e932b8ULL },
+        { 3, 3871, 50, 0x8d3343d08898a298ULL },
+        { 4, 3821, 50, 0xfe15116284e4e25cULL },
+        { 5, 5479, 50, 0x6d6b56daa3efe726ULL },
+    };
+
+    GlobalCaPso ca(WIDTH, HEIGHT);
+    ca.seed(SEED);
+    ca.initialize();
+
+    std::vector<StageRecord> records = record(ca, GENERATIONS);
+
+    print("GlobalCaPso", records);
+    expectEqual(expected, records, "GlobalCaPso");
+
+    // The layout of the lattice does not change the run
+    GlobalCaPso tiled(WIDTH, HEIGHT);
+    tiled.setLayout(8);
+    tiled.seed(SEED);
+    tiled.initialize();
+
+    expectEqual(expected, record(tiled, GENERATIONS), "GlobalCaPso tiled");
+}
+#endif
+
+TEST(Golden, test_exact_engines)
+{
+    for(const EngineFactory& factory : engines())
+    {
+        if(!factory.exact)
+        {
+            continue;
+        }
+
+        for(const CaPsoSettings& settings : settingsToCompare())
+        {
+            for(uint64_t seed : { SEED, SEED + 1, SEED + 2 })
+            {
+                auto reference = createReference(WIDTH, HEIGHT, settings, seed);
+                auto engine = factory.create(WIDTH, HEIGHT, settings, seed);
+
+                std::vector<StageRecord> expected = record(*reference, 2 * GENERATIONS);
+                std::vector<StageRecord> actual = record(*engine, 2 * GENERATIONS);
+
+                expectEqual(expected, actual, factory.name + " seed " + std::to_string(seed));
+
+                EXPECT_TRUE(reference->lattice() == engine->lattice()) << factory.name;
+            }
+        }
+    }
+}
+
+TEST(Golden, test_mask_wrap)
+{
+    // Lattices whose sides are powers of two wrap with bit masks, which
+    // reach the same cells as the generic wrap
+    for(const CaPsoSettings& settings : settingsToCompare())
+    {
+        for(uint64_t seed : { SEED, SEED + 1 })
+        {
+            LocalCaPso masked(128, 64);
+            LocalCaPso generic(128, 64);
+            generic.setGenericWrap(true);
+
+            for(LocalCaPso* ca : { &masked, &generic })
+            {
+                ca->setNeighborSearch(Swarm::SCAN);
+                ca->setSettings(settings);
+                ca->seed(seed);
+                ca->initialize();
+            }
+
+            ASSERT_TRUE(masked.maskWrap());
+            ASSERT_FALSE(generic.maskWrap());
+
+            expectEqual(record(generic, 2 * GENERATIONS), record(masked, 2 * GENERATIONS),
+                        "LocalCaPso seed " + std::to_string(seed));
+        }
+    }
+
+    GlobalCaPso masked(64, 64);
+    GlobalCaPso generic(64, 64);
+    generic.setGenericWrap(true);
+
+    for(GlobalCaPso* ca : { &masked, &generic })
+    {
+        ca->seed(SEED);
+        ca->initialize();
+    }
+
+    expectEqual(record(generic, 2 * GENERATIONS), record(masked, 2 * GENERATIONS),
+                "GlobalCaPso");
+
+    EXPECT_FALSE(LocalCaPso(WIDTH, HEIGHT).maskWrap());
+}
+
+TEST(Golden, test_threaded_global_best)
+{
+    // Swarms large enough to split the search of the global best, the
+    // chunks break ties as the whole scan does
+    GlobalCaPso serial(512, 512);
+    GlobalCaPso threaded(512, 512);
+    threaded.setSearchThreads(4);
+
+    ASSERT_EQ(1, serial.searchThreads());
+    ASSERT_EQ(4, threaded.searchThreads());
+
+    for(GlobalCaPso* ca : { &serial, &threaded })
+    {
+        ca->setInitialSwarmSize(30000);
+        ca->seed(SEED);
+        ca->initialize();
+    }
+
+    expectEqual(record(serial, 2 * GENERATIONS), record(threaded, 2 * GENERATIONS),
+                "GlobalCaPso threaded search");
+}
+
+TEST(Golden, test_advance_seasons)
+{
+    // The fused seasons match the stages run one by one, also when
+    // predators share a cell as in the dense settings
+    for(const CaPsoSettings& settings : settingsToCompare())
+    {
+        for(uint64_t seed : { SEED, SEED + 1 })
+        {
+            LocalCaPso stepped(WIDTH, HEIGHT);
+            LocalCaPso advanced(WIDTH, HEIGHT);
+
+            for(LocalCaPso* ca : { &stepped, &advanced })
+            {
+                ca->setSettings(settings);
+                ca->seed(seed);
+                ca->initialize();
+            }
+
+            expectSameSeasons(stepped, advanced, GENERATIONS / 3, "LocalCaPso");
+        }
+    }
+
+    GlobalCaPso stepped(WIDTH, HEIGHT);
+    GlobalCaPso advanced(WIDTH, HEIGHT);
+
+    for(GlobalCaPso* ca : { &stepped, &advanced })
+    {
+        ca->setInitialSwarmSize(200);
+        ca->seed(SEED);
+        ca->initialize();
+    }
+
+    expectSameSeasons(stepped, advanced, GENERATIONS / 3, "GlobalCaPso");
+
+    // The callback stops the run, a season already started is finished
+    stepped.nextGen();
+
+    EXPECT_EQ(2, stepped.advanceSeasons(5, [](const SeasonRecord& record)
+    {
+        return record.season < 2;
+    }));
+    EXPECT_EQ(GlobalCaPso::COMPETITION, stepped.currentStage());
+}
+
+TEST(Golden, test_stage_observer)
+{
+    CaPsoSettings dense;
+    dense.initialPreyDensity = 0.8F;
+    dense.predatorInitialSwarmSize = 200;
+
+    LocalCaPso stepped(WIDTH, HEIGHT);
+    LocalCaPso advanced(WIDTH, HEIGHT);
+
+    for(LocalCaPso* ca : { &stepped, &advanced })
+    {
+        ca->setSettings(dense);
+        ca->seed(SEED);
+        ca->initialize();
+    }
+
+    // The fused seasons report the same events as the stages run one by one
+    const int SEASONS = 4;
+
+    EventRecorder expected;
+
+    for(int generation = 0; generation < SEASONS * 10; generation++)
+    {
+        stepped.nextGen(expected);
+    }
+
+    EXPECT_EQ(2 * SEASONS * 10, static_cast<int>(expected.events.size()));
+
+    SeasonCounter counter;
+
+    for(const std::vector<int>& event : expected.events)
+    {
+        if(event[0] == 0)
+        {
+            counter.stageBegin({ event[1], event[2], event[3] });
+        }
+    }
+
+    EventRecorder actual;
+    SeasonRecord last = SeasonRecord();
+
+    advanced.advanceSeasons(SEASONS + 1, [&](const SeasonRecord& record)
+    {
+        last = record;
+        return record.season < SEASONS;
+    }, actual);
+
+    EXPECT_TRUE(expected.events == actual.events);
+
+    EXPECT_EQ(counter.preyCountBeforeReproduction(), last.preyCountBeforeReproduction);
+    EXPECT_EQ(counter.predatorCountBeforeReproduction(), last.predatorCountBeforeReproduction);
+    EXPECT_EQ(counter.preyCountBeforePredatorDeath(), last.preyCountBeforePredatorDeath);
+    EXPECT_EQ(counter.predatorCountBeforePreyDeath(), last.predatorCountBeforePreyDeath);
+}
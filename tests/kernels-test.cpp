@@ -0,0 +1,143 @@
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include <gtest/gtest.h>
+#include "Models/kernels.h"
+#include "Models/randomnumber.h"
+
+namespace
+{
+    // Sizes around the vector widths, with tails of every length
+    const std::vector<size_t> SIZES = { 0, 1, 3, 4, 15, 16, 17, 31, 33, 64, 65, 127, 200 };
+
+    std::vector<unsigned char> randomCells(RandomNumber& random, size_t size)
+    {
+        std::vector<unsigned char> cells(size);
+
+        for(auto& cell : cells)
+        {
+            cell = static_cast<unsigned char>(random.GetRandomInt(0, 255));
+        }
+
+        return cells;
+    }
+}
+
+TEST(Kernels, test_supported)
+{
+    std::vector<const Kernels*> supported = supportedKernels();
+
+    ASSERT_FALSE(supported.empty());
+    EXPECT_EQ(&scalarKernels(), supported.front());
+
+    bool found = false;
+
+    for(const Kernels* kernels : supported)
+    {
+        found = found || kernels == &fastestKernels();
+    }
+
+    EXPECT_TRUE(found) << fastestKernels().name;
+}
+
+TEST(Kernels, test_same_as_scalar)
+{
+    const Kernels& reference = scalarKernels();
+
+    RandomNumber random;
+    random.seed(7);
+
+    for(const Kernels* kernels : supportedKernels())
+    {
+        for(size_t size : SIZES)
+        {
+            std::vector<unsigned char> cells = randomCells(random, size);
+            std::vector<float> values(size);
+            std::vector<float> limits(size);
+
+            random.fill(values.data(), size);
+            random.fill(limits.data(), size);
+
+            std::vector<int> indices(size), expectedIndices(size);
+
+            for(unsigned char state : { 1, 2, 6 })
+            {
+                size_t count = kernels->findState(cells.data(), size, state, indices.data());
+                ASSERT_EQ(reference.findState(cells.data(), size, state, expectedIndices.data()), count)
+                    << kernels->name << " size " << size;
+                EXPECT_TRUE(std::equal(indices.begin(), indices.begin() + count, expectedIndices.begin()))
+                    << kernels->name << " size " << size;
+
+                std::vector<unsigned char> bits(size), expectedBits(size);
+                kernels->maskState(cells.data(), size, state, bits.data());
+                reference.maskState(cells.data(), size, state, expectedBits.data());
+                EXPECT_EQ(expectedBits, bits) << kernels->name << " size " << size;
+
+                std::vector<unsigned char> marked = cells, expectedMarked = cells;
+                EXPECT_EQ(reference.markBelow(values.data(), size, 0.3F, expectedMarked.data(), state),
+                          kernels->markBelow(values.data(), size, 0.3F, marked.data(), state))
+                    << kernels->name << " size " << size;
+                EXPECT_EQ(expectedMarked, marked) << kernels->name << " size " << size;
+            }
+
+            // Equal values and limits are selected
+            if(size > 0)
+            {
+                limits[size / 2] = values[size / 2];
+            }
+
+            for(size_t i = 0; i < size; i++)
+            {
+                indices[i] = static_cast<int>(3 * i);
+            }
+
+            std::vector<int> selected(size), expectedSelected(size);
+            size_t count = kernels->selectBelow(values.data(), limits.data(), indices.data(),
+                                                size, selected.data());
+            ASSERT_EQ(reference.selectBelow(values.data(), limits.data(), indices.data(),
+                                            size, expectedSelected.data()), count)
+                << kernels->name << " size " << size;
+            EXPECT_TRUE(std::equal(selected.begin(), selected.begin() + count, expectedSelected.begin()))
+                << kernels->name << " size " << size;
+
+            // Sums wrap around modulo 256 as the densities
+            for(int span : { 1, 3, 7, 17 })
+            {
+                std::vector<unsigned char> padded = randomCells(random, size + span - 1);
+                std::vector<unsigned char> sums(size), expectedSums(size);
+
+                kernels->windowSum(padded.data(), size, span, sums.data());
+                reference.windowSum(padded.data(), size, span, expectedSums.data());
+                EXPECT_EQ(expectedSums, sums) << kernels->name << " span " << span;
+
+                kernels->addRow(sums.data(), cells.data(), size);
+                reference.addRow(expectedSums.data(), cells.data(), size);
+                EXPECT_EQ(expectedSums, sums) << kernels->name;
+
+                kernels->subtractRow(sums.data(), padded.data(), size);
+                reference.subtractRow(expectedSums.data(), padded.data(), size);
+                EXPECT_EQ(expectedSums, sums) << kernels->name;
+            }
+        }
+    }
+}
+
+TEST(Kernels, test_float_limits)
+{
+    // The limits turn comparisons with a double into ones with a float
+    for(double value : { 0.0, 0.1, 0.3, 0.5, 1.0 / 3.0, 0.999999999, 1.0 })
+    {
+        float atMost = floatAtMost(value);
+        float below = floatBelow(value);
+        float next = std::nextafter(atMost, 2.0F);
+
+        EXPECT_LE(atMost, value);
+        EXPECT_GT(next, value);
+
+        EXPECT_LT(below, value);
+        EXPECT_GE(std::nextafter(below, 2.0F), value);
+    }
+
+    EXPECT_EQ(0.5F, floatAtMost(0.5));
+    EXPECT_LT(floatBelow(0.5), 0.5F);
+}
@@ -0,0 +1,63 @@
+#include <numeric>
+#include <vector>
+#include <gtest/gtest.h>
+#include "Models/latticelayout.h"
+
+TEST(LatticeLayout, test_addresses)
+{
+    // Every cell gets its own address, also for lattices that are not made
+    // of whole tiles
+    for(int tileSize : { 0, 1, 4, 8 })
+    {
+        LatticeLayout layout(37, 21, tileSize);
+        std::vector<int> owners(layout.size(), 0);
+
+        for(int row = 0; row < layout.height(); row++)
+        {
+            for(int col = 0; col < layout.width(); col++)
+            {
+                int address = layout.address(row, col);
+
+                ASSERT_GE(address, 0);
+                ASSERT_LT(address, layout.size());
+                EXPECT_EQ(1, ++owners[address]) << tileSize;
+
+                LatticePoint point = layout.point(address);
+                EXPECT_EQ(row, point.row);
+                EXPECT_EQ(col, point.col);
+            }
+        }
+    }
+
+    EXPECT_EQ(37 * 21, LatticeLayout(37, 21).size());
+    EXPECT_EQ(64 * 64, LatticeLayout(64, 64, 8).size());
+
+    // Cells of a tile are contiguous, tiles follow the Z-order
+    LatticeLayout tiled(64, 64, 8);
+    EXPECT_EQ(63, tiled.address(7, 7));
+    EXPECT_EQ(64, tiled.address(0, 8));
+    EXPECT_EQ(128, tiled.address(8, 0));
+    EXPECT_EQ(192, tiled.address(8, 8));
+    EXPECT_EQ(256, tiled.address(0, 16));
+}
+
+TEST(LatticeLayout, test_rowMajor)
+{
+    for(int tileSize : { 0, 8 })
+    {
+        LatticeLayout layout(37, 21, tileSize);
+
+        std::vector<unsigned char> linear(37 * 21);
+        std::iota(linear.begin(), linear.end(), 0);
+
+        std::vector<unsigned char> cells(layout.size());
+        layout.fromRowMajor(linear.data(), cells.data());
+
+        EXPECT_EQ(linear[37 * 5 + 30], cells[layout.address(5, 30)]);
+
+        std::vector<unsigned char> back(37 * 21);
+        layout.toRowMajor(cells.data(), back.data());
+
+        EXPECT_EQ(linear, back) << tileSize;
+    }
+}
@@ -0,0 +1,127 @@
+#include <cmath>
+#include <random>
+#include <gtest/gtest.h>
+#include "Models/migration.h"
+
+namespace
+{
+
+// Scalar migration step of the models
+void scalarMove(int width, int height, float inertia, float cognitive, float social,
+                int maxSpeed, int row, int col, int& velRow, int& velCol,
+                int cognitiveRow, int cognitiveCol, int socialRow, int socialCol,
+                double r1, double r2, int& posRow, int& posCol)
+{
+    auto validateVector = [&](int& r, int& c)
+    {
+        if(std::abs(r) > height / 2)
+        {
+            r = r < 0 ? r + height : r - height;
+        }
+
+        if(std::abs(c) > width / 2)
+        {
+            c = c < 0 ? c + width : c - width;
+        }
+    };
+
+    int currentVelRow = velRow;
+    int currentVelCol = velCol;
+    validateVector(currentVelRow, currentVelCol);
+
+    int cognitiveVelRow = cognitiveRow - row;
+    int cognitiveVelCol = cognitiveCol - col;
+    validateVector(cognitiveVelRow, cognitiveVelCol);
+
+    int socialVelRow = socialRow - row;
+    int socialVelCol = socialCol - col;
+    validateVector(socialVelRow, socialVelCol);
+
+    velRow = (int)(inertia * currentVelRow + cognitive * r1 * cognitiveVelRow +
+        social * r2 * socialVelRow);
+    velCol = (int)(inertia * currentVelCol + cognitive * r1 * cognitiveVelCol +
+        social * r2 * socialVelCol);
+
+    if(std::sqrt((double)(velRow * velRow + velCol * velCol)) > maxSpeed)
+    {
+        velRow = 0;
+        velCol = 0;
+    }
+
+    posRow = (height + row + velRow) % height;
+    posCol = (width + col + velCol) % width;
+}
+
+}
+
+TEST(Migration, test_speed_threshold)
+{
+    for(int maxSpeed = 0; maxSpeed < 200; maxSpeed++)
+    {
+        int threshold = speedThreshold(maxSpeed, [maxSpeed](int squaredSpeed)
+        {
+            return std::sqrt((double)squaredSpeed) > maxSpeed;
+        });
+
+        EXPECT_EQ(maxSpeed * maxSpeed + 1, threshold);
+    }
+
+    // Any speed is too fast
+    EXPECT_EQ(0, speedThreshold(-1, [](int) { return true; }));
+}
+
+TEST(Migration, test_scalar)
+{
+    // Both wrap paths, a speed below and above the size of the lattice
+    const int width = 37;
+    const int height = 24;
+
+    std::mt19937 engine(3);
+    std::uniform_int_distribution<int> rows(0, height - 1);
+    std::uniform_int_distribution<int> cols(0, width - 1);
+    std::uniform_int_distribution<int> velocities(-12, 12);
+    std::uniform_real_distribution<double> factors(0.0, 1.0);
+
+    for(int maxSpeed : { 0, 3, 10, 40 })
+    {
+        const size_t size = 101;
+
+        MigrationBatch<double> batch;
+        batch.resize(size);
+
+        std::vector<int> expected;
+
+        for(size_t i = 0; i < size; i++)
+        {
+            int row = rows(engine), col = cols(engine);
+            int velRow = velocities(engine), velCol = velocities(engine);
+            int cognitiveRow = rows(engine), cognitiveCol = cols(engine);
+            int socialRow = rows(engine), socialCol = cols(engine);
+            double r1 = factors(engine), r2 = factors(engine);
+
+            batch.set(i, row, col, velRow, velCol, cognitiveRow, cognitiveCol,
+                      socialRow, socialCol, r1, r2);
+
+            int posRow, posCol;
+            scalarMove(width, height, 0.7f, 1.0f, 2.0f, maxSpeed, row, col, velRow, velCol,
+                       cognitiveRow, cognitiveCol, socialRow, socialCol, r1, r2, posRow, posCol);
+
+            expected.insert(expected.end(), { velRow, velCol, posRow, posCol });
+        }
+
+        int threshold = speedThreshold(maxSpeed, [maxSpeed](int squaredSpeed)
+        {
+            return std::sqrt((double)squaredSpeed) > maxSpeed;
+        });
+
+        batch.move(width, height, 0.7f, 1.0f, 2.0f, maxSpeed, threshold);
+
+        for(size_t i = 0; i < size; i++)
+        {
+            EXPECT_EQ(expected[4 * i], batch.velocityRow(i));
+            EXPECT_EQ(expected[4 * i + 1], batch.velocityCol(i));
+            EXPECT_EQ(expected[4 * i + 2], batch.row(i));
+            EXPECT_EQ(expected[4 * i + 3], batch.col(i));
+        }
+    }
+}
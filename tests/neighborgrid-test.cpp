@@ -0,0 +1,57 @@
+#include <random>
+#include <set>
+#include <gtest/gtest.h>
+#include "Models/neighborgrid.h"
+
+TEST(NeighborGrid, test_window)
+{
+    // Every point inside a window is visited, also across the edges of the
+    // lattice and with buckets that do not divide it
+    const int width = 23;
+    const int height = 17;
+
+    std::mt19937 engine(9);
+    std::uniform_int_distribution<int> rows(0, height - 1);
+    std::uniform_int_distribution<int> cols(0, width - 1);
+
+    std::vector<LatticePoint> points(60);
+
+    for(LatticePoint& point : points)
+    {
+        point.row = rows(engine);
+        point.col = cols(engine);
+    }
+
+    for(int radius : { 0, 1, 3, 8 })
+    {
+        NeighborGrid grid;
+        grid.reset(width, height, radius + 1);
+        grid.build(points);
+
+        for(int row = 0; row < height; row++)
+        {
+            for(int col = 0; col < width; col++)
+            {
+                std::multiset<std::pair<int, int>> visited;
+
+                grid.forEachNear(row, col, radius, [&](const LatticePoint& point)
+                {
+                    visited.insert({ point.row, point.col });
+                });
+
+                for(const LatticePoint& point : points)
+                {
+                    int dRow = std::abs(point.row - row);
+                    int dCol = std::abs(point.col - col);
+
+                    if(std::min(dRow, height - dRow) <= radius &&
+                       std::min(dCol, width - dCol) <= radius)
+                    {
+                        ASSERT_GT(visited.count({ point.row, point.col }), 0u)
+                            << radius << " " << row << " " << col;
+                    }
+                }
+            }
+        }
+    }
+}
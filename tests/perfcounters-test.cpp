@@ -0,0 +1,56 @@
+#include "gtest/gtest.h"
+#include "Models/perfcounters.h"
+
+TEST(PerfCounters, test_events)
+{
+    PerfCounters counters;
+
+    counters.start();
+
+    volatile double sum = 0.0;
+
+    for(int i = 0; i < 1000000; i++)
+    {
+        sum = sum + i;
+    }
+
+    PerfCounters::Values events = counters.stop();
+
+    // Counters that cannot be opened must read as zero instead of failing
+    for(int event = 0; event < PerfCounters::NUMBER_OF_EVENTS; event++)
+    {
+        if(!counters.available(static_cast<PerfCounters::Event>(event)))
+        {
+            EXPECT_EQ(events[event], 0u);
+        }
+    }
+
+    if(counters.available(PerfCounters::INSTRUCTIONS))
+    {
+        EXPECT_GT(events[PerfCounters::INSTRUCTIONS], 1000000u);
+    }
+
+    if(counters.available(PerfCounters::CYCLES))
+    {
+        EXPECT_GT(events[PerfCounters::CYCLES], 0u);
+    }
+}
+
+TEST(PerfCounters, test_multiplexed_scaling)
+{
+    // Counting all the time, the raw difference
+    EXPECT_EQ(500u, PerfCounters::scale({ 1000, 100, 100 }, { 1500, 200, 200 }));
+
+    // Counting half of the interval, the difference is doubled whatever the
+    // share of running time before it
+    EXPECT_EQ(1000u, PerfCounters::scale({ 1000, 100, 100 }, { 1500, 300, 200 }));
+    EXPECT_EQ(1000u, PerfCounters::scale({ 1000, 400, 100 }, { 1500, 600, 200 }));
+
+    // Scaling both totals on their own would give 1500 * 2 - 1000 * 4 < 0
+    // here, the interval ran all the time and the events are never negative
+    EXPECT_EQ(500u, PerfCounters::scale({ 1000, 400, 100 }, { 1500, 600, 300 }));
+    EXPECT_EQ(0u, PerfCounters::scale({ 1500, 400, 100 }, { 1500, 600, 200 }));
+
+    // A counter that did not run in the interval has nothing to scale
+    EXPECT_EQ(0u, PerfCounters::scale({ 1000, 100, 100 }, { 1000, 300, 100 }));
+}
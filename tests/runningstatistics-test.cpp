@@ -0,0 +1,196 @@
+#include <algorithm>
+#include <random>
+#include <vector>
+#include <gtest/gtest.h>
+#include "Models/runningstatistics.h"
+#include "Models/seasonaggregator.h"
+
+TEST(RunningStatistics, test_mean_variance)
+{
+    std::mt19937 engine(7);
+    std::normal_distribution<double> normal(1e6, 3.0);
+
+    std::vector<double> values(1000);
+    RunningStatistics all, first, second;
+
+    for(size_t i = 0; i < values.size(); i++)
+    {
+        values[i] = normal(engine);
+
+        all.add(values[i]);
+        (i < 300 ? first : second).add(values[i]);
+    }
+
+    // Two pass reference, the large offset would ruin a naive sum of squares
+    double mean = 0.0, squares = 0.0;
+
+    for(double value : values)
+    {
+        mean += value / values.size();
+    }
+
+    for(double value : values)
+    {
+        squares += (value - mean) * (value - mean);
+    }
+
+    EXPECT_EQ(1000, all.count());
+    EXPECT_NEAR(mean, all.mean(), 1e-6);
+    EXPECT_NEAR(squares / (values.size() - 1), all.variance(), 1e-6);
+
+    first.merge(second);
+
+    EXPECT_EQ(all.count(), first.count());
+    EXPECT_NEAR(all.mean(), first.mean(), 1e-6);
+    EXPECT_NEAR(all.variance(), first.variance(), 1e-6);
+    EXPECT_EQ(all.min(), first.min());
+    EXPECT_EQ(all.max(), first.max());
+}
+
+TEST(RunningStatistics, test_quantiles)
+{
+    P2Quantile few(0.5);
+
+    for(double value : { 4.0, 1.0, 3.0 })
+    {
+        few.add(value);
+    }
+
+    EXPECT_DOUBLE_EQ(3.0, few.value());
+
+    std::mt19937 engine(11);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+
+    P2Quantile q05(0.05), median(0.5), q95(0.95);
+
+    for(int i = 0; i < 20000; i++)
+    {
+        double value = uniform(engine);
+
+        q05.add(value);
+        median.add(value);
+        q95.add(value);
+    }
+
+    EXPECT_NEAR(0.05, q05.value(), 0.01);
+    EXPECT_NEAR(0.5, median.value(), 0.01);
+    EXPECT_NEAR(0.95, q95.value(), 0.01);
+}
+
+TEST(RunningStatistics, test_quantiles_few_values)
+{
+    std::mt19937 engine(13);
+    std::normal_distribution<double> normal(0.0, 1.0);
+
+    // Batches have a handful of replicates, their quantiles must be exact
+    for(int count : { 5, 6, 7, 8, 9, 10, P2Quantile::EXACT_COUNT })
+    {
+        std::vector<double> values(count);
+        P2Quantile q05(0.05), q95(0.95);
+
+        for(double& value : values)
+        {
+            value = normal(engine);
+
+            q05.add(value);
+            q95.add(value);
+        }
+
+        std::sort(values.begin(), values.end());
+
+        for(double probability : { 0.05, 0.95 })
+        {
+            double position = probability * (count - 1);
+            int below = static_cast<int>(position);
+            double expected = values[below] + (position - below) * (values[below + 1] - values[below]);
+
+            EXPECT_DOUBLE_EQ(expected, (probability < 0.5 ? q05 : q95).value()) << count;
+        }
+    }
+
+    // Beyond the kept values the estimate starts at the sample quantile
+    P2Quantile q05(0.05), q95(0.95);
+    std::vector<double> values;
+
+    for(int i = 0; i < 2 * P2Quantile::EXACT_COUNT; i++)
+    {
+        values.push_back(normal(engine));
+
+        q05.add(values.back());
+        q95.add(values.back());
+    }
+
+    std::sort(values.begin(), values.end());
+
+    EXPECT_NEAR(values[values.size() / 20], q05.value(), 0.15);
+    EXPECT_NEAR(values[values.size() * 19 / 20], q95.value(), 0.15);
+}
+
+TEST(RunningStatistics, test_season_aggregator)
+{
+    SeasonAggregator aggregator(2);
+
+    for(int replicate = 0; replicate < 4; replicate++)
+    {
+        std::vector<SeasonRecord> seasons(2, SeasonRecord());
+
+        for(int season = 0; season < 2; season++)
+        {
+            seasons[season].season = season;
+            seasons[season].preys = 100 * (replicate + 1);
+            seasons[season].predators = season == 1 && replicate < 3 ? 0 : 10;
+        }
+
+        EXPECT_EQ(replicate + 1, aggregator.add(seasons));
+    }
+
+    EXPECT_EQ(4, aggregator.numberOfReplicates());
+    EXPECT_DOUBLE_EQ(250.0, aggregator.statistics(0, SeasonAggregator::PREYS).mean());
+    EXPECT_NEAR(16666.67, aggregator.statistics(0, SeasonAggregator::PREYS).variance(), 0.01);
+    EXPECT_DOUBLE_EQ(250.0, aggregator.quantile(0, SeasonAggregator::PREYS, SeasonAggregator::MEDIAN));
+    EXPECT_DOUBLE_EQ(0.0, aggregator.predatorExtinction(0));
+    EXPECT_DOUBLE_EQ(0.75, aggregator.predatorExtinction(1));
+    EXPECT_DOUBLE_EQ(0.0, aggregator.preyExtinction(1));
+}
+
+TEST(RunningStatistics, test_season_aggregator_stopped)
+{
+    const int seasons = 10;
+    SeasonAggregator aggregator(seasons);
+
+    // Replicate r loses its predators at season r and stops there, the last
+    // one runs every season
+    for(int replicate = 0; replicate <= seasons; replicate++)
+    {
+        std::vector<SeasonRecord> records;
+
+        for(int season = 0; season < seasons && season <= replicate; season++)
+        {
+            SeasonRecord record = SeasonRecord();
+            record.season = season;
+            record.preys = 100 + season;
+            record.predators = season == replicate ? 0 : 10;
+            records.push_back(record);
+        }
+
+        aggregator.add(records);
+    }
+
+    double extinction = 0.0;
+
+    for(int season = 0; season < seasons; season++)
+    {
+        // Every season counts every replicate, stopped or not
+        EXPECT_EQ(seasons + 1, aggregator.statistics(season, SeasonAggregator::PREYS).count());
+        EXPECT_GE(aggregator.predatorExtinction(season), extinction) << "season " << season;
+
+        extinction = aggregator.predatorExtinction(season);
+        EXPECT_DOUBLE_EQ((season + 1) / (seasons + 1.0), extinction);
+    }
+
+    // Stopped replicates keep their last population
+    EXPECT_DOUBLE_EQ((100.0 * 9 + 36.0 + 109.0 * 2) / 11.0,
+                     aggregator.statistics(seasons - 1, SeasonAggregator::PREYS).mean());
+    EXPECT_DOUBLE_EQ(10.0 / 11.0,
+                     aggregator.statistics(seasons - 1, SeasonAggregator::PREDATORS).mean());
+}
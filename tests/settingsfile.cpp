@@ -0,0 +1,110 @@
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <type_traits>
+#include "settingsfile.h"
+
+#ifndef CAPSO_EXAMPLES_DIR
+#define CAPSO_EXAMPLES_DIR "examples"
+#endif
+
+namespace
+{
+    // Numeric members of a flat json object, other values are skipped
+    std::map<std::string, double> parseNumbers(const std::string& text)
+    {
+        std::map<std::string, double> numbers;
+        size_t pos = 0;
+
+        while((pos = text.find('"', pos)) != std::string::npos)
+        {
+            size_t end = text.find('"', pos + 1);
+
+            if(end == std::string::npos)
+            {
+                break;
+            }
+
+            std::string key = text.substr(pos + 1, end - pos - 1);
+            pos = text.find_first_not_of(" \t\r\n", end + 1);
+
+            if(pos == std::string::npos || text[pos] != ':')
+            {
+                continue;
+            }
+
+            pos = text.find_first_not_of(" \t\r\n", pos + 1);
+
+            if(pos == std::string::npos)
+            {
+                break;
+            }
+
+            if(text[pos] == '"')
+            {
+                // A string value, skip it so it is not taken for a key
+                pos = text.find('"', pos + 1);
+                pos = pos == std::string::npos ? pos : pos + 1;
+                continue;
+            }
+
+            char* last = nullptr;
+            double value = std::strtod(text.c_str() + pos, &last);
+
+            if(last != text.c_str() + pos)
+            {
+                numbers[key] = value;
+            }
+        }
+
+        return numbers;
+    }
+}
+
+bool loadSettingsFile(CaPsoSettings& settings, const std::string& filename)
+{
+    std::ifstream file(filename);
+
+    if(!file)
+    {
+        return false;
+    }
+
+    std::stringstream text;
+    text << file.rdbuf();
+
+    std::map<std::string, double> json = parseNumbers(text.str());
+
+    auto read = [&json](const char* key, auto& member)
+    {
+        auto value = json.find(key);
+
+        if(value != json.end())
+        {
+            member = static_cast<typename std::remove_reference<decltype(member)>::type>(value->second);
+        }
+    };
+
+    read("initialNumberOfPreys", settings.initialPreyDensity);
+    read("competitionFactor", settings.competitionFactor);
+    read("preyReproductionRadius", settings.preyReproductionRadius);
+    read("preyReproductiveCapacity", settings.preyReproductiveCapacity);
+    read("fitnessRadius", settings.fitnessRadius);
+    read("initialNumberOfPredators", settings.predatorInitialSwarmSize);
+    read("predatorCognitiveFactor", settings.predatorCognitiveFactor);
+    read("predatorSocialFactor", settings.predatorSocialFactor);
+    read("predatorMaximumSpeed", settings.predatorMaxSpeed);
+    read("predatorReproductiveCapacity", settings.predatorReproductiveCapacity);
+    read("predatorReproductionRadius", settings.predatorReproductionRadius);
+    read("predatorSocialRadius", settings.predatorSocialRadius);
+    read("initialInertiaWeight", settings.initialInertiaWeight);
+    read("finalInertiaWeight", settings.finalInertiaWeight);
+
+    return true;
+}
+
+std::string testingExample(const std::string& name)
+{
+    return std::string(CAPSO_EXAMPLES_DIR) + "/testing/" + name;
+}
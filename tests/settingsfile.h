@@ -0,0 +1,15 @@
+#ifndef SETTINGSFILE_H
+#define SETTINGSFILE_H
+
+#include <string>
+#include "Models/capsosettings.h"
+
+// Reads the flat settings files of examples/ with the keys of
+// util::loadSettings, without depending on Qt. Returns false when the file
+// cannot be read.
+bool loadSettingsFile(CaPsoSettings& settings, const std::string& filename);
+
+// Path of a file in examples/testing
+std::string testingExample(const std::string& name);
+
+#endif // SETTINGSFILE_H
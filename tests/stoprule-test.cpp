@@ -0,0 +1,37 @@
+#include <gtest/gtest.h>
+#include "Models/stoprule.h"
+
+TEST(StopRule, test_extinction)
+{
+    StopRule disabled;
+    EXPECT_FALSE(disabled.enabled());
+    EXPECT_EQ(StopRule::NONE, disabled.update(0, 0, 0));
+
+    StopRule rule(true, false);
+    EXPECT_TRUE(rule.enabled());
+    EXPECT_EQ(StopRule::NONE, rule.update(0, 100, 5));
+    EXPECT_EQ(StopRule::NONE, rule.update(1, 0, 5));
+    EXPECT_EQ(StopRule::PREDATOR_EXTINCTION, rule.update(2, 50, 0));
+    EXPECT_EQ(2, rule.stopSeason());
+
+    // The first reason is kept
+    EXPECT_EQ(StopRule::PREDATOR_EXTINCTION, rule.update(3, 0, 0));
+    EXPECT_EQ(2, rule.stopSeason());
+
+    rule.reset();
+    EXPECT_EQ(StopRule::NONE, rule.reason());
+    EXPECT_EQ(-1, rule.stopSeason());
+}
+
+TEST(StopRule, test_steady_state)
+{
+    StopRule rule(false, false, 3, 0.05);
+
+    // Predators still change by more than 5% of their mean
+    EXPECT_EQ(StopRule::NONE, rule.update(0, 1000, 100));
+    EXPECT_EQ(StopRule::NONE, rule.update(1, 1010, 110));
+    EXPECT_EQ(StopRule::NONE, rule.update(2, 1005, 100));
+    EXPECT_EQ(StopRule::NONE, rule.update(3, 1000, 102));
+    EXPECT_EQ(StopRule::STEADY_STATE, rule.update(4, 1010, 101));
+    EXPECT_EQ(4, rule.stopSeason());
+}
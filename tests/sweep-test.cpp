@@ -0,0 +1,32 @@
+#include <gtest/gtest.h>
+#include "Models/sweep.h"
+
+TEST(Sweep, test_points)
+{
+    Sweep sweep;
+    ASSERT_TRUE(sweep.addValues("fitnessRadius", { 1, 3 }));
+    ASSERT_TRUE(sweep.addRange("competitionFactor", 0.1, 0.3, 0.1));
+
+    EXPECT_FALSE(sweep.addValues("unknownField", { 1 }));
+    EXPECT_FALSE(sweep.addValues("preyReproductionRadius", {}));
+
+    ASSERT_EQ(2, sweep.numberOfParameters());
+    ASSERT_EQ(6, sweep.numberOfPoints());
+
+    // The last parameter varies fastest
+    std::vector<double> values = sweep.pointValues(4);
+    EXPECT_EQ(3, values[0]);
+    EXPECT_NEAR(0.2, values[1], 1e-12);
+
+    CaPsoSettings base;
+    base.preyReproductiveCapacity = 7;
+
+    for(int point = 0; point < sweep.numberOfPoints(); point++)
+    {
+        CaPsoSettings settings = sweep.settings(base, point);
+
+        EXPECT_EQ(point < 3 ? 1 : 3, settings.fitnessRadius);
+        EXPECT_NEAR(0.1 * (point % 3 + 1), settings.competitionFactor, 1e-6);
+        EXPECT_EQ(7, settings.preyReproductiveCapacity);
+    }
+}
@@ -0,0 +1,36 @@
+#include <gtest/gtest.h>
+#include "Models/torus.h"
+
+TEST(Torus, test_isPowerOfTwo)
+{
+    EXPECT_TRUE(isPowerOfTwo(1));
+    EXPECT_TRUE(isPowerOfTwo(256));
+    EXPECT_TRUE(isPowerOfTwo(2048));
+
+    EXPECT_FALSE(isPowerOfTwo(0));
+    EXPECT_FALSE(isPowerOfTwo(-4));
+    EXPECT_FALSE(isPowerOfTwo(96));
+}
+
+TEST(Torus, test_wraps)
+{
+    // Both wraps agree on every coordinate less than one side off the
+    // lattice
+    ModuloWrap modulo(32, 8);
+    MaskWrap mask(32, 8);
+
+    for(int row = -7; row < 16; row++)
+    {
+        EXPECT_EQ(modulo.row(row), mask.row(row)) << row;
+        EXPECT_GE(mask.row(row), 0);
+        EXPECT_LT(mask.row(row), 8);
+    }
+
+    for(int col = -31; col < 64; col++)
+    {
+        EXPECT_EQ(modulo.col(col), mask.col(col)) << col;
+    }
+
+    EXPECT_EQ(31, mask.col(-1));
+    EXPECT_EQ(0, mask.row(8));
+}
@@ -0,0 +1,68 @@
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include "gtest/gtest.h"
+#include "Models/tracer.h"
+
+static int count(const std::string& text, const std::string& pattern)
+{
+    int n = 0;
+
+    for(size_t pos = text.find(pattern); pos != std::string::npos;
+        pos = text.find(pattern, pos + 1))
+    {
+        n++;
+    }
+
+    return n;
+}
+
+TEST(Tracer, test_write)
+{
+    std::string filename = testing::TempDir() + "capso_trace.json";
+
+    // Nothing is recorded before the tracer is started
+    {
+        Tracer::Scope ignored("Ignored", "test");
+    }
+
+    Tracer::instance().start();
+
+    auto work = [](int index)
+    {
+        Tracer::Scope simulation("Simulation", "simulation", index, "item \"a\"");
+
+        for(int season = 0; season < 3; season++)
+        {
+            Tracer::Scope scope("Season", "season", season);
+        }
+    };
+
+    std::thread worker(work, 1);
+    work(0);
+    worker.join();
+
+    Tracer::instance().stop();
+
+    {
+        Tracer::Scope ignored("Ignored", "test");
+    }
+
+    ASSERT_TRUE(Tracer::instance().write(filename));
+
+    std::ifstream file(filename);
+    std::string json((std::istreambuf_iterator<char>(file)),
+                     std::istreambuf_iterator<char>());
+
+    EXPECT_EQ(count(json, "\"thread_name\""), 2);
+    EXPECT_EQ(count(json, "\"name\":\"Simulation\""), 4);
+    EXPECT_EQ(count(json, "\"name\":\"Season\""), 12);
+    EXPECT_EQ(count(json, "\"ph\":\"B\""), count(json, "\"ph\":\"E\""));
+    EXPECT_EQ(count(json, "Ignored"), 0);
+    EXPECT_EQ(count(json, "item \\\"a\\\""), 2);
+
+    std::remove(filename.c_str());
+}
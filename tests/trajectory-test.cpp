@@ -0,0 +1,92 @@
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
+#include <gtest/gtest.h>
+#include "Models/localcapso.h"
+#include "Models/trajectoryplayer.h"
+#include "Models/trajectoryreader.h"
+#include "Models/trajectorywriter.h"
+
+TEST(Trajectory, test_random_access)
+{
+    const int width = 64, height = 48, frames = 57;
+    std::string filename = testing::TempDir() + "trajectory-test.traj";
+
+    LocalCaPso ca(width, height);
+    ca.setSettings(CaPsoSettings());
+    ca.initialize();
+
+    std::vector<std::vector<unsigned char>> expected;
+
+    TrajectoryWriter writer(width, height, 10, 4);
+    ASSERT_TRUE(writer.open(filename, 100, 1));
+
+    for(int i = 0; i < frames; i++)
+    {
+        expected.emplace_back(ca.latticeData(), ca.latticeData() + width * height);
+        writer.write(ca.latticeData());
+
+        ca.nextGen();
+    }
+
+    writer.close();
+    EXPECT_EQ(writer.frameCount(), frames);
+
+    TrajectoryReader reader;
+    ASSERT_TRUE(reader.open(filename));
+    EXPECT_EQ(reader.width(), width);
+    EXPECT_EQ(reader.height(), height);
+    EXPECT_EQ(reader.frameCount(), frames);
+    EXPECT_EQ(reader.generation(7), 107);
+
+    std::vector<unsigned char> lattice(width * height);
+
+    // Sequential, backwards and scattered reads
+    for(int frame : { 0, 1, 2, 3, 56, 55, 20, 9, 10, 11, 33, 33, 0, 49 })
+    {
+        ASSERT_TRUE(reader.readFrame(frame, lattice.data()));
+        EXPECT_EQ(lattice, expected[frame]) << "frame " << frame;
+    }
+
+    EXPECT_FALSE(reader.readFrame(frames, lattice.data()));
+
+    reader.close();
+
+    // The same frames streamed through the read-ahead player, including
+    // skipped frames and jumps outside of the read-ahead window
+    TrajectoryPlayer player(8);
+    ASSERT_TRUE(player.open(filename));
+    EXPECT_EQ(player.frameCount(), frames);
+
+    for(int frame : { 0, 1, 2, 5, 6, 14, 40, 41, 3, 4, 56, 55 })
+    {
+        ASSERT_TRUE(player.readFrame(frame, lattice.data()));
+        EXPECT_EQ(lattice, expected[frame]) << "frame " << frame;
+    }
+
+    EXPECT_FALSE(player.readFrame(frames, lattice.data()));
+    EXPECT_GT(player.restarts(), 0);
+
+    player.close();
+
+    // Playing forward, every frame or skipping frames within the read-ahead
+    // window, never restarts, also when the reads catch up with the frame
+    // being decoded
+    for(std::pair<int, int> readAheadAndStep : { std::make_pair(1, 1), std::make_pair(8, 1),
+                                                 std::make_pair(8, 3) })
+    {
+        TrajectoryPlayer sequential(readAheadAndStep.first);
+        ASSERT_TRUE(sequential.open(filename));
+
+        for(int frame = 0; frame < frames; frame += readAheadAndStep.second)
+        {
+            ASSERT_TRUE(sequential.readFrame(frame, lattice.data()));
+            EXPECT_EQ(lattice, expected[frame]) << "frame " << frame;
+        }
+
+        EXPECT_EQ(0, sequential.restarts()) << "read ahead " << readAheadAndStep.first;
+    }
+
+    std::remove(filename.c_str());
+}